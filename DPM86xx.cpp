@@ -6,43 +6,86 @@
 //                                                                                                                    //
 //====================================================================================================================//
 
-#include <Arduino.h>
 #include <DPM86xx.h>
 
+//---------------------------------------------------------------------------------------------------
+// formatted values that belong to a function number, used for dispatching parsed responses
+//
+uint16_t DPM86xx::*const DPM86xx::aupFunctionValueP[eFUNC_TEMPERATURE + 1] = {
+    &DPM86xx::uwMaxVoltageP,      // eFUNC_MAX_VOLTAGE
+    &DPM86xx::uwMaxCurrentP,      // eFUNC_MAX_CURRENT
+    nullptr, nullptr, nullptr, nullptr, nullptr, nullptr, nullptr, nullptr,
+    nullptr, nullptr, nullptr, nullptr, nullptr, nullptr, nullptr, nullptr, nullptr, nullptr,
+    nullptr, nullptr, nullptr, nullptr, nullptr, nullptr, nullptr, nullptr, nullptr, nullptr,
+    &DPM86xx::uwMeasuredVoltageP, // eFUNC_MEASURED_VOLTAGE
+    &DPM86xx::uwMeasuredCurrentP, // eFUNC_MEASURED_CURRENT
+    &DPM86xx::uwConstantOutputP,  // eFUNC_CONSTANT_OUTPUT
+    &DPM86xx::uwTemperatureP      // eFUNC_TEMPERATURE
+};
+
 //--------------------------------------------------------------------------------------------------------------------//
 //                                                                                                                    //
 //                                                                                                                    //
 //--------------------------------------------------------------------------------------------------------------------//
 DPM86xx::DPM86xx()
 {
+  teTransStateP = eTRANS_IDLE;
+  slTransResultP = eSTATUS_OK;
+  ubReadValidP = 0;
+  ubAddressP = 1;
+  teProtocolP = ePROTOCOL_ASCII;
+  teReceiveModeP = eRECEIVE_POLL;
+  pfnCompleteP = nullptr;
+  pvCompleteContextP = nullptr;
+  for (uint8_t ubIndexT = 0; ubIndexT < DPM86XX_READ_FUNCTIONS; ubIndexT++)
+  {
+    aulMaxAgeP[ubIndexT] = 0;
+  }
+  resetStats();
+#ifdef DPM86XX_LEGACY_PARSER
+  btLegacyParserP = false;
+#endif
 }
 
 //--------------------------------------------------------------------------------------------------------------------//
 //                                                                                                                    //
 //                                                                                                                    //
 //--------------------------------------------------------------------------------------------------------------------//
+#ifdef ARDUINO
 void DPM86xx::init(HardwareSerial &clSerialIfR, uint8_t ubAddressV)
+{
+  //---------------------------------------------------------------------------------------------------
+  // use the provided interface as transport
+  //
+  clSerialP.init(clSerialIfR);
+  init(clSerialP, ubAddressV);
+}
+#endif
+
+//--------------------------------------------------------------------------------------------------------------------//
+//                                                                                                                    //
+//                                                                                                                    //
+//--------------------------------------------------------------------------------------------------------------------//
+void DPM86xx::init(DPM86xxTransport &clTransportR, uint8_t ubAddressV)
 {
   //---------------------------------------------------------------------------------------------------
   // store reference to the provided interface
   //
-  pclSeralP = &clSerialIfR;
+  pclTransportP = &clTransportR;
+  teTransStateP = eTRANS_IDLE;
+  slTransResultP = eSTATUS_OK;
+  ubReadValidP = 0;
 
   //---------------------------------------------------------------------------------------------------
   // setup address of PSU
   //
-  if ((ubAddressV < 10) && (ubAddressV >= 1))
-  {
-    clAddressP = "0" + String(ubAddressV);
-  }
-  else if ((ubAddressV >= 10 && ubAddressV < 100))
+  if ((ubAddressV < 1) || (ubAddressV >= 100))
   {
-    clAddressP = String(ubAddressV);
-  }
-  else
-  {
-    clAddressP = "01";
+    ubAddressV = 1;
   }
+  ubAddressP = ubAddressV;
+  encodeNumber(aszAddressP, ubAddressV, 2);
+  prepareReadFrames();
 
   //---------------------------------------------------------------------------------------------------
   // Calculate the maximal time to wait for a response
@@ -53,8 +96,28 @@ void DPM86xx::init(HardwareSerial &clSerialIfR, uint8_t ubAddressV)
   // For 19200 Baud the wait time should be maximum 8,3ms + TimeOffset
   //
   uqResponseTimeP = (uint64_t)(1000 * 20 * 8);
-  uqResponseTimeP /= (uint64_t)pclSeralP->baudRate();
+  uqResponseTimeP /= (uint64_t)pclTransportP->baudRate();
   uqResponseTimeP += (uint64_t)20; // Time Offset
+
+  setTimeoutMode(eTIMEOUT_FIXED);
+  ubStagedP = 0;
+  ubShadowValidP = 0;
+  ulElidedWritesP = 0;
+
+  //---------------------------------------------------------------------------------------------------
+  // the statistics belong to the PSU at this address, so they do not contain transactions of a
+  // previous use of this object, e.g. for probing addresses
+  //
+  resetStats();
+
+  //---------------------------------------------------------------------------------------------------
+  // The minimal gap between two frames is 3.5 characters of 10 bits:
+  //
+  //  GapTime = 1000000 * 35 / Baudrate
+  //
+  ulGuardTimeP = (uint32_t)(35000000UL / pclTransportP->baudRate());
+  ulLastReceiveP = micros();
+  teGuardModeP = eGUARD_FIXED;
 }
 
 //--------------------------------------------------------------------------------------------------------------------//
@@ -101,6 +164,81 @@ float DPM86xx::measuredVoltage()
   return ftValueT;
 }
 
+//--------------------------------------------------------------------------------------------------------------------//
+//                                                                                                                    //
+//                                                                                                                    //
+//--------------------------------------------------------------------------------------------------------------------//
+uint32_t DPM86xx::maxMillivolt()
+{
+  return (uint32_t)uwMaxVoltageP * 10;
+}
+
+//--------------------------------------------------------------------------------------------------------------------//
+//                                                                                                                    //
+//                                                                                                                    //
+//--------------------------------------------------------------------------------------------------------------------//
+uint32_t DPM86xx::maxMilliampere()
+{
+  return (uint32_t)uwMaxCurrentP;
+}
+
+//--------------------------------------------------------------------------------------------------------------------//
+//                                                                                                                    //
+//                                                                                                                    //
+//--------------------------------------------------------------------------------------------------------------------//
+uint32_t DPM86xx::measuredMillivolt()
+{
+  return (uint32_t)uwMeasuredVoltageP * 10;
+}
+
+//--------------------------------------------------------------------------------------------------------------------//
+//                                                                                                                    //
+//                                                                                                                    //
+//--------------------------------------------------------------------------------------------------------------------//
+uint32_t DPM86xx::measuredMilliampere()
+{
+  return (uint32_t)uwMeasuredCurrentP;
+}
+
+//--------------------------------------------------------------------------------------------------------------------//
+//                                                                                                                    //
+//                                                                                                                    //
+//--------------------------------------------------------------------------------------------------------------------//
+uint32_t DPM86xx::measuredMilliwatt()
+{
+  //---------------------------------------------------------------------------------------------------
+  // [10 mV] * [mA] = [10 uW], the product of two 16 bit values always fits into 32 bit
+  //
+  return ((uint32_t)uwMeasuredVoltageP * (uint32_t)uwMeasuredCurrentP) / 100;
+}
+
+//--------------------------------------------------------------------------------------------------------------------//
+//                                                                                                                    //
+//                                                                                                                    //
+//--------------------------------------------------------------------------------------------------------------------//
+int32_t DPM86xx::setVoltage(uint32_t ulMillivoltV)
+{
+  return writeFunction(eFUNC_SET_VOLTAGE, millivoltRegister(ulMillivoltV));
+}
+
+//--------------------------------------------------------------------------------------------------------------------//
+//                                                                                                                    //
+//                                                                                                                    //
+//--------------------------------------------------------------------------------------------------------------------//
+int32_t DPM86xx::setCurrent(uint32_t ulMilliampereV)
+{
+  return writeFunction(eFUNC_SET_CURRENT, milliampereRegister(ulMilliampereV));
+}
+
+//--------------------------------------------------------------------------------------------------------------------//
+//                                                                                                                    //
+//                                                                                                                    //
+//--------------------------------------------------------------------------------------------------------------------//
+int32_t DPM86xx::setVoltageCurrent(uint32_t ulMillivoltV, uint32_t ulMilliampereV)
+{
+  return writeFunction(eFUNC_SET_VC, millivoltRegister(ulMillivoltV), milliampereRegister(ulMilliampereV));
+}
+
 //--------------------------------------------------------------------------------------------------------------------//
 //                                                                                                                    //
 //                                                                                                                    //
@@ -142,63 +280,214 @@ float DPM86xx::temperature()
 //                                                                                                                    //
 //                                                                                                                    //
 //--------------------------------------------------------------------------------------------------------------------//
-String DPM86xx::functionToString(Function_te teFunctionV)
+uint8_t DPM86xx::encodeNumber(char *pszBufferV, uint16_t uwValueV, uint8_t ubMinDigitsV)
 {
-  String clStringT = "";
-  if (teFunctionV < 10)
+  char aszDigitsT[5];
+  uint8_t ubCountT = 0;
+  uint8_t ubLengthT = 0;
+
+  //---------------------------------------------------------------------------------------------------
+  // collect the decimal digits in reverse order, at least the requested number of digits is used
+  //
+  do
+  {
+    aszDigitsT[ubCountT++] = (char)('0' + (uwValueV % 10));
+    uwValueV /= 10;
+  } while ((uwValueV > 0) || (ubCountT < ubMinDigitsV));
+
+  //---------------------------------------------------------------------------------------------------
+  // copy them in correct order to the buffer and terminate the string
+  //
+  while (ubCountT > 0)
   {
-    clStringT += "0";
+    pszBufferV[ubLengthT++] = aszDigitsT[--ubCountT];
   }
-  clStringT += String(teFunctionV);
+  pszBufferV[ubLengthT] = '\0';
 
-  return clStringT;
+  return ubLengthT;
 }
 
 //--------------------------------------------------------------------------------------------------------------------//
 //                                                                                                                    //
 //                                                                                                                    //
 //--------------------------------------------------------------------------------------------------------------------//
-uint16_t DPM86xx::functionValue(Function_te teFunctionV)
+uint8_t DPM86xx::encodeFrame(char *pszBufferV, char chCommandV, Function_te teFunctionV, uint16_t uwValue1V,
+                             uint16_t uwValue2V)
 {
-  uint16_t uwReturnT = 0xFFFF; // not valid value
+  uint8_t ubLengthT = 0;
 
   //---------------------------------------------------------------------------------------------------
-  // return value, that corresponds to the function
+  // build the frame ":<address><command><function>=<value1>,[<value2>,]\r\n"
   //
+  pszBufferV[ubLengthT++] = ':';
+  pszBufferV[ubLengthT++] = aszAddressP[0];
+  pszBufferV[ubLengthT++] = aszAddressP[1];
+  pszBufferV[ubLengthT++] = chCommandV;
+  ubLengthT += encodeNumber(&pszBufferV[ubLengthT], (uint16_t)teFunctionV, 2);
+  pszBufferV[ubLengthT++] = '=';
+  ubLengthT += encodeNumber(&pszBufferV[ubLengthT], uwValue1V, 1);
+  pszBufferV[ubLengthT++] = ',';
+  if ((chCommandV == 'w') && (teFunctionV == eFUNC_SET_VC))
+  {
+    ubLengthT += encodeNumber(&pszBufferV[ubLengthT], uwValue2V, 1);
+    pszBufferV[ubLengthT++] = ',';
+  }
+  pszBufferV[ubLengthT++] = '\r';
+  pszBufferV[ubLengthT++] = '\n';
+  pszBufferV[ubLengthT] = '\0';
+
+  return ubLengthT;
+}
+
+//--------------------------------------------------------------------------------------------------------------------//
+//                                                                                                                    //
+//                                                                                                                    //
+//--------------------------------------------------------------------------------------------------------------------//
+void DPM86xx::prepareReadFrames()
+{
+  //---------------------------------------------------------------------------------------------------
+  // address and protocol do not change anymore, so prepare the request frames of all readable functions
+  //
+  const Function_te ateReadFunctionT[DPM86XX_READ_FUNCTIONS] = {eFUNC_MAX_VOLTAGE, eFUNC_MAX_CURRENT,
+                                                                 eFUNC_MEASURED_VOLTAGE, eFUNC_MEASURED_CURRENT,
+                                                                 eFUNC_CONSTANT_OUTPUT, eFUNC_TEMPERATURE};
+  for (uint8_t ubIndexT = 0; ubIndexT < DPM86XX_READ_FUNCTIONS; ubIndexT++)
+  {
+    aubReadFrameLengthP[ubIndexT] = encodeRequest(aaszReadFrameP[ubIndexT], 'r', ateReadFunctionT[ubIndexT], 0, 0);
+  }
+}
+
+//--------------------------------------------------------------------------------------------------------------------//
+//                                                                                                                    //
+//                                                                                                                    //
+//--------------------------------------------------------------------------------------------------------------------//
+uint8_t DPM86xx::encodeRequest(char *pszBufferV, char chCommandV, Function_te teFunctionV, uint16_t uwValue1V,
+                               uint16_t uwValue2V)
+{
+  uint8_t *pubFrameT = (uint8_t *)pszBufferV;
+  uint16_t uwRegisterT;
+
+  if (teProtocolP == ePROTOCOL_ASCII)
+  {
+    return encodeFrame(pszBufferV, chCommandV, teFunctionV, uwValue1V, uwValue2V);
+  }
+
+  //---------------------------------------------------------------------------------------------------
+  // Modbus: the function is mapped to a register, voltage and current are written together
+  // with one request
+  //
+  uwRegisterT = modbusRegister(teFunctionV);
+  if (uwRegisterT == 0xFFFF)
+  {
+    return 0;
+  }
+
+  if (chCommandV == 'r')
+  {
+    return DPM86xxModbus::encodeRead(pubFrameT, ubAddressP, uwRegisterT, 1);
+  }
+
+  if (teFunctionV == eFUNC_SET_VC)
+  {
+    const uint16_t auwValueT[2] = {uwValue1V, uwValue2V};
+    return DPM86xxModbus::encodeWriteMultiple(pubFrameT, ubAddressP, uwRegisterT, auwValueT, 2);
+  }
+
+  return DPM86xxModbus::encodeWrite(pubFrameT, ubAddressP, uwRegisterT, uwValue1V);
+}
+
+//--------------------------------------------------------------------------------------------------------------------//
+//                                                                                                                    //
+//                                                                                                                    //
+//--------------------------------------------------------------------------------------------------------------------//
+uint16_t DPM86xx::modbusRegister(Function_te teFunctionV)
+{
+  uint16_t uwReturnT = 0xFFFF; // not valid register
+
   switch (teFunctionV)
   {
+#ifdef DPM86XX_MODBUS_REG_MAX_VOLTAGE
   case eFUNC_MAX_VOLTAGE:
-    uwReturnT = uwMaxVoltageP;
+    uwReturnT = DPM86XX_MODBUS_REG_MAX_VOLTAGE;
     break;
+#endif
+#ifdef DPM86XX_MODBUS_REG_MAX_CURRENT
   case eFUNC_MAX_CURRENT:
-    uwReturnT = uwMaxCurrentP;
+    uwReturnT = DPM86XX_MODBUS_REG_MAX_CURRENT;
     break;
-  case eFUNC_MEASURED_CURRENT:
-    uwReturnT = uwMeasuredCurrentP;
+#endif
+  case eFUNC_SET_VOLTAGE:
+  case eFUNC_SET_VC:
+    uwReturnT = DPM86XX_MODBUS_REG_SET_VOLTAGE;
     break;
-  case eFUNC_MEASURED_VOLTAGE:
-    uwReturnT = uwMeasuredVoltageP;
+  case eFUNC_SET_CURRENT:
+    uwReturnT = DPM86XX_MODBUS_REG_SET_CURRENT;
     break;
+  case eFUNC_OUTPUT_STATUS:
+    uwReturnT = DPM86XX_MODBUS_REG_OUTPUT;
+    break;
+  case eFUNC_MEASURED_VOLTAGE:
+  case eFUNC_MEASURED_CURRENT:
   case eFUNC_CONSTANT_OUTPUT:
-    uwReturnT = uwConstantOutputP;
+  case eFUNC_TEMPERATURE:
+    uwReturnT = (uint16_t)(DPM86XX_MODBUS_REG_MEASURED_VOLTAGE + (teFunctionV - eFUNC_MEASURED_VOLTAGE));
+    break;
+
+  default:
+    break;
+  }
+
+  return uwReturnT;
+}
+
+//--------------------------------------------------------------------------------------------------------------------//
+//                                                                                                                    //
+//                                                                                                                    //
+//--------------------------------------------------------------------------------------------------------------------//
+uint8_t DPM86xx::readIndex(Function_te teFunctionV)
+{
+  uint8_t ubReturnT = DPM86XX_READ_FUNCTIONS; // not valid index
+
+  switch (teFunctionV)
+  {
+  case eFUNC_MAX_VOLTAGE:
+  case eFUNC_MAX_CURRENT:
+    ubReturnT = (uint8_t)teFunctionV;
     break;
+  case eFUNC_MEASURED_VOLTAGE:
+  case eFUNC_MEASURED_CURRENT:
+  case eFUNC_CONSTANT_OUTPUT:
   case eFUNC_TEMPERATURE:
-    uwReturnT = uwTemperatureP;
+    ubReturnT = (uint8_t)(teFunctionV - eFUNC_MEASURED_VOLTAGE + 2);
     break;
 
-  case eFUNC_SET_VOLTAGE:
-  case eFUNC_SET_CURRENT:
-  case eFUNC_OUTPUT_STATUS:
-  case eFUNC_SET_VC:
-  case eFUNC_WRITE_OK:
-  case eFUNC_INVALID:
   default:
     break;
   }
 
+  return ubReturnT;
+}
+
+//--------------------------------------------------------------------------------------------------------------------//
+//                                                                                                                    //
+//                                                                                                                    //
+//--------------------------------------------------------------------------------------------------------------------//
+uint16_t DPM86xx::functionValue(Function_te teFunctionV)
+{
+  uint16_t uwReturnT = 0xFFFF; // not valid value
+
+  //---------------------------------------------------------------------------------------------------
+  // return value, that corresponds to the function
+  //
+  if ((teFunctionV <= eFUNC_TEMPERATURE) && (aupFunctionValueP[teFunctionV] != nullptr))
+  {
+    uwReturnT = this->*aupFunctionValueP[teFunctionV];
+  }
+
   return uwReturnT;
 }
 
+#ifdef DPM86XX_LEGACY_PARSER
 //--------------------------------------------------------------------------------------------------------------------//
 //                                                                                                                    //
 //                                                                                                                    //
@@ -210,11 +499,12 @@ bool DPM86xx::isNumber(const std::string &s)
     ++it;
   return !s.empty() && it == s.end();
 }
+
 //--------------------------------------------------------------------------------------------------------------------//
 //                                                                                                                    //
 //                                                                                                                    //
 //--------------------------------------------------------------------------------------------------------------------//
-DPM86xx::Function_te DPM86xx::parseResponse(char *pszBufferV, uint8_t ubLengthV)
+DPM86xx::Function_te DPM86xx::parseResponseLegacy(char *pszBufferV, uint8_t ubLengthV)
 {
   const char *SEP = "=";   // Separator between function member and operand (value)
   const char *BEGIN = ":"; // Separator for the begin of the response frame
@@ -305,7 +595,7 @@ DPM86xx::Function_te DPM86xx::parseResponse(char *pszBufferV, uint8_t ubLengthV)
       }
       else
       {
-        clFunctionT = String(clAddressP + "r00");
+        clFunctionT = String(aszAddressP) + "r00";
         if (clFunctionT.equals(pszLeftT))
         {
 
@@ -313,35 +603,35 @@ DPM86xx::Function_te DPM86xx::parseResponse(char *pszBufferV, uint8_t ubLengthV)
           teReturnT = eFUNC_MAX_VOLTAGE;
         }
 
-        clFunctionT = String(clAddressP + "r01");
+        clFunctionT = String(aszAddressP) + "r01";
         if (clFunctionT.equals(pszLeftT))
         {
           uwMaxCurrentP = (uint16_t)atoi(pszRightT);
           teReturnT = eFUNC_MAX_CURRENT;
         }
 
-        clFunctionT = String(clAddressP + "r30");
+        clFunctionT = String(aszAddressP) + "r30";
         if (clFunctionT.equals(pszLeftT))
         {
           uwMeasuredVoltageP = (uint16_t)atoi(pszRightT);
           teReturnT = eFUNC_MEASURED_VOLTAGE;
         }
 
-        clFunctionT = String(clAddressP + "r31");
+        clFunctionT = String(aszAddressP) + "r31";
         if (clFunctionT.equals(pszLeftT))
         {
           uwMeasuredCurrentP = (uint16_t)atoi(pszRightT);
           teReturnT = eFUNC_MEASURED_CURRENT;
         }
 
-        clFunctionT = String(clAddressP + "r32");
+        clFunctionT = String(aszAddressP) + "r32";
         if (clFunctionT.equals(pszLeftT))
         {
           uwConstantOutputP = (uint16_t)atoi(pszRightT);
           teReturnT = eFUNC_CONSTANT_OUTPUT;
         }
 
-        clFunctionT = String(clAddressP + "r33");
+        clFunctionT = String(aszAddressP) + "r33";
         if (clFunctionT.equals(pszLeftT))
         {
           uwTemperatureP = (uint16_t)atoi(pszRightT);
@@ -358,119 +648,242 @@ DPM86xx::Function_te DPM86xx::parseResponse(char *pszBufferV, uint8_t ubLengthV)
 //                                                                                                                    //
 //                                                                                                                    //
 //--------------------------------------------------------------------------------------------------------------------//
-int32_t DPM86xx::readFunction(Function_te teFunctionV)
+void DPM86xx::useLegacyParser(bool btEnableV)
 {
-  int32_t slReturnT;
-
-  //---------------------------------------------------------------------------------------------------
-  // make sure write and read buffers are empty
-  //
-  pclSeralP->flush();
-  delay(5);
-  do
-  {
-    slReturnT = pclSeralP->read();
-  } while (slReturnT >= 0);
+  btLegacyParserP = btEnableV;
+}
 
-  //---------------------------------------------------------------------------------------------------
-  // Create the request frame
-  //
-  String clRequestFrameT = String(":" + clAddressP + "r" + functionToString(teFunctionV) + "=0,");
+//--------------------------------------------------------------------------------------------------------------------//
+//                                                                                                                    //
+//                                                                                                                    //
+//--------------------------------------------------------------------------------------------------------------------//
+DPM86xx::Function_te DPM86xx::parseFrame(const char *pszFrameV, uint8_t ubLengthV, uint16_t &uwValueR)
+{
+  Function_te teReturnT;
 
   //---------------------------------------------------------------------------------------------------
-  // write request and read response
+  // copy the frame to the receive buffer like poll() does, the legacy parser expects a terminated string
   //
-  slReturnT = writeAndRead(clRequestFrameT);
-  if (slReturnT > 0)
+  if (ubLengthV > (DPM86XX_RECEIVE_BUFER_MAX - 1))
   {
-    //-------------------------------------------------------------------------------------------
-    // parse response frame
-    //
-    if (parseResponse(aszReceiveBufferP, slReturnT) != teFunctionV)
-    {
-      //-----------------------------------------------------------------------------------
-      // error the response is not the expected one
-      //
-      slReturnT = eSTATUS_RESP_FRAME;
-    }
-
-    else
-    {
-      //-----------------------------------------------------------------------------------
-      // success, get and return read value
-      //
-      slReturnT = (int32_t)functionValue(teFunctionV);
-    }
+    ubLengthV = DPM86XX_RECEIVE_BUFER_MAX - 1;
   }
+  memcpy(aszReceiveBufferP, pszFrameV, ubLengthV);
+  aszReceiveBufferP[ubLengthV] = '\0';
 
-  return slReturnT;
+  teReturnT = parseResponse(aszReceiveBufferP, ubLengthV);
+  uwValueR = (teReturnT <= eFUNC_TEMPERATURE) ? functionValue(teReturnT) : 0;
+
+  return teReturnT;
 }
+#endif
 
 //--------------------------------------------------------------------------------------------------------------------//
 //                                                                                                                    //
 //                                                                                                                    //
 //--------------------------------------------------------------------------------------------------------------------//
-int32_t DPM86xx::writeAndRead(String clFrameV)
+DPM86xx::Function_te DPM86xx::parseResponse(char *pszBufferV, uint8_t ubLengthV)
 {
-  int32_t slReturnT = eSTATUS_RESP_TIMEOUT;
-  int32_t slCharCounterT = 0;
-  uint64_t ulWaitTimeT;
+  const char *pszScanT = pszBufferV;
+  const char *pszEndT = pszBufferV + ubLengthV;
+  const char *pszFrameT = nullptr;
+  const char *pszFrameEndT = nullptr;
+  const char *pszLeftT = nullptr;
+  uint8_t ubLeftLengthT = 0;
+  uint8_t ubTokenT = 0;
+  bool btTokenT = false;
+  uint16_t uwFunctionT;
+  uint32_t ulValueT = 0;
 
-#ifdef DPM86XX_LOG_REQ_RESP
-  Serial.print("REQ: ");
-  Serial.println(clFrameV);
+#ifdef DPM86XX_LEGACY_PARSER
+  if (btLegacyParserP)
+  {
+    return parseResponseLegacy(pszBufferV, ubLengthV);
+  }
 #endif
 
   //---------------------------------------------------------------------------------------------------
-  // print provided frame to the UART
+  // It can happen that the fault on the bus results in "fault data" before the actual response.
+  // The buffer is split at ':' like the former strtok() based parser did: the frame is the second
+  // part, or the first one if there is no second part. The string ends at the first '\0'.
   //
-  pclSeralP->println(clFrameV);
+  for (uint8_t ubPartT = 0; ubPartT < 2; ubPartT++)
+  {
+    while ((pszScanT < pszEndT) && (*pszScanT == ':'))
+    {
+      pszScanT++;
+    }
+    if ((pszScanT == pszEndT) || (*pszScanT == '\0'))
+    {
+      break;
+    }
+    pszFrameT = pszScanT;
+    while ((pszScanT < pszEndT) && (*pszScanT != ':') && (*pszScanT != '\0'))
+    {
+      pszScanT++;
+    }
+    pszFrameEndT = pszScanT;
+  }
+
+  if ((pszFrameT == nullptr) || ((pszFrameEndT - pszFrameT) < 3) || (pszFrameEndT[-2] != '\r') ||
+      (pszFrameEndT[-1] != '\n'))
+  {
+    return eFUNC_INVALID;
+  }
 
   //---------------------------------------------------------------------------------------------------
-  // enter while loop for reception of the response
+  // a write response is "<address>ok\r\n"
   //
-  ulWaitTimeT = (millis() + uqResponseTimeP);
-  while (millis() < ulWaitTimeT)
+  if (pszFrameEndT[-3] == 'k')
   {
-    //-------------------------------------------------------------------------------------------
-    // when a char has been received
-    // 1. copy it to the receive buffer
-    // 2. increase char counter
-    // 3. check for final char and quit while loop
-    //
-    if (pclSeralP->available())
+    if (((pszFrameEndT - pszFrameT) == 6) && (pszFrameT[0] == aszAddressP[0]) &&
+        (pszFrameT[1] == aszAddressP[1]) && (pszFrameT[2] == 'o'))
     {
-      aszReceiveBufferP[slCharCounterT] = (char)pclSeralP->read();
+      return eFUNC_WRITE_OK;
+    }
+    return eFUNC_INVALID;
+  }
 
-      if (slCharCounterT < (DPM86XX_RECEIVE_BUFER_MAX - 1))
-      {
-        slCharCounterT++;
-      }
-      else
-      {
-        slReturnT = eSTATUS_RESP_BUFFER;
-        break;
+  //---------------------------------------------------------------------------------------------------
+  // a read response is "<address>r<function>=<value>.\r\n", the parts are separated by one or more
+  // '=', the value ends at the next '=' or at the final '.'
+  //
+  if (pszFrameEndT[-3] != '.')
+  {
+    return eFUNC_INVALID;
+  }
+  pszFrameEndT -= 3;
+
+  for (pszScanT = pszFrameT; pszScanT < pszFrameEndT; pszScanT++)
+  {
+    if ((*pszScanT == '.') || (*pszScanT == '\r') || (*pszScanT == '\n'))
+    {
+      return eFUNC_INVALID;
+    }
+    if (*pszScanT == '=')
+    {
+      btTokenT = false;
+      continue;
+    }
+    if (btTokenT == false)
+    {
+      btTokenT = true;
+      ubTokenT++;
+      if (ubTokenT == 1)
+      {
+        pszLeftT = pszScanT;
       }
+    }
 
-      if (aszReceiveBufferP[slCharCounterT - 1] == '\n')
+    if (ubTokenT == 1)
+    {
+      ubLeftLengthT++;
+    }
+    else if (ubTokenT == 2)
+    {
+      if ((*pszScanT < '0') || (*pszScanT > '9'))
       {
-        slReturnT = (int32_t)slCharCounterT;
-        break;
+        return eFUNC_INVALID;
       }
+      ulValueT = (ulValueT * 10) + (uint32_t)(*pszScanT - '0');
     }
   }
 
+  if ((ubTokenT < 2) || (ubLeftLengthT != 5) || (pszLeftT[0] != aszAddressP[0]) ||
+      (pszLeftT[1] != aszAddressP[1]) || (pszLeftT[2] != 'r') || (pszLeftT[3] < '0') || (pszLeftT[3] > '9') ||
+      (pszLeftT[4] < '0') || (pszLeftT[4] > '9'))
+  {
+    return eFUNC_INVALID;
+  }
+  uwFunctionT = (uint16_t)(((pszLeftT[3] - '0') * 10) + (pszLeftT[4] - '0'));
+
   //---------------------------------------------------------------------------------------------------
-  // complete the string
+  // store the value to the member that corresponds to the function
   //
-  aszReceiveBufferP[slCharCounterT] = '\0';
+  if ((uwFunctionT > eFUNC_TEMPERATURE) || (aupFunctionValueP[uwFunctionT] == nullptr))
+  {
+    return eFUNC_INVALID;
+  }
+  this->*aupFunctionValueP[uwFunctionT] = (uint16_t)ulValueT;
 
-#ifdef DPM86XX_LOG_REQ_RESP
-  Serial.print("RES(");
-  Serial.print(slReturnT);
-  Serial.print("):");
-  Serial.println(aszReceiveBufferP);
-#endif
+  return (Function_te)uwFunctionT;
+}
+
+//--------------------------------------------------------------------------------------------------------------------//
+//                                                                                                                    //
+//                                                                                                                    //
+//--------------------------------------------------------------------------------------------------------------------//
+DPM86xx::Function_te DPM86xx::parseResponseModbus(const uint8_t *pubBufferV, uint8_t ubLengthV)
+{
+  const uint8_t *pubRequestT = (const uint8_t *)pszRequestFrameP;
+
+  //---------------------------------------------------------------------------------------------------
+  // the frame is complete, so only address and CRC have to be checked
+  //
+  if ((ubLengthV < 5) || (pubBufferV[0] != ubAddressP) || (DPM86xxModbus::checkCrc(pubBufferV, ubLengthV) != true))
+  {
+    return eFUNC_INVALID;
+  }
+
+  switch (pubBufferV[1])
+  {
+  case DPM86XX_MODBUS_READ_REGISTERS:
+    //-------------------------------------------------------------------------------------------
+    // consecutive registers belong to consecutive function numbers
+    //
+    if ((pubBufferV[2] != (uint8_t)(ubTransRegistersP * 2)) || (ubLengthV != (5 + pubBufferV[2])))
+    {
+      return eFUNC_INVALID;
+    }
+    for (uint8_t ubIndexT = 0; ubIndexT < ubTransRegistersP; ubIndexT++)
+    {
+      uint16_t uwFunctionT = (uint16_t)(teTransResponseP + ubIndexT);
+      if ((uwFunctionT > eFUNC_TEMPERATURE) || (aupFunctionValueP[uwFunctionT] == nullptr))
+      {
+        return eFUNC_INVALID;
+      }
+      this->*aupFunctionValueP[uwFunctionT] = DPM86xxModbus::value(&pubBufferV[3 + (ubIndexT * 2)]);
+    }
+    return teTransResponseP;
+
+  case DPM86XX_MODBUS_WRITE_REGISTER:
+  case DPM86XX_MODBUS_WRITE_REGISTERS:
+    //-------------------------------------------------------------------------------------------
+    // a write is confirmed with the register of the request
+    //
+    if ((ubLengthV != 8) || (pubBufferV[1] != pubRequestT[1]) || (pubBufferV[2] != pubRequestT[2]) ||
+        (pubBufferV[3] != pubRequestT[3]))
+    {
+      return eFUNC_INVALID;
+    }
+    return eFUNC_WRITE_OK;
+
+  default:
+    break;
+  }
+
+  //---------------------------------------------------------------------------------------------------
+  // exception response
+  //
+  return eFUNC_INVALID;
+}
+
+//--------------------------------------------------------------------------------------------------------------------//
+//                                                                                                                    //
+//                                                                                                                    //
+//--------------------------------------------------------------------------------------------------------------------//
+int32_t DPM86xx::readFunction(Function_te teFunctionV)
+{
+  int32_t slReturnT;
+
+  //---------------------------------------------------------------------------------------------------
+  // start the transaction and process it until it is finished
+  //
+  slReturnT = beginRead(teFunctionV);
+  if (slReturnT == eSTATUS_OK)
+  {
+    slReturnT = wait();
+  }
 
   return slReturnT;
 }
@@ -484,34 +897,236 @@ int32_t DPM86xx::writeFunction(Function_te teFunctionV, uint16_t uwValue1V, uint
   int32_t slReturnT;
 
   //---------------------------------------------------------------------------------------------------
-  // make sure write and read buffers are empty
+  // start the transaction and process it until it is finished
   //
-  pclSeralP->flush();
-  delay(5);
-  do
+  slReturnT = beginWrite(teFunctionV, uwValue1V, uwValue2V);
+  if (slReturnT == eSTATUS_OK)
+  {
+    slReturnT = wait();
+  }
+
+  return slReturnT;
+}
+
+//--------------------------------------------------------------------------------------------------------------------//
+//                                                                                                                    //
+//                                                                                                                    //
+//--------------------------------------------------------------------------------------------------------------------//
+int32_t DPM86xx::beginRead(Function_te teFunctionV)
+{
+  if (teTransStateP != eTRANS_IDLE)
+  {
+    return eSTATUS_BUSY;
+  }
+
+  //---------------------------------------------------------------------------------------------------
+  // a cached value that is not too old is returned without bus transaction by the next poll()
+  //
+  uint8_t ubIndexT = readIndex(teFunctionV);
+  if ((ubIndexT < DPM86XX_READ_FUNCTIONS) && (aulMaxAgeP[ubIndexT] > 0) && (age(teFunctionV) < aulMaxAgeP[ubIndexT]))
+  {
+    slTransResultP = (int32_t)functionValue(teFunctionV);
+    if (pfnCompleteP != nullptr)
+    {
+      pfnCompleteP(*this, slTransResultP, pvCompleteContextP);
+    }
+    return eSTATUS_OK;
+  }
+
+  //---------------------------------------------------------------------------------------------------
+  // Use the request frame prepared at init(), only unusual functions are created here
+  //
+  if (ubIndexT < DPM86XX_READ_FUNCTIONS)
+  {
+    pszRequestFrameP = aaszReadFrameP[ubIndexT];
+    ubRequestLengthP = aubReadFrameLengthP[ubIndexT];
+  }
+  else
+  {
+    ubRequestLengthP = encodeRequest(aszRequestBufferP, 'r', teFunctionV, 0, 0);
+    pszRequestFrameP = aszRequestBufferP;
+  }
+
+  if (ubRequestLengthP == 0)
+  {
+    return eSTATUS_UNSUPPORTED;
+  }
+
+  return beginTransaction(teFunctionV, teFunctionV);
+}
+
+//--------------------------------------------------------------------------------------------------------------------//
+//                                                                                                                    //
+//                                                                                                                    //
+//--------------------------------------------------------------------------------------------------------------------//
+int32_t DPM86xx::beginWrite(Function_te teFunctionV, uint16_t uwValue1V, uint16_t uwValue2V)
+{
+  if (teTransStateP != eTRANS_IDLE)
   {
-    slReturnT = pclSeralP->read();
-  } while (slReturnT >= 0);
+    return eSTATUS_BUSY;
+  }
 
   //---------------------------------------------------------------------------------------------------
   // Create the request frame
   //
-  String clRequestFrameT = String(":" + clAddressP + "w" + functionToString(teFunctionV) + "=" + String(uwValue1V) + ",");
-  if (teFunctionV == eFUNC_SET_VC)
+  ubRequestLengthP = encodeRequest(aszRequestBufferP, 'w', teFunctionV, uwValue1V, uwValue2V);
+  if (ubRequestLengthP == 0)
+  {
+    return eSTATUS_UNSUPPORTED;
+  }
+  pszRequestFrameP = aszRequestBufferP;
+  uwTransValue1P = uwValue1V;
+  uwTransValue2P = uwValue2V;
+
+  return beginTransaction(teFunctionV, eFUNC_WRITE_OK);
+}
+
+//--------------------------------------------------------------------------------------------------------------------//
+//                                                                                                                    //
+//                                                                                                                    //
+//--------------------------------------------------------------------------------------------------------------------//
+int32_t DPM86xx::beginTransaction(Function_te teFunctionV, Function_te teResponseV)
+{
+  //---------------------------------------------------------------------------------------------------
+  // store the expected response, the request is sent by poll() after the guard time has expired
+  //
+  teTransFunctionP = teFunctionV;
+  teTransResponseP = teResponseV;
+  ubTransRegistersP = 1;
+  ubCharCounterP = 0;
+  btFrameStartP = false;
+
+  //---------------------------------------------------------------------------------------------------
+  // make sure the write buffer is empty, the read buffer is drained during guard time
+  //
+  pclTransportP->flush();
+  ulTransStartP = millis();
+  teTransStateP = eTRANS_GUARD;
+
+  return eSTATUS_OK;
+}
+
+//--------------------------------------------------------------------------------------------------------------------//
+//                                                                                                                    //
+//                                                                                                                    //
+//--------------------------------------------------------------------------------------------------------------------//
+int32_t DPM86xx::poll()
+{
+  switch (teTransStateP)
   {
-    clRequestFrameT += String(String(uwValue2V) + ",");
+  case eTRANS_GUARD:
+    //-------------------------------------------------------------------------------------------
+    // make sure the read buffer is empty
+    //
+    while (pclTransportP->read() >= 0)
+    {
+      ulLastReceiveP = micros();
+    }
+
+    if (teGuardModeP == eGUARD_BAUD)
+    {
+      if (((uint32_t)micros() - ulLastReceiveP) < ulGuardTimeP)
+      {
+        break;
+      }
+    }
+    else if (((uint32_t)millis() - ulTransStartP) < DPM86XX_GUARD_TIME)
+    {
+      break;
+    }
+
+#ifdef DPM86XX_LOG_REQ_RESP
+    Serial.print("REQ: ");
+    if (teProtocolP == ePROTOCOL_MODBUS)
+    {
+      for (uint8_t ubIndexT = 0; ubIndexT < ubRequestLengthP; ubIndexT++)
+      {
+        Serial.print((long)(uint8_t)pszRequestFrameP[ubIndexT]);
+        Serial.print(" ");
+      }
+      Serial.println();
+    }
+    else
+    {
+      Serial.print(pszRequestFrameP);
+    }
+#endif
+
+    //-------------------------------------------------------------------------------------------
+    // print request frame to the UART and start waiting for the response
+    //
+    pclTransportP->write((const uint8_t *)pszRequestFrameP, ubRequestLengthP);
+    ulTransMicrosP = micros();
+    ulTransTimeoutP = responseTimeout(teTransFunctionP);
+    teTransStateP = eTRANS_RECEIVE;
+    break;
+
+  case eTRANS_RECEIVE:
+    //-------------------------------------------------------------------------------------------
+    // pass each received char to the frame decoder and finish the transaction as soon as the
+    // expected response is complete, noise and other frames are dropped by the decoder
+    //
+    while (pclTransportP->available())
+    {
+      uint8_t ubByteT = (uint8_t)pclTransportP->read();
+      ulLastReceiveP = micros();
+
+      if (decodeByte(ubByteT))
+      {
+        return finishTransaction((int32_t)ubCharCounterP);
+      }
+    }
+
+    if (((uint32_t)micros() - ulTransMicrosP) >= ulTransTimeoutP)
+    {
+      return finishTransaction(eSTATUS_RESP_TIMEOUT);
+    }
+    break;
+
+  case eTRANS_IDLE:
+  default:
+    return slTransResultP;
   }
 
+  return eSTATUS_BUSY;
+}
+
+//--------------------------------------------------------------------------------------------------------------------//
+//                                                                                                                    //
+//                                                                                                                    //
+//--------------------------------------------------------------------------------------------------------------------//
+int32_t DPM86xx::finishTransaction(int32_t slStatusV)
+{
+  int32_t slReturnT = slStatusV;
+
   //---------------------------------------------------------------------------------------------------
-  // write request and read response
+  // complete the string
   //
-  slReturnT = writeAndRead(clRequestFrameT);
+  aszReceiveBufferP[ubCharCounterP] = '\0';
+
+#ifdef DPM86XX_LOG_REQ_RESP
+  Serial.print("RES(");
+  Serial.print(slStatusV);
+  Serial.print("):");
+  Serial.println(aszReceiveBufferP);
+#endif
+
   if (slReturnT > 0)
   {
     //-------------------------------------------------------------------------------------------
     // parse response frame
     //
-    if (parseResponse(aszReceiveBufferP, slReturnT) != eFUNC_WRITE_OK)
+    Function_te teResponseT;
+    if (teProtocolP == ePROTOCOL_MODBUS)
+    {
+      teResponseT = parseResponseModbus((const uint8_t *)aszReceiveBufferP, (uint8_t)slReturnT);
+    }
+    else
+    {
+      teResponseT = parseResponse(aszReceiveBufferP, (uint8_t)slReturnT);
+    }
+
+    if (teResponseT != teTransResponseP)
     {
       //-----------------------------------------------------------------------------------
       // error the response is not the expected one
@@ -519,11 +1134,877 @@ int32_t DPM86xx::writeFunction(Function_te teFunctionV, uint16_t uwValue1V, uint
       slReturnT = eSTATUS_RESP_FRAME;
     }
 
-    else
+    else if (teTransResponseP == eFUNC_WRITE_OK)
     {
       slReturnT = eFUNC_WRITE_OK;
     }
+
+    else
+    {
+      //-----------------------------------------------------------------------------------
+      // success, remember the time of reception, get and return read value
+      //
+      for (uint8_t ubRegisterT = 0; ubRegisterT < ubTransRegistersP; ubRegisterT++)
+      {
+        uint8_t ubIndexT = readIndex((Function_te)(teTransResponseP + ubRegisterT));
+        if (ubIndexT < DPM86XX_READ_FUNCTIONS)
+        {
+          aulReadTimeP[ubIndexT] = micros();
+          ubReadValidP |= (uint8_t)(1 << ubIndexT);
+        }
+      }
+      slReturnT = (int32_t)functionValue(teTransResponseP);
+    }
+  }
+
+  updateStats(slReturnT);
+  if (teTransResponseP == eFUNC_WRITE_OK)
+  {
+    updateShadow(slReturnT);
+  }
+
+  slTransResultP = slReturnT;
+  teTransStateP = eTRANS_IDLE;
+
+  //---------------------------------------------------------------------------------------------------
+  // signal the completion, e.g. to a task that waits for a notification
+  //
+  if (pfnCompleteP != nullptr)
+  {
+    pfnCompleteP(*this, slReturnT, pvCompleteContextP);
+  }
+
+  return slReturnT;
+}
+
+//--------------------------------------------------------------------------------------------------------------------//
+//                                                                                                                    //
+//                                                                                                                    //
+//--------------------------------------------------------------------------------------------------------------------//
+int32_t DPM86xx::wait()
+{
+  int32_t slReturnT;
+
+  slReturnT = poll();
+  while (slReturnT == eSTATUS_BUSY)
+  {
+    //-------------------------------------------------------------------------------------------
+    // sleep until a byte has been received or the next step of the transaction is due
+    //
+    if (teReceiveModeP == eRECEIVE_EVENT)
+    {
+      pclTransportP->waitReadable(waitTime());
+    }
+    slReturnT = poll();
   }
 
   return slReturnT;
-}
\ No newline at end of file
+}
+
+//--------------------------------------------------------------------------------------------------------------------//
+//                                                                                                                    //
+//                                                                                                                    //
+//--------------------------------------------------------------------------------------------------------------------//
+bool DPM86xx::cancel()
+{
+  if (teTransStateP == eTRANS_RECEIVE)
+  {
+    return false;
+  }
+
+  teTransStateP = eTRANS_IDLE;
+  return true;
+}
+
+//--------------------------------------------------------------------------------------------------------------------//
+//                                                                                                                    //
+//                                                                                                                    //
+//--------------------------------------------------------------------------------------------------------------------//
+uint32_t DPM86xx::waitTime()
+{
+  uint32_t ulElapsedT;
+
+  //---------------------------------------------------------------------------------------------------
+  // time in [us] until poll() has to be called again at the latest
+  //
+  if (teTransStateP == eTRANS_RECEIVE)
+  {
+    ulElapsedT = (uint32_t)micros() - ulTransMicrosP;
+    return (ulElapsedT < ulTransTimeoutP) ? (ulTransTimeoutP - ulElapsedT) : 0;
+  }
+
+  if (teTransStateP == eTRANS_GUARD)
+  {
+    if (teGuardModeP == eGUARD_BAUD)
+    {
+      ulElapsedT = (uint32_t)micros() - ulLastReceiveP;
+      return (ulElapsedT < ulGuardTimeP) ? (ulGuardTimeP - ulElapsedT) : 0;
+    }
+    ulElapsedT = (uint32_t)millis() - ulTransStartP;
+    return (ulElapsedT < DPM86XX_GUARD_TIME) ? ((DPM86XX_GUARD_TIME - ulElapsedT) * 1000) : 0;
+  }
+
+  return 0;
+}
+
+//--------------------------------------------------------------------------------------------------------------------//
+//                                                                                                                    //
+//                                                                                                                    //
+//--------------------------------------------------------------------------------------------------------------------//
+void DPM86xx::setReceiveMode(Receive_te teModeV)
+{
+  teReceiveModeP = teModeV;
+}
+
+//--------------------------------------------------------------------------------------------------------------------//
+//                                                                                                                    //
+//                                                                                                                    //
+//--------------------------------------------------------------------------------------------------------------------//
+void DPM86xx::onComplete(Complete_tf pfnCompleteV, void *pvContextV)
+{
+  pfnCompleteP = pfnCompleteV;
+  pvCompleteContextP = pvContextV;
+}
+
+//--------------------------------------------------------------------------------------------------------------------//
+//                                                                                                                    //
+//                                                                                                                    //
+//--------------------------------------------------------------------------------------------------------------------//
+void DPM86xx::setMaxAge(Function_te teFunctionV, uint32_t ulMaxAgeV)
+{
+  uint8_t ubIndexT = readIndex(teFunctionV);
+  if (ubIndexT < DPM86XX_READ_FUNCTIONS)
+  {
+    aulMaxAgeP[ubIndexT] = ulMaxAgeV;
+  }
+}
+
+//--------------------------------------------------------------------------------------------------------------------//
+//                                                                                                                    //
+//                                                                                                                    //
+//--------------------------------------------------------------------------------------------------------------------//
+uint32_t DPM86xx::age(Function_te teFunctionV)
+{
+  uint8_t ubIndexT = readIndex(teFunctionV);
+  if ((ubIndexT >= DPM86XX_READ_FUNCTIONS) || ((ubReadValidP & (1 << ubIndexT)) == 0))
+  {
+    return 0xFFFFFFFF;
+  }
+  return (uint32_t)(((uint32_t)micros() - aulReadTimeP[ubIndexT]) / 1000);
+}
+
+//--------------------------------------------------------------------------------------------------------------------//
+//                                                                                                                    //
+//                                                                                                                    //
+//--------------------------------------------------------------------------------------------------------------------//
+int32_t DPM86xx::readSnapshot(Snapshot_ts &tsSnapshotR, uint8_t ubFieldsV)
+{
+  int32_t slReturnT;
+
+  tsSnapshotR.ubFields = 0;
+
+  //---------------------------------------------------------------------------------------------------
+  // with Modbus all measured values are read with one request, if more than one is requested
+  //
+  if ((teProtocolP == ePROTOCOL_MODBUS) && ((ubFieldsV & (ubFieldsV - 1)) != 0))
+  {
+    slReturnT = readMeasured();
+    if (slReturnT < 0)
+    {
+      return slReturnT;
+    }
+    tsSnapshotR.uwVoltage = uwMeasuredVoltageP;
+    tsSnapshotR.uwCurrent = uwMeasuredCurrentP;
+    tsSnapshotR.uwConstantOutput = uwConstantOutputP;
+    tsSnapshotR.uwTemperature = uwTemperatureP;
+    tsSnapshotR.ulVoltageTime = aulReadTimeP[readIndex(eFUNC_MEASURED_VOLTAGE)];
+    tsSnapshotR.ulCurrentTime = aulReadTimeP[readIndex(eFUNC_MEASURED_CURRENT)];
+    tsSnapshotR.ubFields = (uint8_t)(ubFieldsV & eSNAP_ALL);
+    tsSnapshotR.ulTimestamp = millis();
+    return eSTATUS_OK;
+  }
+
+  //---------------------------------------------------------------------------------------------------
+  // read voltage and current first and directly one after the other, followed by the slowly
+  // changing values
+  //
+  if (ubFieldsV & eSNAP_VOLTAGE)
+  {
+    slReturnT = readFunction(eFUNC_MEASURED_VOLTAGE);
+    if (slReturnT < 0)
+    {
+      return slReturnT;
+    }
+    tsSnapshotR.uwVoltage = (uint16_t)slReturnT;
+    tsSnapshotR.ulVoltageTime = aulReadTimeP[readIndex(eFUNC_MEASURED_VOLTAGE)];
+    tsSnapshotR.ubFields |= eSNAP_VOLTAGE;
+  }
+
+  if (ubFieldsV & eSNAP_CURRENT)
+  {
+    slReturnT = readFunction(eFUNC_MEASURED_CURRENT);
+    if (slReturnT < 0)
+    {
+      return slReturnT;
+    }
+    tsSnapshotR.uwCurrent = (uint16_t)slReturnT;
+    tsSnapshotR.ulCurrentTime = aulReadTimeP[readIndex(eFUNC_MEASURED_CURRENT)];
+    tsSnapshotR.ubFields |= eSNAP_CURRENT;
+  }
+
+  if (ubFieldsV & eSNAP_CONSTANT_OUTPUT)
+  {
+    slReturnT = readFunction(eFUNC_CONSTANT_OUTPUT);
+    if (slReturnT < 0)
+    {
+      return slReturnT;
+    }
+    tsSnapshotR.uwConstantOutput = (uint16_t)slReturnT;
+    tsSnapshotR.ubFields |= eSNAP_CONSTANT_OUTPUT;
+  }
+
+  if (ubFieldsV & eSNAP_TEMPERATURE)
+  {
+    slReturnT = readFunction(eFUNC_TEMPERATURE);
+    if (slReturnT < 0)
+    {
+      return slReturnT;
+    }
+    tsSnapshotR.uwTemperature = (uint16_t)slReturnT;
+    tsSnapshotR.ubFields |= eSNAP_TEMPERATURE;
+  }
+
+  tsSnapshotR.ulTimestamp = millis();
+
+  return eSTATUS_OK;
+}
+
+//--------------------------------------------------------------------------------------------------------------------//
+//                                                                                                                    //
+//                                                                                                                    //
+//--------------------------------------------------------------------------------------------------------------------//
+int32_t DPM86xx::readMeasured()
+{
+  int32_t slReturnT;
+
+  //---------------------------------------------------------------------------------------------------
+  // the ASCII protocol reads only one value per request
+  //
+  if (teProtocolP != ePROTOCOL_MODBUS)
+  {
+    for (uint8_t ubFunctionT = eFUNC_MEASURED_VOLTAGE; ubFunctionT <= eFUNC_TEMPERATURE; ubFunctionT++)
+    {
+      slReturnT = readFunction((Function_te)ubFunctionT);
+      if (slReturnT < 0)
+      {
+        return slReturnT;
+      }
+    }
+    return eSTATUS_OK;
+  }
+
+  if (teTransStateP != eTRANS_IDLE)
+  {
+    return eSTATUS_BUSY;
+  }
+
+  //---------------------------------------------------------------------------------------------------
+  // read the block of measured values with one request
+  //
+  ubRequestLengthP = DPM86xxModbus::encodeRead((uint8_t *)aszRequestBufferP, ubAddressP,
+                                               DPM86XX_MODBUS_REG_MEASURED_VOLTAGE, DPM86XX_MODBUS_MEASURED_BLOCK);
+  pszRequestFrameP = aszRequestBufferP;
+  beginTransaction(eFUNC_MEASURED_VOLTAGE, eFUNC_MEASURED_VOLTAGE);
+  ubTransRegistersP = DPM86XX_MODBUS_MEASURED_BLOCK;
+
+  slReturnT = wait();
+
+  return (slReturnT < 0) ? slReturnT : (int32_t)eSTATUS_OK;
+}
+
+//--------------------------------------------------------------------------------------------------------------------//
+//                                                                                                                    //
+//                                                                                                                    //
+//--------------------------------------------------------------------------------------------------------------------//
+uint8_t DPM86xx::statsIndex(Function_te teFunctionV)
+{
+  uint8_t ubReturnT = DPM86XX_STATS_FUNCTIONS; // not valid index
+
+  switch (teFunctionV)
+  {
+  case eFUNC_MAX_VOLTAGE:
+  case eFUNC_MAX_CURRENT:
+    ubReturnT = (uint8_t)teFunctionV;
+    break;
+  case eFUNC_SET_VOLTAGE:
+  case eFUNC_SET_CURRENT:
+  case eFUNC_OUTPUT_STATUS:
+    ubReturnT = (uint8_t)(teFunctionV - eFUNC_SET_VOLTAGE + 2);
+    break;
+  case eFUNC_SET_VC:
+    ubReturnT = 5;
+    break;
+  case eFUNC_MEASURED_VOLTAGE:
+  case eFUNC_MEASURED_CURRENT:
+  case eFUNC_CONSTANT_OUTPUT:
+  case eFUNC_TEMPERATURE:
+    ubReturnT = (uint8_t)(teFunctionV - eFUNC_MEASURED_VOLTAGE + 6);
+    break;
+
+  default:
+    break;
+  }
+
+  return ubReturnT;
+}
+
+//--------------------------------------------------------------------------------------------------------------------//
+//                                                                                                                    //
+//                                                                                                                    //
+//--------------------------------------------------------------------------------------------------------------------//
+void DPM86xx::updateStats(int32_t slStatusV)
+{
+  static const uint32_t aulBucketLimitT[DPM86XX_STATS_BUCKETS - 1] = {1000, 2000, 5000, 10000, 20000, 50000, 100000};
+  uint8_t ubIndexT = statsIndex(teTransFunctionP);
+  uint32_t ulRttT;
+  Stats_ts *ptsStatsT;
+
+  if (ubIndexT >= DPM86XX_STATS_FUNCTIONS)
+  {
+    return;
+  }
+  ptsStatsT = &atsStatsP[ubIndexT];
+  ptsStatsT->ulTransactions++;
+
+  switch (slStatusV)
+  {
+  case eSTATUS_RESP_TIMEOUT:
+    ptsStatsT->ulTimeouts++;
+    updateTimeout(ubIndexT, -1);
+    break;
+  case eSTATUS_RESP_BUFFER:
+    ptsStatsT->ulBufferErrors++;
+    break;
+  case eSTATUS_RESP_FRAME:
+    ptsStatsT->ulFrameErrors++;
+    break;
+
+  default:
+    //-------------------------------------------------------------------------------------------
+    // successful transaction, take the round-trip time into account
+    //
+    ulRttT = (uint32_t)micros() - ulTransMicrosP;
+    if (ulRttT < ptsStatsT->ulRttMin)
+    {
+      ptsStatsT->ulRttMin = ulRttT;
+    }
+    if (ulRttT > ptsStatsT->ulRttMax)
+    {
+      ptsStatsT->ulRttMax = ulRttT;
+    }
+    ptsStatsT->uqRttSum += ulRttT;
+    updateTimeout(ubIndexT, (int32_t)ulRttT);
+
+    ubIndexT = 0;
+    while ((ubIndexT < (DPM86XX_STATS_BUCKETS - 1)) && (ulRttT > aulBucketLimitT[ubIndexT]))
+    {
+      ubIndexT++;
+    }
+    ptsStatsT->aulHistogram[ubIndexT]++;
+    break;
+  }
+}
+
+//--------------------------------------------------------------------------------------------------------------------//
+//                                                                                                                    //
+//                                                                                                                    //
+//--------------------------------------------------------------------------------------------------------------------//
+void DPM86xx::stats(Function_te teFunctionV, Stats_ts &tsStatsR)
+{
+  uint8_t ubIndexT = statsIndex(teFunctionV);
+  uint32_t ulSuccessT;
+
+  if (ubIndexT >= DPM86XX_STATS_FUNCTIONS)
+  {
+    memset(&tsStatsR, 0, sizeof(tsStatsR));
+    return;
+  }
+
+  tsStatsR = atsStatsP[ubIndexT];
+
+  //---------------------------------------------------------------------------------------------------
+  // the mean value is calculated here, so the division is not needed for each transaction
+  //
+  ulSuccessT = tsStatsR.ulTransactions - tsStatsR.ulTimeouts - tsStatsR.ulBufferErrors - tsStatsR.ulFrameErrors;
+  if (ulSuccessT > 0)
+  {
+    tsStatsR.ulRttMean = (uint32_t)(tsStatsR.uqRttSum / ulSuccessT);
+  }
+  else
+  {
+    tsStatsR.ulRttMin = 0;
+  }
+}
+
+//--------------------------------------------------------------------------------------------------------------------//
+//                                                                                                                    //
+//                                                                                                                    //
+//--------------------------------------------------------------------------------------------------------------------//
+void DPM86xx::resetStats()
+{
+  memset(atsStatsP, 0, sizeof(atsStatsP));
+  ulDroppedBytesP = 0;
+  for (uint8_t ubIndexT = 0; ubIndexT < DPM86XX_STATS_FUNCTIONS; ubIndexT++)
+  {
+    atsStatsP[ubIndexT].ulRttMin = 0xFFFFFFFF;
+  }
+}
+
+//--------------------------------------------------------------------------------------------------------------------//
+//                                                                                                                    //
+//                                                                                                                    //
+//--------------------------------------------------------------------------------------------------------------------//
+uint32_t DPM86xx::droppedBytes()
+{
+  return ulDroppedBytesP;
+}
+
+//--------------------------------------------------------------------------------------------------------------------//
+//                                                                                                                    //
+//                                                                                                                    //
+//--------------------------------------------------------------------------------------------------------------------//
+void DPM86xx::setTimeoutMode(Timeout_te teModeV, uint32_t ulFloorV, uint32_t ulCeilingV)
+{
+  teTimeoutModeP = teModeV;
+  ulTimeoutFloorP = ulFloorV * 1000;
+  ulTimeoutCeilingP = (ulCeilingV > 0) ? (ulCeilingV * 1000) : (uint32_t)(uqResponseTimeP * 1000);
+  if (ulTimeoutFloorP > ulTimeoutCeilingP)
+  {
+    ulTimeoutFloorP = ulTimeoutCeilingP;
+  }
+
+  //---------------------------------------------------------------------------------------------------
+  // forget about round-trip times measured so far
+  //
+  for (uint8_t ubIndexT = 0; ubIndexT < DPM86XX_STATS_FUNCTIONS; ubIndexT++)
+  {
+    aulSrttP[ubIndexT] = 0;
+    aulRttVarP[ubIndexT] = 0;
+  }
+}
+
+//--------------------------------------------------------------------------------------------------------------------//
+//                                                                                                                    //
+//                                                                                                                    //
+//--------------------------------------------------------------------------------------------------------------------//
+uint32_t DPM86xx::responseTimeout(Function_te teFunctionV)
+{
+  uint8_t ubIndexT = statsIndex(teFunctionV);
+  uint32_t ulTimeoutT;
+
+  if ((teTimeoutModeP == eTIMEOUT_FIXED) || (ubIndexT >= DPM86XX_STATS_FUNCTIONS))
+  {
+    return (uint32_t)(uqResponseTimeP * 1000);
+  }
+
+  //---------------------------------------------------------------------------------------------------
+  // no round-trip time is known yet
+  //
+  if (aulSrttP[ubIndexT] == 0)
+  {
+    return ulTimeoutCeilingP;
+  }
+
+  //---------------------------------------------------------------------------------------------------
+  // RTO = SRTT + 4 * RTTVAR, limited to floor and ceiling
+  //
+  ulTimeoutT = (aulSrttP[ubIndexT] >> 3) + aulRttVarP[ubIndexT];
+  if (ulTimeoutT < ulTimeoutFloorP)
+  {
+    ulTimeoutT = ulTimeoutFloorP;
+  }
+  if (ulTimeoutT > ulTimeoutCeilingP)
+  {
+    ulTimeoutT = ulTimeoutCeilingP;
+  }
+
+  return ulTimeoutT;
+}
+
+//--------------------------------------------------------------------------------------------------------------------//
+//                                                                                                                    //
+//                                                                                                                    //
+//--------------------------------------------------------------------------------------------------------------------//
+void DPM86xx::updateTimeout(uint8_t ubIndexV, int32_t slRttV)
+{
+  int32_t slErrorT;
+
+  //---------------------------------------------------------------------------------------------------
+  // after a timeout the estimation starts again, so the ceiling is used for the next transaction
+  //
+  if (slRttV < 0)
+  {
+    aulSrttP[ubIndexV] = 0;
+    aulRttVarP[ubIndexV] = 0;
+    return;
+  }
+
+  //---------------------------------------------------------------------------------------------------
+  // first measurement: SRTT = R, RTTVAR = R / 2
+  // following ones:    RTTVAR = 3/4 RTTVAR + 1/4 |SRTT - R|, SRTT = 7/8 SRTT + 1/8 R
+  //
+  if (aulSrttP[ubIndexV] == 0)
+  {
+    aulSrttP[ubIndexV] = (uint32_t)slRttV << 3;
+    aulRttVarP[ubIndexV] = (uint32_t)slRttV << 1;
+  }
+  else
+  {
+    slErrorT = slRttV - (int32_t)(aulSrttP[ubIndexV] >> 3);
+    aulSrttP[ubIndexV] += slErrorT;
+    if (slErrorT < 0)
+    {
+      slErrorT = -slErrorT;
+    }
+    aulRttVarP[ubIndexV] += slErrorT - (aulRttVarP[ubIndexV] >> 2);
+  }
+}
+
+//--------------------------------------------------------------------------------------------------------------------//
+//                                                                                                                    //
+//                                                                                                                    //
+//--------------------------------------------------------------------------------------------------------------------//
+void DPM86xx::setGuardMode(Guard_te teModeV)
+{
+  teGuardModeP = teModeV;
+}
+
+//--------------------------------------------------------------------------------------------------------------------//
+//                                                                                                                    //
+//                                                                                                                    //
+//--------------------------------------------------------------------------------------------------------------------//
+void DPM86xx::setProtocol(Protocol_te teProtocolV)
+{
+  teProtocolP = teProtocolV;
+  prepareReadFrames();
+}
+
+//--------------------------------------------------------------------------------------------------------------------//
+//                                                                                                                    //
+//                                                                                                                    //
+//--------------------------------------------------------------------------------------------------------------------//
+bool DPM86xx::matchResponse()
+{
+  uint8_t ubStartT = 0;
+
+  //---------------------------------------------------------------------------------------------------
+  // check only address and function behind the last ':', the frame is validated later by
+  // parseResponse()
+  //
+  for (uint8_t ubIndexT = 0; ubIndexT < ubCharCounterP; ubIndexT++)
+  {
+    if (aszReceiveBufferP[ubIndexT] == ':')
+    {
+      ubStartT = ubIndexT + 1;
+    }
+  }
+  if ((ubCharCounterP - ubStartT) < 5)
+  {
+    return false;
+  }
+
+  const char *pszFrameT = &aszReceiveBufferP[ubStartT];
+  if ((pszFrameT[0] != aszAddressP[0]) || (pszFrameT[1] != aszAddressP[1]))
+  {
+    return false;
+  }
+
+  if (teTransResponseP == eFUNC_WRITE_OK)
+  {
+    return ((pszFrameT[2] == 'o') && (pszFrameT[3] == 'k'));
+  }
+
+  return ((pszFrameT[2] == 'r') && (pszFrameT[3] == (char)('0' + (teTransResponseP / 10))) &&
+          (pszFrameT[4] == (char)('0' + (teTransResponseP % 10))));
+}
+
+//--------------------------------------------------------------------------------------------------------------------//
+//                                                                                                                    //
+//                                                                                                                    //
+//--------------------------------------------------------------------------------------------------------------------//
+bool DPM86xx::decodeByte(uint8_t ubByteV)
+{
+  //---------------------------------------------------------------------------------------------------
+  // Modbus frames have no start symbol, so they are searched in the received bytes
+  //
+  if (teProtocolP == ePROTOCOL_MODBUS)
+  {
+    return decodeByteModbus(ubByteV);
+  }
+
+  //---------------------------------------------------------------------------------------------------
+  // ':' starts a new frame, the bytes received before are noise or a truncated frame
+  //
+  if (ubByteV == ':')
+  {
+    ulDroppedBytesP += ubCharCounterP;
+    ubCharCounterP = 0;
+    btFrameStartP = true;
+  }
+
+  if (btFrameStartP != true)
+  {
+    ulDroppedBytesP++;
+    return false;
+  }
+
+  //---------------------------------------------------------------------------------------------------
+  // a frame that does not fit into the buffer is not a valid response, wait for the next start
+  //
+  if (ubCharCounterP >= (DPM86XX_RECEIVE_BUFER_MAX - 1))
+  {
+    ulDroppedBytesP += (uint32_t)ubCharCounterP + 1;
+    ubCharCounterP = 0;
+    btFrameStartP = false;
+    return false;
+  }
+  aszReceiveBufferP[ubCharCounterP++] = (char)ubByteV;
+
+  if (ubByteV != '\n')
+  {
+    return false;
+  }
+
+  //---------------------------------------------------------------------------------------------------
+  // the frame is complete, take it if it is the response of the request
+  //
+  btFrameStartP = false;
+  if (matchResponse())
+  {
+    return true;
+  }
+  ulDroppedBytesP += ubCharCounterP;
+  ubCharCounterP = 0;
+
+  return false;
+}
+
+//--------------------------------------------------------------------------------------------------------------------//
+//                                                                                                                    //
+//                                                                                                                    //
+//--------------------------------------------------------------------------------------------------------------------//
+bool DPM86xx::decodeByteModbus(uint8_t ubByteV)
+{
+  const uint8_t *pubRequestT = (const uint8_t *)pszRequestFrameP;
+
+  aszReceiveBufferP[ubCharCounterP++] = (char)ubByteV;
+
+  //---------------------------------------------------------------------------------------------------
+  // The response may start at any received byte, e.g. behind noise or a truncated frame whose length
+  // can not be reached anymore. So each response of the request that ends with this byte is checked,
+  // the shortest one is 5 bytes.
+  //
+  for (uint8_t ubStartT = 0; (uint8_t)(ubStartT + 5) <= ubCharCounterP; ubStartT++)
+  {
+    const uint8_t *pubFrameT = (const uint8_t *)&aszReceiveBufferP[ubStartT];
+    uint8_t ubLengthT = (uint8_t)(ubCharCounterP - ubStartT);
+
+    if ((pubFrameT[0] == ubAddressP) && ((pubFrameT[1] & (uint8_t)~DPM86XX_MODBUS_EXCEPTION) == pubRequestT[1]) &&
+        (DPM86xxModbus::responseLength(pubFrameT, ubLengthT) == ubLengthT) &&
+        DPM86xxModbus::checkCrc(pubFrameT, ubLengthT))
+    {
+      memmove(aszReceiveBufferP, pubFrameT, ubLengthT);
+      ulDroppedBytesP += ubStartT;
+      ubCharCounterP = ubLengthT;
+      return true;
+    }
+  }
+
+  //---------------------------------------------------------------------------------------------------
+  // keep only the latest bytes, the longest response fits into the buffer
+  //
+  if (ubCharCounterP >= (DPM86XX_RECEIVE_BUFER_MAX - 1))
+  {
+    ubCharCounterP--;
+    memmove(aszReceiveBufferP, &aszReceiveBufferP[1], ubCharCounterP);
+    ulDroppedBytesP++;
+  }
+
+  return false;
+}
+
+//--------------------------------------------------------------------------------------------------------------------//
+//                                                                                                                    //
+//                                                                                                                    //
+//--------------------------------------------------------------------------------------------------------------------//
+void DPM86xx::stageVoltage(uint16_t uwVoltageV)
+{
+  auwStagedP[0] = uwVoltageV;
+  ubStagedP |= 0x01;
+}
+
+//--------------------------------------------------------------------------------------------------------------------//
+//                                                                                                                    //
+//                                                                                                                    //
+//--------------------------------------------------------------------------------------------------------------------//
+void DPM86xx::stageCurrent(uint16_t uwCurrentV)
+{
+  auwStagedP[1] = uwCurrentV;
+  ubStagedP |= 0x02;
+}
+
+//--------------------------------------------------------------------------------------------------------------------//
+//                                                                                                                    //
+//                                                                                                                    //
+//--------------------------------------------------------------------------------------------------------------------//
+void DPM86xx::stageOutput(bool btEnableV)
+{
+  auwStagedP[2] = btEnableV ? 1 : 0;
+  ubStagedP |= 0x04;
+}
+
+//--------------------------------------------------------------------------------------------------------------------//
+//                                                                                                                    //
+//                                                                                                                    //
+//--------------------------------------------------------------------------------------------------------------------//
+void DPM86xx::invalidateSetpoints()
+{
+  ubShadowValidP = 0;
+}
+
+//--------------------------------------------------------------------------------------------------------------------//
+//                                                                                                                    //
+//                                                                                                                    //
+//--------------------------------------------------------------------------------------------------------------------//
+uint32_t DPM86xx::elidedWrites()
+{
+  return ulElidedWritesP;
+}
+
+//--------------------------------------------------------------------------------------------------------------------//
+//                                                                                                                    //
+//                                                                                                                    //
+//--------------------------------------------------------------------------------------------------------------------//
+void DPM86xx::updateShadow(int32_t slStatusV)
+{
+  uint8_t ubMaskT;
+
+  switch (teTransFunctionP)
+  {
+  case eFUNC_SET_VOLTAGE:
+    ubMaskT = 0x01;
+    break;
+  case eFUNC_SET_CURRENT:
+    ubMaskT = 0x02;
+    break;
+  case eFUNC_OUTPUT_STATUS:
+    ubMaskT = 0x04;
+    break;
+  case eFUNC_SET_VC:
+    ubMaskT = 0x03;
+    break;
+  default:
+    return;
+  }
+
+  //---------------------------------------------------------------------------------------------------
+  // after a failure it is unknown whether the PSU has taken the value or not
+  //
+  if (slStatusV != eFUNC_WRITE_OK)
+  {
+    ubShadowValidP &= (uint8_t)~ubMaskT;
+    return;
+  }
+
+  if (teTransFunctionP == eFUNC_SET_VC)
+  {
+    auwShadowP[0] = uwTransValue1P;
+    auwShadowP[1] = uwTransValue2P;
+  }
+  else
+  {
+    auwShadowP[teTransFunctionP - eFUNC_SET_VOLTAGE] = uwTransValue1P;
+  }
+  ubShadowValidP |= ubMaskT;
+}
+
+//--------------------------------------------------------------------------------------------------------------------//
+//                                                                                                                    //
+//                                                                                                                    //
+//--------------------------------------------------------------------------------------------------------------------//
+int32_t DPM86xx::commitSetpoints()
+{
+  int32_t slReturnT = eFUNC_WRITE_OK;
+  uint8_t ubChangedT = 0;
+
+  //---------------------------------------------------------------------------------------------------
+  // find the staged values that differ from the values known by the PSU
+  //
+  for (uint8_t ubIndexT = 0; ubIndexT < 3; ubIndexT++)
+  {
+    uint8_t ubMaskT = (uint8_t)(1 << ubIndexT);
+    if ((ubStagedP & ubMaskT) != 0)
+    {
+      if (((ubShadowValidP & ubMaskT) == 0) || (auwShadowP[ubIndexT] != auwStagedP[ubIndexT]))
+      {
+        ubChangedT |= ubMaskT;
+      }
+      else
+      {
+        ubStagedP &= (uint8_t)~ubMaskT;
+        ulElidedWritesP++;
+      }
+    }
+  }
+
+  //---------------------------------------------------------------------------------------------------
+  // switch the output off before the setpoints are changed, a staged value is cleared only after it
+  // has been acknowledged, so that a failed or skipped write is repeated by the next call
+  //
+  if (((ubChangedT & 0x04) != 0) && (auwStagedP[2] == 0))
+  {
+    slReturnT = writeFunction(eFUNC_OUTPUT_STATUS, 0);
+    if (slReturnT == eFUNC_WRITE_OK)
+    {
+      ubStagedP &= (uint8_t)~0x04;
+    }
+    ubChangedT &= (uint8_t)~0x04;
+  }
+
+  //---------------------------------------------------------------------------------------------------
+  // write voltage and current, merged into one request if both have changed
+  //
+  if ((slReturnT == eFUNC_WRITE_OK) && ((ubChangedT & 0x03) != 0))
+  {
+    if ((ubChangedT & 0x03) == 0x03)
+    {
+      slReturnT = writeFunction(eFUNC_SET_VC, auwStagedP[0], auwStagedP[1]);
+    }
+    else if ((ubChangedT & 0x01) != 0)
+    {
+      slReturnT = writeFunction(eFUNC_SET_VOLTAGE, auwStagedP[0]);
+    }
+    else
+    {
+      slReturnT = writeFunction(eFUNC_SET_CURRENT, auwStagedP[1]);
+    }
+    if (slReturnT == eFUNC_WRITE_OK)
+    {
+      ubStagedP &= (uint8_t)~(ubChangedT & 0x03);
+    }
+  }
+
+  //---------------------------------------------------------------------------------------------------
+  // switch the output on once the setpoints are valid
+  //
+  if ((slReturnT == eFUNC_WRITE_OK) && ((ubChangedT & 0x04) != 0))
+  {
+    slReturnT = writeFunction(eFUNC_OUTPUT_STATUS, 1);
+    if (slReturnT == eFUNC_WRITE_OK)
+    {
+      ubStagedP &= (uint8_t)~0x04;
+    }
+  }
+
+  return slReturnT;
+}
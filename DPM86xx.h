@@ -9,7 +9,13 @@
 #ifndef DPM86xx_h
 #define DPM86xx_h
 
+#ifdef ARDUINO
 #include "Arduino.h"
+#else
+#include "DPM86xxHost.h"
+#endif
+#include "DPM86xxTransport.h"
+#include "DPM86xxModbus.h"
 
 /**
  * @brief Set this define to get Debug output for requests and responses via \c Serial interface.
@@ -19,12 +25,66 @@
 #undef DPM86XX_LOG_REQ_RESP
 #endif
 
+/**
+ * @brief Set this define to compile the former strtok() / String based response parser in addition to the
+ *        single-pass parser. It can then be selected at runtime with DPM86xx::useLegacyParser(), e.g. to compare
+ *        both implementations.
+ *
+ */
+#ifndef DPM86XX_LEGACY_PARSER
+#undef DPM86XX_LEGACY_PARSER
+#endif
+
 /**
  * @brief Maximal number of byte that are reserved for reception of response
  *
  */
 #define DPM86XX_RECEIVE_BUFER_MAX 24
 
+/**
+ * @brief Maximal number of byte that are reserved for a request frame, the longest one is
+ *        ":01w20=65535,65535,\r\n" with terminating zero
+ *
+ */
+#define DPM86XX_REQUEST_BUFFER_MAX 24
+
+/**
+ * @brief Number of functions that can be read, a request frame for each of them is prepared at init()
+ *
+ */
+#define DPM86XX_READ_FUNCTIONS 6
+
+/**
+ * @brief Maximal number of byte of a prepared read request frame ":01r30=0,\r\n" with terminating zero, also
+ *        used for Modbus read requests of 8 byte
+ *
+ */
+#define DPM86XX_READ_FRAME_MAX 12
+
+/**
+ * @brief Number of functions for which statistics are collected, see DPM86xx::stats()
+ *
+ */
+#define DPM86XX_STATS_FUNCTIONS 10
+
+/**
+ * @brief Number of buckets of the round-trip time histogram, see DPM86xx::Stats_s
+ *
+ */
+#define DPM86XX_STATS_BUCKETS 8
+
+/**
+ * @brief Default minimal response timeout in [ms] of the adaptive timeout mode, see DPM86xx::setTimeoutMode()
+ *
+ */
+#define DPM86XX_TIMEOUT_FLOOR 2
+
+/**
+ * @brief Time in [ms] that is waited after the transmit buffer has been flushed and before a new request is sent
+ *
+ */
+#define DPM86XX_GUARD_TIME 5
+
 class DPM86xx
 {
 public:
@@ -33,13 +93,36 @@ public:
    */
   typedef enum Status_e
   {
+    /**
+     * @brief A parameter is out of the supported range, e.g. a sweep needs more points than can be stored
+     */
+    eSTATUS_RANGE = -7,
+
+    /**
+     * @brief The function can not be mapped to a request of the selected protocol, e.g. the maximal voltage and
+     *        current with Modbus-RTU, as long as their registers are not defined, see \c DPM86xxModbus.h
+     */
+    eSTATUS_UNSUPPORTED = -6,
+
+    /**
+     * @brief The limits reported by the PSU do not match the expected model, see DPM86xxModel::init()
+     */
+    eSTATUS_MODEL = -5,
+
+    /**
+     * @brief A transaction is still in progress, returned by poll() while waiting for the response and by
+     *        beginRead() / beginWrite() if the previous transaction has not been finished yet
+     */
+    eSTATUS_BUSY = -4,
+
     /**
      * @brief The response Frame is not the expected one or it cold not be parsed
      */
     eSTATUS_RESP_FRAME = -3,
 
     /**
-     * @brief Number of received data exceeds the capacity of the receive buffer
+     * @brief Number of received data exceeds the capacity of the receive buffer, no longer returned since frames
+     *        that do not fit are dropped by the frame decoder
      */
     eSTATUS_RESP_BUFFER = -2,
 
@@ -77,17 +160,196 @@ public:
     eFUNC_INVALID = 255
   } Function_te;
 
+  /**
+   * @brief Modes of calculation of the time to wait for a response, see setTimeoutMode()
+   */
+  typedef enum Timeout_e
+  {
+    /**
+     * @brief The time is calculated once at init() from the baud rate
+     */
+    eTIMEOUT_FIXED = 0,
+
+    /**
+     * @brief The time is derived from the measured round-trip times of each function
+     */
+    eTIMEOUT_ADAPTIVE
+  } Timeout_te;
+
+  /**
+   * @brief Modes of the guard between two transactions, see setGuardMode()
+   */
+  typedef enum Guard_e
+  {
+    /**
+     * @brief A fixed time of \c #DPM86XX_GUARD_TIME is waited before each request
+     */
+    eGUARD_FIXED = 0,
+
+    /**
+     * @brief Only the time of 3.5 characters at the configured baud rate is waited after the last received byte
+     */
+    eGUARD_BAUD
+  } Guard_te;
+
+  /**
+   * @brief Protocols spoken by the PSU, see setProtocol()
+   */
+  typedef enum Protocol_e
+  {
+    /**
+     * @brief ASCII protocol of the TTL version, e.g. ":01r30=0,"
+     */
+    ePROTOCOL_ASCII = 0,
+
+    /**
+     * @brief Modbus-RTU protocol of the RS-485 version
+     */
+    ePROTOCOL_MODBUS
+  } Protocol_te;
+
+  /**
+   * @brief Modes of waiting for the response by the blocking methods, see setReceiveMode()
+   */
+  typedef enum Receive_e
+  {
+    /**
+     * @brief poll() is called continuously until the transaction is finished
+     */
+    eRECEIVE_POLL = 0,
+
+    /**
+     * @brief The calling task sleeps in \c DPM86xxTransport::waitReadable() until a byte has been received or the
+     *        guard time or response timeout expires
+     */
+    eRECEIVE_EVENT
+  } Receive_te;
+
+  /**
+   * @brief Function that is called when a transaction has been finished, see onComplete()
+   *
+   * @param[in] clPsuR PSU that has finished the transaction
+   * @param[in] slResultV same value as returned by \c #poll() for the finished transaction
+   * @param[in] pvContextV pointer passed to onComplete()
+   */
+  typedef void (*Complete_tf)(DPM86xx &clPsuR, int32_t slResultV, void *pvContextV);
+
+  /**
+   * @brief Fields of a \c #Snapshot_s, that can be combined to request a subset by readSnapshot()
+   */
+  typedef enum SnapshotField_e
+  {
+    eSNAP_VOLTAGE = 0x01,
+    eSNAP_CURRENT = 0x02,
+    eSNAP_CONSTANT_OUTPUT = 0x04,
+    eSNAP_TEMPERATURE = 0x08,
+    eSNAP_ALL = 0x0F
+  } SnapshotField_te;
+
+  /**
+   * @brief Measured values of the PSU that are returned by readSnapshot()
+   */
+  typedef struct Snapshot_s
+  {
+    /**
+     * @brief Time in [ms] given by millis() when the snapshot has been completed
+     */
+    uint32_t ulTimestamp;
+
+    /**
+     * @brief Time in [us] given by micros() when the measured voltage has been received
+     */
+    uint32_t ulVoltageTime;
+
+    /**
+     * @brief Time in [us] given by micros() when the measured current has been received
+     */
+    uint32_t ulCurrentTime;
+
+    uint16_t uwVoltage;
+    uint16_t uwCurrent;
+    uint16_t uwConstantOutput;
+    uint16_t uwTemperature;
+
+    /**
+     * @brief Combination of \c #SnapshotField_e values that are valid
+     */
+    uint8_t ubFields;
+  } Snapshot_ts;
+
+  /**
+   * @brief Statistics of the transactions of one function, returned by stats()
+   *
+   * The round-trip time is measured from transmission of the request until the complete response has been
+   * received, only successful transactions are taken into account.
+   */
+  typedef struct Stats_s
+  {
+    /**
+     * @brief Number of transactions that have been finished
+     */
+    uint32_t ulTransactions;
+
+    /**
+     * @brief Number of transactions that failed with \c #eSTATUS_RESP_TIMEOUT
+     */
+    uint32_t ulTimeouts;
+
+    /**
+     * @brief Number of transactions that failed with \c #eSTATUS_RESP_BUFFER
+     */
+    uint32_t ulBufferErrors;
+
+    /**
+     * @brief Number of transactions that failed with \c #eSTATUS_RESP_FRAME
+     */
+    uint32_t ulFrameErrors;
+
+    /**
+     * @brief Minimal, maximal and mean round-trip time in [us]
+     */
+    uint32_t ulRttMin;
+    uint32_t ulRttMax;
+    uint32_t ulRttMean;
+
+    /**
+     * @brief Sum of all round-trip times in [us]
+     */
+    uint64_t uqRttSum;
+
+    /**
+     * @brief Number of transactions per round-trip time range, the upper limits of the buckets are
+     *        1 ms, 2 ms, 5 ms, 10 ms, 20 ms, 50 ms, 100 ms and infinite.
+     */
+    uint32_t aulHistogram[DPM86XX_STATS_BUCKETS];
+  } Stats_ts;
+
   /**
    * @brief Construct a new DPM86xx object
    */
   DPM86xx();
 
+#ifdef ARDUINO
   /**
    * @brief Initialisation of object parameters
    *
    * @param[in] clSerialIfR interface, that should be used by this object
+   * @param[in] ubAddressV address of the PSU in range from 1 to 99
+   *
+   * The statistics of transactions and dropped bytes are reset, see resetStats().
    */
   void init(HardwareSerial &clSerialIfR, uint8_t ubAddressV = 1);
+#endif
+
+  /**
+   * @brief Initialisation of object parameters
+   *
+   * @param[in] clTransportR byte stream, that should be used by this object, e.g. a simulated PSU
+   * @param[in] ubAddressV address of the PSU in range from 1 to 99
+   *
+   * The statistics of transactions and dropped bytes are reset, see resetStats().
+   */
+  void init(DPM86xxTransport &clTransportR, uint8_t ubAddressV = 1);
 
   /**
    * @brief Read a value from PSU
@@ -111,6 +373,75 @@ public:
    */
   int32_t writeFunction(Function_te teFunctionV, uint16_t uwValue1V, uint16_t uwValue2V = 0);
 
+  /**
+   * @brief Start a non-blocking read of a value from PSU
+   *
+   * @param[in] teFunctionV number from \c #Function_e enumeration that should be read.
+   * @return \c #eSTATUS_OK if the transaction has been started, \c #eSTATUS_BUSY if another transaction is pending.
+   *
+   * The transaction is processed by subsequent calls of \c #poll().
+   */
+  int32_t beginRead(Function_te teFunctionV);
+
+  /**
+   * @brief Start a non-blocking write of a value to PSU
+   *
+   * @param[in] teFunctionV number from \c #Function_e enumeration that should be writte.
+   * @param[in] uwValue1V first value that should be written.
+   * @param[in] uwValue2V second value that should be written, only for \c #eFUNC_SET_VC function valid.
+   * @return \c #eSTATUS_OK if the transaction has been started, \c #eSTATUS_BUSY if another transaction is pending.
+   *
+   * The transaction is processed by subsequent calls of \c #poll().
+   */
+  int32_t beginWrite(Function_te teFunctionV, uint16_t uwValue1V, uint16_t uwValue2V = 0);
+
+  /**
+   * @brief Process the pending transaction, this method never blocks
+   *
+   * @return \c #eSTATUS_BUSY as long as the transaction is in progress. Once it is finished, the same value is
+   *         returned as by \c #readFunction() or \c #writeFunction() respectively. If no transaction is pending,
+   *         the result of the last one is returned.
+   */
+  int32_t poll();
+
+  /**
+   * @brief Process the pending transaction until it is finished
+   *
+   * @return same value as returned by \c #poll() once the transaction is finished
+   *
+   * This is used by readFunction() and writeFunction(). In \c #eRECEIVE_EVENT mode the calling task does not spin
+   * on poll(), but sleeps in the transport while nothing has to be done.
+   */
+  int32_t wait();
+
+  /**
+   * @brief Abort the pending transaction, as long as its request has not been sent
+   *
+   * @return \c true if the transaction has been aborted or no transaction is pending
+   *
+   * Once the request is on the line, the transaction can not be aborted, as the response would collide with the
+   * next request. An aborted transaction is neither counted in the statistics nor reported by onComplete().
+   */
+  bool cancel();
+
+  /**
+   * @brief Select how the blocking methods wait for the response
+   *
+   * @param[in] teModeV \c #eRECEIVE_POLL (default) or \c #eRECEIVE_EVENT
+   */
+  void setReceiveMode(Receive_te teModeV);
+
+  /**
+   * @brief Register a function that is called each time a transaction has been finished
+   *
+   * @param[in] pfnCompleteV function to call, \c nullptr to remove it
+   * @param[in] pvContextV pointer passed to the function, e.g. the handle of a task to notify
+   *
+   * The function is called from the context that has finished the transaction, i.e. from poll() or a method that
+   * calls it. A value returned from the cache by beginRead() is reported immediately.
+   */
+  void onComplete(Complete_tf pfnCompleteV, void *pvContextV = nullptr);
+
   /**
    * @brief Returns the maximum output voltage supported by the PSU
    * @return float value given in [V]
@@ -174,17 +505,349 @@ public:
    */
   float temperature();
 
+  /**
+   * @brief Returns the maximum output voltage supported by the PSU
+   * @return value given in [mV]
+   *
+   * Make sure that the \c #readFunction() has been successfully triggered with function number from \c #Function_e
+   * that corresponds to this value.
+   */
+  uint32_t maxMillivolt();
+
+  /**
+   * @brief Returns the maximum output current supported by the PSU
+   * @return value given in [mA]
+   *
+   * Make sure that the \c #readFunction() has been successfully triggered with function number from \c #Function_e
+   * that corresponds to this value.
+   */
+  uint32_t maxMilliampere();
+
+  /**
+   * @brief Returns the measured output voltage
+   * @return value given in [mV]
+   *
+   * Make sure that the \c #readFunction() has been successfully triggered with function number from \c #Function_e
+   * that corresponds to this value.
+   */
+  uint32_t measuredMillivolt();
+
+  /**
+   * @brief Returns the measured output current
+   * @return value given in [mA]
+   *
+   * Make sure that the \c #readFunction() has been successfully triggered with function number from \c #Function_e
+   * that corresponds to this value.
+   */
+  uint32_t measuredMilliampere();
+
+  /**
+   * @brief Returns the output power calculated from measured voltage and current with integer arithmetic
+   * @return value given in [mW]
+   *
+   * Make sure that the \c #readFunction() has been successfully triggered with function numbers from
+   * \c #Function_e that correspond to measured voltage and current.
+   */
+  uint32_t measuredMilliwatt();
+
+  /**
+   * @brief Write voltage setpoint
+   *
+   * @param[in] ulMillivoltV voltage in [mV], rounded to the resolution of 10 mV
+   * @return see writeFunction()
+   */
+  int32_t setVoltage(uint32_t ulMillivoltV);
+
+  /**
+   * @brief Write current setpoint
+   *
+   * @param[in] ulMilliampereV current in [mA]
+   * @return see writeFunction()
+   */
+  int32_t setCurrent(uint32_t ulMilliampereV);
+
+  /**
+   * @brief Write voltage and current setpoint with one request
+   *
+   * @param[in] ulMillivoltV voltage in [mV], rounded to the resolution of 10 mV
+   * @param[in] ulMilliampereV current in [mA]
+   * @return see writeFunction()
+   */
+  int32_t setVoltageCurrent(uint32_t ulMillivoltV, uint32_t ulMilliampereV);
+
+  /**
+   * @brief Returns the register value of a voltage setpoint, as written by setVoltage()
+   *
+   * @param[in] ulMillivoltV voltage in [mV], rounded to the resolution of 10 mV
+   * @return voltage in [10 mV], limited to the range of the register
+   */
+  static constexpr uint16_t millivoltRegister(uint32_t ulMillivoltV)
+  {
+    return (ulMillivoltV >= (0xFFFFUL * 10)) ? (uint16_t)0xFFFF : (uint16_t)((ulMillivoltV + 5) / 10);
+  }
+
+  /**
+   * @brief Returns the register value of a current setpoint, as written by setCurrent()
+   *
+   * @param[in] ulMilliampereV current in [mA]
+   * @return current in [mA], limited to the range of the register
+   */
+  static constexpr uint16_t milliampereRegister(uint32_t ulMilliampereV)
+  {
+    return (ulMilliampereV > 0xFFFF) ? (uint16_t)0xFFFF : (uint16_t)ulMilliampereV;
+  }
+
+  /**
+   * @brief Read several measured values from PSU
+   *
+   * @param[out] tsSnapshotR values that have been read, together with the time of reception
+   * @param[in] ubFieldsV combination of \c #SnapshotField_e values that should be read
+   * @return On success \c #eSTATUS_OK is returned. On failure, a negative value of \c #Status_e is returned and
+   *         only the fields marked in \c ubFields of the snapshot are valid.
+   *
+   * Voltage and current are read directly one after the other, so the time between both is as short as possible.
+   * Values whose age is below the maximal age defined by setMaxAge() are taken without bus transaction.
+   */
+  int32_t readSnapshot(Snapshot_ts &tsSnapshotR, uint8_t ubFieldsV = eSNAP_ALL);
+
+  /**
+   * @brief Read measured voltage, measured current, constant output and temperature
+   *
+   * @return On success \c #eSTATUS_OK is returned. On failure, a negative value of \c #Status_e is returned.
+   *
+   * With \c #ePROTOCOL_MODBUS all four registers are read with one request, the transaction is accounted in the
+   * statistics of \c #eFUNC_MEASURED_VOLTAGE. With \c #ePROTOCOL_ASCII the values are read one after the other.
+   */
+  int32_t readMeasured();
+
+  /**
+   * @brief Define how long a read value is valid
+   *
+   * @param[in] teFunctionV number from \c #Function_e enumeration that can be read.
+   * @param[in] ulMaxAgeV time in [ms], 0 disables caching of the value (default)
+   *
+   * As long as the last successfully read value is younger, readFunction() and beginRead() return it without
+   * bus transaction.
+   */
+  void setMaxAge(Function_te teFunctionV, uint32_t ulMaxAgeV);
+
+  /**
+   * @brief Returns the time passed since the value has been read successfully
+   *
+   * @param[in] teFunctionV number from \c #Function_e enumeration that can be read.
+   * @return time in [ms], 0xFFFFFFFF if the value has not been read yet
+   */
+  uint32_t age(Function_te teFunctionV);
+
+  /**
+   * @brief Get the statistics of transactions
+   *
+   * @param[in] teFunctionV number from \c #Function_e enumeration
+   * @param[out] tsStatsR statistics of the function, all values are 0 for unsupported functions
+   */
+  void stats(Function_te teFunctionV, Stats_ts &tsStatsR);
+
+  /**
+   * @brief Reset the statistics of all functions
+   */
+  void resetStats();
+
+  /**
+   * @brief Returns the number of received bytes, that have been dropped by the frame decoder
+   *
+   * Bytes are dropped if they do not belong to a frame, e.g. noise on the line, or if they belong to a frame that
+   * is not the response of the pending request.
+   */
+  uint32_t droppedBytes();
+
+  /**
+   * @brief Select how the time to wait for a response is calculated
+   *
+   * @param[in] teModeV \c #eTIMEOUT_FIXED (default) or \c #eTIMEOUT_ADAPTIVE
+   * @param[in] ulFloorV minimal time in [ms] used by the adaptive mode
+   * @param[in] ulCeilingV maximal time in [ms] used by the adaptive mode, 0 selects the time of the fixed mode
+   *
+   * In adaptive mode a smoothed round-trip time and its variation are tracked for each function, in the same way
+   * as the retransmission timeout of TCP (RFC 6298). The time to wait is the smoothed round-trip time plus four
+   * times its variation, limited to floor and ceiling. Until the first response of a function has been received
+   * and after each timeout, the ceiling is used.
+   */
+  void setTimeoutMode(Timeout_te teModeV, uint32_t ulFloorV = DPM86XX_TIMEOUT_FLOOR, uint32_t ulCeilingV = 0);
+
+  /**
+   * @brief Select the guard that is waited before each request
+   *
+   * @param[in] teModeV \c #eGUARD_FIXED (default) or \c #eGUARD_BAUD
+   *
+   * With \c #eGUARD_BAUD the request is sent as soon as the line has been idle for 3.5 characters. Stale bytes
+   * that arrive after the request are skipped by the frame decoder in both modes: a complete frame that is not the
+   * expected response is dropped and reception continues until the expected one arrives or the timeout expires.
+   */
+  void setGuardMode(Guard_te teModeV);
+
+  /**
+   * @brief Select the protocol spoken by the PSU
+   *
+   * @param[in] teProtocolV \c #ePROTOCOL_ASCII (default) or \c #ePROTOCOL_MODBUS
+   *
+   * The protocol can be selected before or after init(). With \c #ePROTOCOL_MODBUS the function numbers are
+   * mapped to the holding registers defined in DPM86xxModbus.h, so readFunction() and writeFunction() are used
+   * in the same way as with the ASCII protocol.
+   */
+  void setProtocol(Protocol_te teProtocolV);
+
+  /**
+   * @brief Stage a new voltage setpoint, that is written by commitSetpoints()
+   *
+   * @param[in] uwVoltageV voltage in [10 mV]
+   */
+  void stageVoltage(uint16_t uwVoltageV);
+
+  /**
+   * @brief Stage a new current setpoint, that is written by commitSetpoints()
+   *
+   * @param[in] uwCurrentV current in [mA]
+   */
+  void stageCurrent(uint16_t uwCurrentV);
+
+  /**
+   * @brief Stage a new output status, that is written by commitSetpoints()
+   *
+   * @param[in] btEnableV \c true to switch the output on
+   */
+  void stageOutput(bool btEnableV);
+
+  /**
+   * @brief Write the staged setpoints to the PSU with as few transactions as possible
+   *
+   * @return On success, \c #eFUNC_WRITE_OK is returned, also if no write was necessary. On failure, a negative
+   *         value of \c #Status_e is returned.
+   *
+   * The last acknowledged values of voltage, current and output status are kept as shadow copies, also for writes
+   * by writeFunction(). Staged values that equal their shadow copy are not written. If voltage and current have to
+   * be written, both are merged into one \c #eFUNC_SET_VC request. Setpoints are written before the output is
+   * switched on, but after it is switched off. A failed write invalidates the shadow copies concerned.
+   *
+   * A staged value is cleared once it has been acknowledged by the PSU or equals its shadow copy. Values of a failed
+   * write and of writes that are skipped after a failure stay staged, so the next call retries them.
+   */
+  int32_t commitSetpoints();
+
+  /**
+   * @brief Invalidate the shadow copies of the setpoints, so the next commitSetpoints() writes all staged values
+   *
+   * This is necessary if the setpoints may have been changed at the PSU directly.
+   */
+  void invalidateSetpoints();
+
+  /**
+   * @brief Returns the number of writes that have been skipped by commitSetpoints(), because the value was known
+   */
+  uint32_t elidedWrites();
+
+  /**
+   * @brief Returns the time that is waited for the response of a function
+   *
+   * @param[in] teFunctionV number from \c #Function_e enumeration
+   * @return time in [us]
+   */
+  uint32_t responseTimeout(Function_te teFunctionV);
+
+#ifdef DPM86XX_LEGACY_PARSER
+  /**
+   * @brief Select the response parser
+   *
+   * @param[in] btEnableV \c true to use the former strtok() / String based parser, \c false for the single-pass
+   *            parser, that is used by default.
+   */
+  void useLegacyParser(bool btEnableV);
+
+  /**
+   * @brief Parse a response frame with the selected parser, e.g. to compare both implementations on a host
+   *
+   * @param[in] pszFrameV response frame as it is received, it may contain fault data before the frame
+   * @param[in] ubLengthV number of bytes in \c pszFrameV
+   * @param[out] uwValueR value of a read function, 0 otherwise
+   * @return number from \c #Function_e enumeration, \c #eFUNC_INVALID if the frame is not valid
+   */
+  Function_te parseFrame(const char *pszFrameV, uint8_t ubLengthV, uint16_t &uwValueR);
+#endif
+
 private:
-  bool isNumber(const std::string &sclStringR);
-  int32_t writeAndRead(const String clFrameV);
+  /**
+   * @brief States of the transaction state machine processed by poll()
+   */
+  typedef enum TransState_e
+  {
+    eTRANS_IDLE = 0,
+    eTRANS_GUARD,
+    eTRANS_RECEIVE
+  } TransState_te;
+
+  int32_t beginTransaction(Function_te teFunctionV, Function_te teResponseV);
+  void updateStats(int32_t slStatusV);
+  void updateTimeout(uint8_t ubIndexV, int32_t slRttV);
+  static uint8_t statsIndex(const Function_te teFunctionV);
+  int32_t finishTransaction(int32_t slStatusV);
+  uint32_t waitTime();
+  bool matchResponse();
+  bool decodeByte(uint8_t ubByteV);
+  bool decodeByteModbus(uint8_t ubByteV);
+  void prepareReadFrames();
+  uint8_t encodeRequest(char *pszBufferV, char chCommandV, Function_te teFunctionV, uint16_t uwValue1V,
+                        uint16_t uwValue2V);
+  static uint16_t modbusRegister(Function_te teFunctionV);
+  Function_te parseResponseModbus(const uint8_t *pubBufferV, uint8_t ubLengthV);
+  void updateShadow(int32_t slStatusV);
   Function_te parseResponse(char *pszBufferV, const uint8_t ubLengthV);
-  String functionToString(const Function_te teFunctionV);
+#ifdef DPM86XX_LEGACY_PARSER
+  bool isNumber(const std::string &sclStringR);
+  Function_te parseResponseLegacy(char *pszBufferV, const uint8_t ubLengthV);
+  bool btLegacyParserP;
+#endif
+  uint8_t encodeFrame(char *pszBufferV, char chCommandV, const Function_te teFunctionV, uint16_t uwValue1V,
+                      uint16_t uwValue2V);
+  static uint8_t encodeNumber(char *pszBufferV, uint16_t uwValueV, uint8_t ubMinDigitsV);
+  static uint8_t readIndex(const Function_te teFunctionV);
   uint16_t functionValue(const Function_te teFunctionV);
 
-  HardwareSerial *pclSeralP;
+#ifdef ARDUINO
+  DPM86xxSerial clSerialP;
+#endif
+  DPM86xxTransport *pclTransportP;
   uint64_t uqResponseTimeP;
-  String clAddressP;
+  char aszAddressP[3];
   char aszReceiveBufferP[DPM86XX_RECEIVE_BUFER_MAX];
+  char aszRequestBufferP[DPM86XX_REQUEST_BUFFER_MAX];
+  char aaszReadFrameP[DPM86XX_READ_FUNCTIONS][DPM86XX_READ_FRAME_MAX];
+  uint8_t aubReadFrameLengthP[DPM86XX_READ_FUNCTIONS];
+  uint8_t ubAddressP;
+  Protocol_te teProtocolP;
+
+  //---------------------------------------------------------------------------------------------------
+  // transaction state
+  //
+  TransState_te teTransStateP;
+  Function_te teTransFunctionP;
+  Function_te teTransResponseP;
+  uint32_t ulTransMicrosP;
+  uint16_t uwTransValue1P;
+  uint16_t uwTransValue2P;
+  uint8_t ubTransRegistersP;
+  uint32_t ulTransTimeoutP;
+  Guard_te teGuardModeP;
+  uint32_t ulGuardTimeP;
+  uint32_t ulLastReceiveP;
+  const char *pszRequestFrameP;
+  uint8_t ubRequestLengthP;
+  uint32_t ulTransStartP;
+  uint8_t ubCharCounterP;
+  bool btFrameStartP;
+  uint32_t ulDroppedBytesP;
+  int32_t slTransResultP;
+  Receive_te teReceiveModeP;
+  Complete_tf pfnCompleteP;
+  void *pvCompleteContextP;
 
   //---------------------------------------------------------------------------------------------------
   // formatted values
@@ -195,6 +858,42 @@ private:
   uint16_t uwMeasuredVoltageP;
   uint16_t uwConstantOutputP;
   uint16_t uwTemperatureP;
+
+  //---------------------------------------------------------------------------------------------------
+  // time in [us] of the last successful read and maximal age in [ms] of readable functions
+  //
+  uint32_t aulReadTimeP[DPM86XX_READ_FUNCTIONS];
+  uint32_t aulMaxAgeP[DPM86XX_READ_FUNCTIONS];
+  uint8_t ubReadValidP;
+
+  //---------------------------------------------------------------------------------------------------
+  // statistics of transactions
+  //
+  Stats_ts atsStatsP[DPM86XX_STATS_FUNCTIONS];
+
+  //---------------------------------------------------------------------------------------------------
+  // staged setpoints and shadow copies of the last acknowledged ones, bit 0: voltage, bit 1: current
+  // and bit 2: output status
+  //
+  uint16_t auwStagedP[3];
+  uint16_t auwShadowP[3];
+  uint8_t ubStagedP;
+  uint8_t ubShadowValidP;
+  uint32_t ulElidedWritesP;
+
+  //---------------------------------------------------------------------------------------------------
+  // adaptive timeout: smoothed round-trip time (scaled by 8) and its variation (scaled by 4) in [us]
+  //
+  Timeout_te teTimeoutModeP;
+  uint32_t ulTimeoutFloorP;
+  uint32_t ulTimeoutCeilingP;
+  uint32_t aulSrttP[DPM86XX_STATS_FUNCTIONS];
+  uint32_t aulRttVarP[DPM86XX_STATS_FUNCTIONS];
+
+  /**
+   * @brief Table of formatted values indexed by the function number, not readable functions are \c nullptr
+   */
+  static uint16_t DPM86xx::*const aupFunctionValueP[eFUNC_TEMPERATURE + 1];
 };
 
 #endif
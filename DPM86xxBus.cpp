@@ -0,0 +1,858 @@
+//====================================================================================================================//
+// File:          DPM86xxBus.cpp                                                                                      //
+// Description:   DPM86xxBus implementation                                                                           //
+// Author:        Tiderko                                                                                             //
+//--------------------------------------------------------------------------------------------------------------------//
+//                                                                                                                    //
+//====================================================================================================================//
+
+#include <DPM86xxBus.h>
+
+//--------------------------------------------------------------------------------------------------------------------//
+//                                                                                                                    //
+//                                                                                                                    //
+//--------------------------------------------------------------------------------------------------------------------//
+DPM86xxHandle::DPM86xxHandle()
+{
+  pclBusP = nullptr;
+  ubIndexP = 0;
+}
+
+//--------------------------------------------------------------------------------------------------------------------//
+//                                                                                                                    //
+//                                                                                                                    //
+//--------------------------------------------------------------------------------------------------------------------//
+DPM86xxHandle::DPM86xxHandle(DPM86xxBus *pclBusV, uint8_t ubIndexV)
+{
+  pclBusP = pclBusV;
+  ubIndexP = ubIndexV;
+}
+
+//--------------------------------------------------------------------------------------------------------------------//
+//                                                                                                                    //
+//                                                                                                                    //
+//--------------------------------------------------------------------------------------------------------------------//
+bool DPM86xxHandle::isValid()
+{
+  return (pclBusP != nullptr);
+}
+
+//--------------------------------------------------------------------------------------------------------------------//
+//                                                                                                                    //
+//                                                                                                                    //
+//--------------------------------------------------------------------------------------------------------------------//
+int32_t DPM86xxHandle::readFunction(DPM86xx::Function_te teFunctionV)
+{
+  return pclBusP->readFunction(ubIndexP, teFunctionV);
+}
+
+//--------------------------------------------------------------------------------------------------------------------//
+//                                                                                                                    //
+//                                                                                                                    //
+//--------------------------------------------------------------------------------------------------------------------//
+int32_t DPM86xxHandle::writeFunction(DPM86xx::Function_te teFunctionV, uint16_t uwValue1V, uint16_t uwValue2V)
+{
+  return pclBusP->writeFunction(ubIndexP, teFunctionV, uwValue1V, uwValue2V);
+}
+
+//--------------------------------------------------------------------------------------------------------------------//
+//                                                                                                                    //
+//                                                                                                                    //
+//--------------------------------------------------------------------------------------------------------------------//
+int32_t DPM86xxHandle::submitRead(DPM86xx::Function_te teFunctionV, DPM86xxBus::Priority_te teClassV)
+{
+  return pclBusP->submitRead(ubIndexP, teFunctionV, teClassV);
+}
+
+//--------------------------------------------------------------------------------------------------------------------//
+//                                                                                                                    //
+//                                                                                                                    //
+//--------------------------------------------------------------------------------------------------------------------//
+int32_t DPM86xxHandle::submitWrite(DPM86xx::Function_te teFunctionV, uint16_t uwValue1V, uint16_t uwValue2V,
+                                   DPM86xxBus::Priority_te teClassV)
+{
+  return pclBusP->submitWrite(ubIndexP, teFunctionV, uwValue1V, uwValue2V, teClassV);
+}
+
+//--------------------------------------------------------------------------------------------------------------------//
+//                                                                                                                    //
+//                                                                                                                    //
+//--------------------------------------------------------------------------------------------------------------------//
+uint16_t DPM86xxHandle::model()
+{
+  return pclBusP->auwModelP[ubIndexP];
+}
+
+//--------------------------------------------------------------------------------------------------------------------//
+//                                                                                                                    //
+//                                                                                                                    //
+//--------------------------------------------------------------------------------------------------------------------//
+DPM86xx &DPM86xxHandle::psu()
+{
+  return pclBusP->aclPsuP[ubIndexP];
+}
+
+//--------------------------------------------------------------------------------------------------------------------//
+//                                                                                                                    //
+//                                                                                                                    //
+//--------------------------------------------------------------------------------------------------------------------//
+DPM86xxBus::DPM86xxBus()
+{
+  const DPM86xx::Function_te ateTelemetryT[] = {DPM86xx::eFUNC_MEASURED_VOLTAGE, DPM86xx::eFUNC_MEASURED_CURRENT,
+                                                DPM86xx::eFUNC_CONSTANT_OUTPUT, DPM86xx::eFUNC_TEMPERATURE};
+
+  pclTransportP = nullptr;
+  ubCountP = 0;
+  setTelemetry(ateTelemetryT, DPM86XX_BUS_TELEMETRY_MAX);
+
+  for (uint8_t ubClassT = 0; ubClassT < DPM86XX_BUS_PRIORITIES; ubClassT++)
+  {
+    aubQueueCountP[ubClassT] = 0;
+    aulStaleTimeP[ubClassT] = (ubClassT >= ePRIO_TELEMETRY) ? DPM86XX_BUS_STALE_TIME : 0;
+  }
+  btActivePendingP = false;
+  resetQueueStats();
+}
+
+#ifdef ARDUINO
+//--------------------------------------------------------------------------------------------------------------------//
+//                                                                                                                    //
+//                                                                                                                    //
+//--------------------------------------------------------------------------------------------------------------------//
+void DPM86xxBus::init(HardwareSerial &clSerialIfR)
+{
+  clSerialP.init(clSerialIfR);
+  init(clSerialP);
+}
+#endif
+
+//--------------------------------------------------------------------------------------------------------------------//
+//                                                                                                                    //
+//                                                                                                                    //
+//--------------------------------------------------------------------------------------------------------------------//
+void DPM86xxBus::init(DPM86xxTransport &clTransportR)
+{
+  pclTransportP = &clTransportR;
+  detachAll();
+  ulSampleCountP = 0;
+  ulErrorCountP = 0;
+}
+
+//--------------------------------------------------------------------------------------------------------------------//
+//                                                                                                                    //
+//                                                                                                                    //
+//--------------------------------------------------------------------------------------------------------------------//
+void DPM86xxBus::detachAll()
+{
+  ubCountP = 0;
+  ubPollDeviceP = 0;
+  ubPollFunctionP = 0;
+  btPollPendingP = false;
+
+  //---------------------------------------------------------------------------------------------------
+  // queued requests refer to the detached PSUs
+  //
+  for (uint8_t ubClassT = 0; ubClassT < DPM86XX_BUS_PRIORITIES; ubClassT++)
+  {
+    aubQueueCountP[ubClassT] = 0;
+  }
+  btActivePendingP = false;
+}
+
+//--------------------------------------------------------------------------------------------------------------------//
+//                                                                                                                    //
+//                                                                                                                    //
+//--------------------------------------------------------------------------------------------------------------------//
+DPM86xxHandle DPM86xxBus::attach(uint8_t ubAddressV, uint16_t uwModelV)
+{
+  if ((pclTransportP == nullptr) || (ubCountP >= DPM86XX_BUS_DEVICES_MAX) || (ubAddressV < 1) || (ubAddressV > 99))
+  {
+    return DPM86xxHandle();
+  }
+
+  //---------------------------------------------------------------------------------------------------
+  // the slot may have been used by a detached PSU or for probing, so its settings are cleared
+  //
+  aclPsuP[ubCountP].init(*pclTransportP, ubAddressV);
+  aclPsuP[ubCountP].onComplete(nullptr, nullptr);
+  for (uint8_t ubFunctionT = 0; ubFunctionT <= DPM86xx::eFUNC_TEMPERATURE; ubFunctionT++)
+  {
+    aclPsuP[ubCountP].setMaxAge((DPM86xx::Function_te)ubFunctionT, 0);
+  }
+  aubAddressP[ubCountP] = ubAddressV;
+  auwModelP[ubCountP] = uwModelV;
+  ubCountP++;
+
+  return DPM86xxHandle(this, ubCountP - 1);
+}
+
+//--------------------------------------------------------------------------------------------------------------------//
+//                                                                                                                    //
+//                                                                                                                    //
+//--------------------------------------------------------------------------------------------------------------------//
+uint8_t DPM86xxBus::count()
+{
+  return ubCountP;
+}
+
+//--------------------------------------------------------------------------------------------------------------------//
+//                                                                                                                    //
+//                                                                                                                    //
+//--------------------------------------------------------------------------------------------------------------------//
+DPM86xxHandle DPM86xxBus::device(uint8_t ubIndexV)
+{
+  if (ubIndexV >= ubCountP)
+  {
+    return DPM86xxHandle();
+  }
+  return DPM86xxHandle(this, ubIndexV);
+}
+
+//--------------------------------------------------------------------------------------------------------------------//
+//                                                                                                                    //
+//                                                                                                                    //
+//--------------------------------------------------------------------------------------------------------------------//
+uint16_t DPM86xxBus::identifyModel(uint16_t uwMaxVoltageV, uint16_t uwMaxCurrentV)
+{
+  //---------------------------------------------------------------------------------------------------
+  // all models provide 60 V, the maximal current in [A] is given by the last two digits
+  //
+  if ((uwMaxVoltageV == 6000) && ((uwMaxCurrentV == 5000) || (uwMaxCurrentV == 8000) || (uwMaxCurrentV == 16000) ||
+                                  (uwMaxCurrentV == 24000)))
+  {
+    return (uint16_t)(8600 + (uwMaxCurrentV / 1000));
+  }
+  return 0;
+}
+
+//--------------------------------------------------------------------------------------------------------------------//
+//                                                                                                                    //
+//                                                                                                                    //
+//--------------------------------------------------------------------------------------------------------------------//
+uint8_t DPM86xxBus::discover(uint8_t ubFirstV, uint8_t ubLastV, uint32_t ulProbeTimeV)
+{
+  int32_t slMaxVoltageT;
+  int32_t slMaxCurrentT;
+
+  if (pclTransportP == nullptr)
+  {
+    return 0;
+  }
+  detachAll();
+
+  //---------------------------------------------------------------------------------------------------
+  // The probe time covers the transmission of ":01r00=0,\r\n" and ":01r00=6000.\r\n", 25 characters
+  // of 10 bits, and the turnaround time of the PSU:
+  //
+  //  ProbeTime = 1000 * 25 * 10 / Baudrate + ProbeMargin
+  //
+  if (ulProbeTimeV == 0)
+  {
+    ulProbeTimeV = ((1000UL * 25 * 10) + pclTransportP->baudRate() - 1) / pclTransportP->baudRate();
+    ulProbeTimeV += DPM86XX_BUS_PROBE_MARGIN;
+  }
+
+  if (ubFirstV < 1)
+  {
+    ubFirstV = 1;
+  }
+  if (ubLastV > 99)
+  {
+    ubLastV = 99;
+  }
+
+  for (uint16_t uwAddressT = ubFirstV; uwAddressT <= ubLastV; uwAddressT++)
+  {
+    if (ubCountP >= DPM86XX_BUS_DEVICES_MAX)
+    {
+      break;
+    }
+
+    //-------------------------------------------------------------------------------------------
+    // the free slot is used for probing, the guard of 3.5 characters drops late responses of
+    // the previous address
+    //
+    DPM86xx &clProbeT = aclPsuP[ubCountP];
+    clProbeT.init(*pclTransportP, (uint8_t)uwAddressT);
+    clProbeT.setTimeoutMode(DPM86xx::eTIMEOUT_ADAPTIVE, ulProbeTimeV, ulProbeTimeV);
+    clProbeT.setGuardMode(DPM86xx::eGUARD_BAUD);
+
+    slMaxVoltageT = clProbeT.readFunction(DPM86xx::eFUNC_MAX_VOLTAGE);
+    if (slMaxVoltageT < 0)
+    {
+      continue;
+    }
+    slMaxCurrentT = clProbeT.readFunction(DPM86xx::eFUNC_MAX_CURRENT);
+    if (slMaxCurrentT < 0)
+    {
+      continue;
+    }
+
+    attach((uint8_t)uwAddressT, identifyModel((uint16_t)slMaxVoltageT, (uint16_t)slMaxCurrentT));
+  }
+
+  return ubCountP;
+}
+
+//--------------------------------------------------------------------------------------------------------------------//
+//                                                                                                                    //
+//                                                                                                                    //
+//--------------------------------------------------------------------------------------------------------------------//
+size_t DPM86xxBus::saveMap(uint8_t *pubBufferV, size_t ulSizeV)
+{
+  uint8_t ubLengthT = 0;
+  uint16_t uwCrcT;
+
+  if (ulSizeV < (size_t)(2 + (3 * ubCountP) + 2))
+  {
+    return 0;
+  }
+
+  //---------------------------------------------------------------------------------------------------
+  // version, number of PSUs, address and model of each PSU, protected by a CRC
+  //
+  pubBufferV[ubLengthT++] = DPM86XX_BUS_MAP_VERSION;
+  pubBufferV[ubLengthT++] = ubCountP;
+  for (uint8_t ubIndexT = 0; ubIndexT < ubCountP; ubIndexT++)
+  {
+    pubBufferV[ubLengthT++] = aubAddressP[ubIndexT];
+    pubBufferV[ubLengthT++] = (uint8_t)(auwModelP[ubIndexT] >> 8);
+    pubBufferV[ubLengthT++] = (uint8_t)(auwModelP[ubIndexT] & 0xFF);
+  }
+  uwCrcT = DPM86xxModbus::crc16(pubBufferV, ubLengthT);
+  pubBufferV[ubLengthT++] = (uint8_t)(uwCrcT & 0xFF);
+  pubBufferV[ubLengthT++] = (uint8_t)(uwCrcT >> 8);
+
+  return ubLengthT;
+}
+
+//--------------------------------------------------------------------------------------------------------------------//
+//                                                                                                                    //
+//                                                                                                                    //
+//--------------------------------------------------------------------------------------------------------------------//
+uint8_t DPM86xxBus::loadMap(const uint8_t *pubBufferV, size_t ulSizeV)
+{
+  uint8_t ubCountT;
+
+  //---------------------------------------------------------------------------------------------------
+  // check version, length and CRC before anything is attached
+  //
+  if ((pclTransportP == nullptr) || (ulSizeV < 4) || (pubBufferV[0] != DPM86XX_BUS_MAP_VERSION))
+  {
+    return 0;
+  }
+  ubCountT = pubBufferV[1];
+  if ((ubCountT > DPM86XX_BUS_DEVICES_MAX) || (ulSizeV < (size_t)(2 + (3 * ubCountT) + 2)) ||
+      (DPM86xxModbus::checkCrc(pubBufferV, (uint8_t)(2 + (3 * ubCountT) + 2)) != true))
+  {
+    return 0;
+  }
+
+  detachAll();
+  for (uint8_t ubIndexT = 0; ubIndexT < ubCountT; ubIndexT++)
+  {
+    const uint8_t *pubDeviceT = &pubBufferV[2 + (3 * ubIndexT)];
+    attach(pubDeviceT[0], DPM86xxModbus::value(&pubDeviceT[1]));
+  }
+
+  return ubCountP;
+}
+
+//--------------------------------------------------------------------------------------------------------------------//
+//                                                                                                                    //
+//                                                                                                                    //
+//--------------------------------------------------------------------------------------------------------------------//
+void DPM86xxBus::setTelemetry(const DPM86xx::Function_te ateFunctionV[], uint8_t ubCountV)
+{
+  if (ubCountV > DPM86XX_BUS_TELEMETRY_MAX)
+  {
+    ubCountV = DPM86XX_BUS_TELEMETRY_MAX;
+  }
+
+  for (uint8_t ubIndexT = 0; ubIndexT < ubCountV; ubIndexT++)
+  {
+    ateTelemetryP[ubIndexT] = ateFunctionV[ubIndexT];
+  }
+  ubTelemetryCountP = ubCountV;
+  ubPollFunctionP = 0;
+}
+
+//--------------------------------------------------------------------------------------------------------------------//
+//                                                                                                                    //
+//                                                                                                                    //
+//--------------------------------------------------------------------------------------------------------------------//
+uint32_t DPM86xxBus::sampleCount()
+{
+  return ulSampleCountP;
+}
+
+//--------------------------------------------------------------------------------------------------------------------//
+//                                                                                                                    //
+//                                                                                                                    //
+//--------------------------------------------------------------------------------------------------------------------//
+uint32_t DPM86xxBus::errorCount()
+{
+  return ulErrorCountP;
+}
+
+//--------------------------------------------------------------------------------------------------------------------//
+//                                                                                                                    //
+//                                                                                                                    //
+//--------------------------------------------------------------------------------------------------------------------//
+void DPM86xxBus::process()
+{
+  //---------------------------------------------------------------------------------------------------
+  // process the pending transaction, unless it can give way to a safety request
+  //
+  if ((btPollPendingP || btActivePendingP) && (preemptPending() == false))
+  {
+    if (btPollPendingP)
+    {
+      pollPending();
+    }
+    else
+    {
+      pollActive();
+    }
+
+    if (btPollPendingP || btActivePendingP)
+    {
+      return;
+    }
+  }
+
+  //---------------------------------------------------------------------------------------------------
+  // the bus is idle, start the next queued request or request the next telemetry value
+  //
+  if (startQueued())
+  {
+    return;
+  }
+
+  if ((ubCountP > 0) && (ubTelemetryCountP > 0))
+  {
+    if (aclPsuP[ubPollDeviceP].beginRead(ateTelemetryP[ubPollFunctionP]) == DPM86xx::eSTATUS_OK)
+    {
+      btPollPendingP = true;
+    }
+  }
+}
+
+//--------------------------------------------------------------------------------------------------------------------//
+//                                                                                                                    //
+//                                                                                                                    //
+//--------------------------------------------------------------------------------------------------------------------//
+bool DPM86xxBus::preemptPending()
+{
+  if (aubQueueCountP[ePRIO_SAFETY] == 0)
+  {
+    return false;
+  }
+
+  //---------------------------------------------------------------------------------------------------
+  // the telemetry polling is continued later with the same function
+  //
+  if (btPollPendingP)
+  {
+    if (aclPsuP[ubPollDeviceP].cancel() == false)
+    {
+      return false;
+    }
+    btPollPendingP = false;
+    return true;
+  }
+
+  //---------------------------------------------------------------------------------------------------
+  // a queued read is put back at the front of its queue, it is dropped if the queue is full
+  //
+  if ((teActiveClassP < ePRIO_TELEMETRY) || (aclPsuP[tsActiveP.ubDevice].cancel() == false))
+  {
+    return false;
+  }
+  btActivePendingP = false;
+  aulStartedP[teActiveClassP]--;
+  auqWaitSumP[teActiveClassP] -= ulActiveWaitP;
+
+  uint8_t ubCountT = aubQueueCountP[teActiveClassP];
+  if (ubCountT >= DPM86XX_BUS_QUEUE_MAX)
+  {
+    atsQueueStatsP[teActiveClassP].ulDropped++;
+    return true;
+  }
+  for (uint8_t ubPositionT = ubCountT; ubPositionT > 0; ubPositionT--)
+  {
+    atsQueueP[teActiveClassP][ubPositionT] = atsQueueP[teActiveClassP][ubPositionT - 1];
+  }
+  atsQueueP[teActiveClassP][0] = tsActiveP;
+  aubQueueCountP[teActiveClassP] = ubCountT + 1;
+
+  return true;
+}
+
+//--------------------------------------------------------------------------------------------------------------------//
+//                                                                                                                    //
+//                                                                                                                    //
+//--------------------------------------------------------------------------------------------------------------------//
+bool DPM86xxBus::startQueued()
+{
+  for (uint8_t ubClassT = 0; ubClassT < DPM86XX_BUS_PRIORITIES; ubClassT++)
+  {
+    QueueStats_ts &tsStatsT = atsQueueStatsP[ubClassT];
+
+    while (aubQueueCountP[ubClassT] > 0)
+    {
+      Request_ts tsRequestT = atsQueueP[ubClassT][0];
+      uint32_t ulWaitT = (uint32_t)micros() - tsRequestT.ulSubmitTime;
+      int32_t slResultT;
+
+      removeQueued((Priority_te)ubClassT, 0);
+
+      //-----------------------------------------------------------------------------------
+      // stale requests are dropped without transaction
+      //
+      if ((aulStaleTimeP[ubClassT] > 0) && (ulWaitT > (aulStaleTimeP[ubClassT] * 1000)))
+      {
+        tsStatsT.ulDropped++;
+        continue;
+      }
+
+      if (tsRequestT.btWrite)
+      {
+        slResultT = aclPsuP[tsRequestT.ubDevice].beginWrite(tsRequestT.teFunction, tsRequestT.uwValue1,
+                                                            tsRequestT.uwValue2);
+      }
+      else
+      {
+        slResultT = aclPsuP[tsRequestT.ubDevice].beginRead(tsRequestT.teFunction);
+      }
+
+      if (slResultT != DPM86xx::eSTATUS_OK)
+      {
+        tsStatsT.ulCompleted++;
+        tsStatsT.ulErrors++;
+        continue;
+      }
+
+      auqWaitSumP[ubClassT] += ulWaitT;
+      aulStartedP[ubClassT]++;
+      if (ulWaitT > tsStatsT.ulMaxWait)
+      {
+        tsStatsT.ulMaxWait = ulWaitT;
+      }
+      tsActiveP = tsRequestT;
+      ulActiveWaitP = ulWaitT;
+      teActiveClassP = (Priority_te)ubClassT;
+      btActivePendingP = true;
+      return true;
+    }
+  }
+
+  return false;
+}
+
+//--------------------------------------------------------------------------------------------------------------------//
+//                                                                                                                    //
+//                                                                                                                    //
+//--------------------------------------------------------------------------------------------------------------------//
+void DPM86xxBus::pollActive()
+{
+  int32_t slResultT = aclPsuP[tsActiveP.ubDevice].poll();
+  if (slResultT == DPM86xx::eSTATUS_BUSY)
+  {
+    return;
+  }
+
+  //---------------------------------------------------------------------------------------------------
+  // the queued request is finished
+  //
+  QueueStats_ts &tsStatsT = atsQueueStatsP[teActiveClassP];
+  uint32_t ulLatencyT = (uint32_t)micros() - tsActiveP.ulSubmitTime;
+
+  btActivePendingP = false;
+  tsStatsT.ulCompleted++;
+  if (slResultT < 0)
+  {
+    tsStatsT.ulErrors++;
+  }
+  if (ulLatencyT > tsStatsT.ulMaxLatency)
+  {
+    tsStatsT.ulMaxLatency = ulLatencyT;
+  }
+}
+
+//--------------------------------------------------------------------------------------------------------------------//
+//                                                                                                                    //
+//                                                                                                                    //
+//--------------------------------------------------------------------------------------------------------------------//
+int32_t DPM86xxBus::submitRead(uint8_t ubIndexV, DPM86xx::Function_te teFunctionV, Priority_te teClassV)
+{
+  Request_ts tsRequestT;
+
+  tsRequestT.teFunction = teFunctionV;
+  tsRequestT.uwValue1 = 0;
+  tsRequestT.uwValue2 = 0;
+  tsRequestT.ubDevice = ubIndexV;
+  tsRequestT.btWrite = false;
+
+  return submit(teClassV, tsRequestT);
+}
+
+//--------------------------------------------------------------------------------------------------------------------//
+//                                                                                                                    //
+//                                                                                                                    //
+//--------------------------------------------------------------------------------------------------------------------//
+int32_t DPM86xxBus::submitWrite(uint8_t ubIndexV, DPM86xx::Function_te teFunctionV, uint16_t uwValue1V,
+                                uint16_t uwValue2V, Priority_te teClassV)
+{
+  Request_ts tsRequestT;
+
+  tsRequestT.teFunction = teFunctionV;
+  tsRequestT.uwValue1 = uwValue1V;
+  tsRequestT.uwValue2 = uwValue2V;
+  tsRequestT.ubDevice = ubIndexV;
+  tsRequestT.btWrite = true;
+
+  return submit(teClassV, tsRequestT);
+}
+
+//--------------------------------------------------------------------------------------------------------------------//
+//                                                                                                                    //
+//                                                                                                                    //
+//--------------------------------------------------------------------------------------------------------------------//
+int32_t DPM86xxBus::submit(Priority_te teClassV, const Request_ts &tsRequestV)
+{
+  if ((tsRequestV.ubDevice >= ubCountP) || ((uint8_t)teClassV >= DPM86XX_BUS_PRIORITIES))
+  {
+    return DPM86xx::eSTATUS_RESP_FRAME;
+  }
+
+  Request_ts *atsQueueT = atsQueueP[teClassV];
+  QueueStats_ts &tsStatsT = atsQueueStatsP[teClassV];
+  uint32_t ulTimeT = micros();
+
+  //---------------------------------------------------------------------------------------------------
+  // a safety write supersedes the queued writes of the same PSU and function in lower classes
+  //
+  if ((teClassV == ePRIO_SAFETY) && tsRequestV.btWrite)
+  {
+    for (uint8_t ubClassT = ePRIO_SETPOINT; ubClassT < DPM86XX_BUS_PRIORITIES; ubClassT++)
+    {
+      uint8_t ubPositionT = 0;
+      while (ubPositionT < aubQueueCountP[ubClassT])
+      {
+        const Request_ts &tsQueuedT = atsQueueP[ubClassT][ubPositionT];
+        if (tsQueuedT.btWrite && (tsQueuedT.ubDevice == tsRequestV.ubDevice) &&
+            (tsQueuedT.teFunction == tsRequestV.teFunction))
+        {
+          removeQueued((Priority_te)ubClassT, ubPositionT);
+          atsQueueStatsP[ubClassT].ulDropped++;
+        }
+        else
+        {
+          ubPositionT++;
+        }
+      }
+    }
+  }
+
+  //---------------------------------------------------------------------------------------------------
+  // merge with a queued request of the same PSU and function: a read is refreshed, a write takes the
+  // new values, safety requests are never merged
+  //
+  if (teClassV != ePRIO_SAFETY)
+  {
+    for (uint8_t ubPositionT = 0; ubPositionT < aubQueueCountP[teClassV]; ubPositionT++)
+    {
+      Request_ts &tsQueuedT = atsQueueT[ubPositionT];
+      if ((tsQueuedT.btWrite == tsRequestV.btWrite) && (tsQueuedT.ubDevice == tsRequestV.ubDevice) &&
+          (tsQueuedT.teFunction == tsRequestV.teFunction))
+      {
+        if (tsQueuedT.btWrite)
+        {
+          tsQueuedT.uwValue1 = tsRequestV.uwValue1;
+          tsQueuedT.uwValue2 = tsRequestV.uwValue2;
+        }
+        else
+        {
+          tsQueuedT.ulSubmitTime = ulTimeT;
+        }
+        tsStatsT.ulMerged++;
+        return DPM86xx::eSTATUS_OK;
+      }
+    }
+  }
+
+  //---------------------------------------------------------------------------------------------------
+  // a full queue of reads drops its oldest request, the other classes refuse the new one
+  //
+  if (aubQueueCountP[teClassV] >= DPM86XX_BUS_QUEUE_MAX)
+  {
+    if (teClassV < ePRIO_TELEMETRY)
+    {
+      return DPM86xx::eSTATUS_BUSY;
+    }
+    removeQueued(teClassV, 0);
+    tsStatsT.ulDropped++;
+  }
+
+  atsQueueT[aubQueueCountP[teClassV]] = tsRequestV;
+  atsQueueT[aubQueueCountP[teClassV]].ulSubmitTime = ulTimeT;
+  aubQueueCountP[teClassV]++;
+  tsStatsT.ulSubmitted++;
+  if (aubQueueCountP[teClassV] > tsStatsT.ubMaxDepth)
+  {
+    tsStatsT.ubMaxDepth = aubQueueCountP[teClassV];
+  }
+
+  return DPM86xx::eSTATUS_OK;
+}
+
+//--------------------------------------------------------------------------------------------------------------------//
+//                                                                                                                    //
+//                                                                                                                    //
+//--------------------------------------------------------------------------------------------------------------------//
+void DPM86xxBus::removeQueued(Priority_te teClassV, uint8_t ubPositionV)
+{
+  aubQueueCountP[teClassV]--;
+  for (uint8_t ubPositionT = ubPositionV; ubPositionT < aubQueueCountP[teClassV]; ubPositionT++)
+  {
+    atsQueueP[teClassV][ubPositionT] = atsQueueP[teClassV][ubPositionT + 1];
+  }
+}
+
+//--------------------------------------------------------------------------------------------------------------------//
+//                                                                                                                    //
+//                                                                                                                    //
+//--------------------------------------------------------------------------------------------------------------------//
+void DPM86xxBus::setStaleTime(Priority_te teClassV, uint32_t ulStaleTimeV)
+{
+  if ((uint8_t)teClassV < DPM86XX_BUS_PRIORITIES)
+  {
+    aulStaleTimeP[teClassV] = ulStaleTimeV;
+  }
+}
+
+//--------------------------------------------------------------------------------------------------------------------//
+//                                                                                                                    //
+//                                                                                                                    //
+//--------------------------------------------------------------------------------------------------------------------//
+void DPM86xxBus::queueStats(Priority_te teClassV, QueueStats_ts &tsStatsR)
+{
+  if ((uint8_t)teClassV >= DPM86XX_BUS_PRIORITIES)
+  {
+    return;
+  }
+
+  tsStatsR = atsQueueStatsP[teClassV];
+  tsStatsR.ubDepth = aubQueueCountP[teClassV];
+
+  //---------------------------------------------------------------------------------------------------
+  // the mean wait time is taken over all started requests
+  //
+  if (aulStartedP[teClassV] > 0)
+  {
+    tsStatsR.ulMeanWait = (uint32_t)(auqWaitSumP[teClassV] / aulStartedP[teClassV]);
+  }
+}
+
+//--------------------------------------------------------------------------------------------------------------------//
+//                                                                                                                    //
+//                                                                                                                    //
+//--------------------------------------------------------------------------------------------------------------------//
+void DPM86xxBus::resetQueueStats()
+{
+  for (uint8_t ubClassT = 0; ubClassT < DPM86XX_BUS_PRIORITIES; ubClassT++)
+  {
+    QueueStats_ts &tsStatsT = atsQueueStatsP[ubClassT];
+
+    tsStatsT.ulSubmitted = 0;
+    tsStatsT.ulCompleted = 0;
+    tsStatsT.ulErrors = 0;
+    tsStatsT.ulMerged = 0;
+    tsStatsT.ulDropped = 0;
+    tsStatsT.ubDepth = 0;
+    tsStatsT.ubMaxDepth = 0;
+    tsStatsT.ulMeanWait = 0;
+    tsStatsT.ulMaxWait = 0;
+    tsStatsT.ulMaxLatency = 0;
+    auqWaitSumP[ubClassT] = 0;
+    aulStartedP[ubClassT] = 0;
+  }
+}
+
+//--------------------------------------------------------------------------------------------------------------------//
+//                                                                                                                    //
+//                                                                                                                    //
+//--------------------------------------------------------------------------------------------------------------------//
+void DPM86xxBus::pollPending()
+{
+  int32_t slResultT = aclPsuP[ubPollDeviceP].poll();
+  if (slResultT == DPM86xx::eSTATUS_BUSY)
+  {
+    return;
+  }
+
+  //---------------------------------------------------------------------------------------------------
+  // the read is finished, continue with next function or PSU
+  //
+  btPollPendingP = false;
+  if (slResultT >= 0)
+  {
+    ulSampleCountP++;
+  }
+  else
+  {
+    ulErrorCountP++;
+  }
+
+  ubPollFunctionP++;
+  if (ubPollFunctionP >= ubTelemetryCountP)
+  {
+    ubPollFunctionP = 0;
+    ubPollDeviceP++;
+    if (ubPollDeviceP >= ubCountP)
+    {
+      ubPollDeviceP = 0;
+    }
+  }
+}
+
+//--------------------------------------------------------------------------------------------------------------------//
+//                                                                                                                    //
+//                                                                                                                    //
+//--------------------------------------------------------------------------------------------------------------------//
+void DPM86xxBus::finishPending()
+{
+  //---------------------------------------------------------------------------------------------------
+  // the pending transaction is completed first, so frames of different PSUs never interleave
+  //
+  while (btPollPendingP)
+  {
+    pollPending();
+  }
+  while (btActivePendingP)
+  {
+    pollActive();
+  }
+}
+
+//--------------------------------------------------------------------------------------------------------------------//
+//                                                                                                                    //
+//                                                                                                                    //
+//--------------------------------------------------------------------------------------------------------------------//
+int32_t DPM86xxBus::readFunction(uint8_t ubIndexV, DPM86xx::Function_te teFunctionV)
+{
+  finishPending();
+  return aclPsuP[ubIndexV].readFunction(teFunctionV);
+}
+
+//--------------------------------------------------------------------------------------------------------------------//
+//                                                                                                                    //
+//                                                                                                                    //
+//--------------------------------------------------------------------------------------------------------------------//
+int32_t DPM86xxBus::writeFunction(uint8_t ubIndexV, DPM86xx::Function_te teFunctionV, uint16_t uwValue1V,
+                                  uint16_t uwValue2V)
+{
+  finishPending();
+  return aclPsuP[ubIndexV].writeFunction(teFunctionV, uwValue1V, uwValue2V);
+}
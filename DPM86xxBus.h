@@ -0,0 +1,459 @@
+//====================================================================================================================//
+// File:          DPM86xxBus.h                                                                                        //
+// Description:   DPM86xxBus Class definition, several PSUs sharing one serial interface                              //
+// Author:        Tiderko                                                                                             //
+//--------------------------------------------------------------------------------------------------------------------//
+//                                                                                                                    //
+//====================================================================================================================//
+
+#ifndef DPM86xxBus_h
+#define DPM86xxBus_h
+
+#include "DPM86xx.h"
+
+/**
+ * @brief Maximal number of PSUs that can be attached to one bus
+ *
+ */
+#ifndef DPM86XX_BUS_DEVICES_MAX
+#define DPM86XX_BUS_DEVICES_MAX 8
+#endif
+
+/**
+ * @brief Maximal number of functions that are read by the telemetry polling of each PSU
+ *
+ */
+#define DPM86XX_BUS_TELEMETRY_MAX 4
+
+/**
+ * @brief Number of priority classes of the scheduler, see DPM86xxBus::Priority_e
+ *
+ */
+#define DPM86XX_BUS_PRIORITIES 4
+
+/**
+ * @brief Maximal number of requests that can be queued in each priority class
+ *
+ */
+#ifndef DPM86XX_BUS_QUEUE_MAX
+#define DPM86XX_BUS_QUEUE_MAX 8
+#endif
+
+/**
+ * @brief Default time in [ms] after which queued telemetry and background reads are dropped, see
+ *        DPM86xxBus::setStaleTime()
+ *
+ */
+#ifndef DPM86XX_BUS_STALE_TIME
+#define DPM86XX_BUS_STALE_TIME 250
+#endif
+
+/**
+ * @brief Time in [ms] that is added to the transmission time of request and response while probing an address
+ *        during discovery
+ *
+ */
+#ifndef DPM86XX_BUS_PROBE_MARGIN
+#define DPM86XX_BUS_PROBE_MARGIN 2
+#endif
+
+/**
+ * @brief Version of the serialized device map, see DPM86xxBus::saveMap()
+ *
+ */
+#define DPM86XX_BUS_MAP_VERSION 1
+
+/**
+ * @brief Number of byte required to serialize the device map: version, count, address and model of each PSU
+ *        and CRC16
+ *
+ */
+#define DPM86XX_BUS_MAP_SIZE (2 + (3 * DPM86XX_BUS_DEVICES_MAX) + 2)
+
+class DPM86xxHandle;
+
+/**
+ * @brief Owner of a serial interface, that is shared by several PSUs with different addresses
+ *
+ * The bus serializes the transactions of all attached PSUs and polls their telemetry values round-robin when
+ * \c #process() is called.
+ */
+class DPM86xxBus
+{
+public:
+  /**
+   * @brief Priority classes of queued requests, a lower value is served first
+   */
+  typedef enum Priority_e
+  {
+    /**
+     * @brief Requests that protect the load, e.g. switching the output off
+     */
+    ePRIO_SAFETY = 0,
+
+    /**
+     * @brief Writes of voltage and current setpoints
+     */
+    ePRIO_SETPOINT,
+
+    /**
+     * @brief Reads of measured values requested by the application
+     */
+    ePRIO_TELEMETRY,
+
+    /**
+     * @brief Reads that are not time critical, e.g. maximal voltage and current
+     */
+    ePRIO_BACKGROUND
+  } Priority_te;
+
+  /**
+   * @brief Statistics of one priority class, returned by queueStats()
+   *
+   * The wait time is measured from submission until the request is started, the latency until it is finished.
+   */
+  typedef struct QueueStats_s
+  {
+    /**
+     * @brief Number of requests that have been queued
+     */
+    uint32_t ulSubmitted;
+
+    /**
+     * @brief Number of requests that have been finished
+     */
+    uint32_t ulCompleted;
+
+    /**
+     * @brief Number of finished requests that failed
+     */
+    uint32_t ulErrors;
+
+    /**
+     * @brief Number of requests that have been merged with a queued one of the same PSU and function
+     */
+    uint32_t ulMerged;
+
+    /**
+     * @brief Number of requests that have been dropped, because they were stale or superseded
+     */
+    uint32_t ulDropped;
+
+    /**
+     * @brief Number of requests that are queued now
+     */
+    uint8_t ubDepth;
+
+    /**
+     * @brief Maximal number of requests that have been queued at the same time
+     */
+    uint8_t ubMaxDepth;
+
+    /**
+     * @brief Mean wait time in [us]
+     */
+    uint32_t ulMeanWait;
+
+    /**
+     * @brief Maximal wait time in [us]
+     */
+    uint32_t ulMaxWait;
+
+    /**
+     * @brief Maximal latency in [us]
+     */
+    uint32_t ulMaxLatency;
+  } QueueStats_ts;
+
+  DPM86xxBus();
+
+#ifdef ARDUINO
+  /**
+   * @brief Initialisation of object parameters, all PSUs are detached
+   *
+   * @param[in] clSerialIfR interface, that should be used by this object
+   */
+  void init(HardwareSerial &clSerialIfR);
+#endif
+
+  /**
+   * @brief Initialisation of object parameters, all PSUs are detached
+   *
+   * @param[in] clTransportR byte stream, that should be used by this object
+   */
+  void init(DPM86xxTransport &clTransportR);
+
+  /**
+   * @brief Attach a PSU to the bus
+   *
+   * @param[in] ubAddressV address of the PSU in range from 1 to 99
+   * @param[in] uwModelV model number, e.g. 8624, or 0 if not known
+   * @return handle of the PSU, that is not valid if the address is out of range or no further PSU can be attached
+   *
+   * The PSU starts with reset statistics, without completion callback and without maximal ages of values.
+   */
+  DPM86xxHandle attach(uint8_t ubAddressV, uint16_t uwModelV = 0);
+
+  /**
+   * @brief Returns the number of attached PSUs
+   */
+  uint8_t count();
+
+  /**
+   * @brief Returns the handle of an attached PSU
+   *
+   * @param[in] ubIndexV index in range from 0 to count() - 1
+   * @return handle of the PSU, that is not valid if the index is out of range
+   */
+  DPM86xxHandle device(uint8_t ubIndexV);
+
+  /**
+   * @brief Search for PSUs on the bus and attach all of them
+   *
+   * @param[in] ubFirstV first address that is probed
+   * @param[in] ubLastV last address that is probed
+   * @param[in] ulProbeTimeV time in [ms] to wait for the response of each address, 0 selects the transmission time
+   *            of request and response plus \c #DPM86XX_BUS_PROBE_MARGIN
+   * @return number of attached PSUs
+   *
+   * All PSUs are detached before. Each address is probed by reading the maximal voltage and current, the model is
+   * identified from them. Addresses that do not respond cost only the probe time, so a complete scan takes about
+   * 99 times the probe time. The result can be stored with saveMap(), to skip discovery at the next start.
+   * With Modbus-RTU the maximal values can only be read if their registers are defined, see \c DPM86xxModbus.h.
+   */
+  uint8_t discover(uint8_t ubFirstV = 1, uint8_t ubLastV = 99, uint32_t ulProbeTimeV = 0);
+
+  /**
+   * @brief Serialize address and model of all attached PSUs
+   *
+   * @param[out] pubBufferV buffer for the device map, e.g. to be stored in EEPROM or a file
+   * @param[in] ulSizeV size of buffer, \c #DPM86XX_BUS_MAP_SIZE is always sufficient
+   * @return number of byte written, 0 if the buffer is too small
+   */
+  size_t saveMap(uint8_t *pubBufferV, size_t ulSizeV);
+
+  /**
+   * @brief Attach the PSUs of a device map created by saveMap()
+   *
+   * @param[in] pubBufferV device map
+   * @param[in] ulSizeV number of byte in device map
+   * @return number of attached PSUs, 0 if the device map is not valid
+   *
+   * All PSUs are detached before.
+   */
+  uint8_t loadMap(const uint8_t *pubBufferV, size_t ulSizeV);
+
+  /**
+   * @brief Define the functions that are read by the telemetry polling
+   *
+   * @param[in] ateFunctionV list of functions, that are read one after the other for each PSU
+   * @param[in] ubCountV number of functions in list, up to \c #DPM86XX_BUS_TELEMETRY_MAX, 0 disables polling
+   *
+   * By default measured voltage, measured current, constant output and temperature are read.
+   */
+  void setTelemetry(const DPM86xx::Function_te ateFunctionV[], uint8_t ubCountV);
+
+  /**
+   * @brief Queue a read of a value from PSU, that is processed by process()
+   *
+   * @param[in] ubIndexV index of the PSU in range from 0 to count() - 1
+   * @param[in] teFunctionV number from \c #DPM86xx::Function_e enumeration that should be read
+   * @param[in] teClassV priority class
+   * @return \c #DPM86xx::eSTATUS_OK if the request has been queued or merged, \c #DPM86xx::eSTATUS_BUSY if the
+   *         queue is full
+   *
+   * A read of the same PSU and function that is still queued in the same class is not queued twice. If the queue
+   * of \c #ePRIO_TELEMETRY or \c #ePRIO_BACKGROUND is full, its oldest request is dropped. The read value is
+   * available from the PSU object afterwards, see DPM86xxHandle::psu().
+   */
+  int32_t submitRead(uint8_t ubIndexV, DPM86xx::Function_te teFunctionV, Priority_te teClassV = ePRIO_TELEMETRY);
+
+  /**
+   * @brief Queue a write of a value to PSU, that is processed by process()
+   *
+   * @param[in] ubIndexV index of the PSU in range from 0 to count() - 1
+   * @param[in] teFunctionV number from \c #DPM86xx::Function_e enumeration that should be written
+   * @param[in] uwValue1V first value that should be written
+   * @param[in] uwValue2V second value that should be written, only for \c #DPM86xx::eFUNC_SET_VC valid
+   * @param[in] teClassV priority class
+   * @return \c #DPM86xx::eSTATUS_OK if the request has been queued or merged, \c #DPM86xx::eSTATUS_BUSY if the
+   *         queue is full
+   *
+   * A write of the same PSU and function that is still queued in the same class is updated with the new values,
+   * except for \c #ePRIO_SAFETY. A write of \c #ePRIO_SAFETY drops all queued writes of the same PSU and function
+   * in lower classes, so e.g. a pending "output on" can not undo an "output off".
+   */
+  int32_t submitWrite(uint8_t ubIndexV, DPM86xx::Function_te teFunctionV, uint16_t uwValue1V, uint16_t uwValue2V = 0,
+                      Priority_te teClassV = ePRIO_SETPOINT);
+
+  /**
+   * @brief Set the time after which a queued request of a priority class is dropped without transaction
+   *
+   * @param[in] teClassV priority class
+   * @param[in] ulStaleTimeV time in [ms], 0 disables dropping
+   *
+   * By default \c #DPM86XX_BUS_STALE_TIME is used for \c #ePRIO_TELEMETRY and \c #ePRIO_BACKGROUND, requests of
+   * the other classes are never dropped.
+   */
+  void setStaleTime(Priority_te teClassV, uint32_t ulStaleTimeV);
+
+  /**
+   * @brief Returns the statistics of a priority class
+   *
+   * @param[in] teClassV priority class
+   * @param[out] tsStatsR statistics
+   */
+  void queueStats(Priority_te teClassV, QueueStats_ts &tsStatsR);
+
+  /**
+   * @brief Clear the statistics of all priority classes
+   */
+  void resetQueueStats();
+
+  /**
+   * @brief Process the bus, this method never blocks
+   *
+   * The pending transaction is processed. If the bus is idle, the oldest request of the highest priority class is
+   * started. Without queued requests the next telemetry value is requested: all telemetry functions of one PSU are
+   * read, then the next PSU follows.
+   *
+   * Transactions are not interrupted once their request has been sent, so a request of \c #ePRIO_SAFETY waits at
+   * most for one transaction and the safety requests queued before it. A telemetry or background read that still
+   * waits for its guard time is put back into its queue in favour of a safety request.
+   */
+  void process();
+
+  /**
+   * @brief Returns the number of telemetry values that have been read successfully
+   */
+  uint32_t sampleCount();
+
+  /**
+   * @brief Returns the number of telemetry reads that failed
+   */
+  uint32_t errorCount();
+
+private:
+  friend class DPM86xxHandle;
+
+  int32_t readFunction(uint8_t ubIndexV, DPM86xx::Function_te teFunctionV);
+  int32_t writeFunction(uint8_t ubIndexV, DPM86xx::Function_te teFunctionV, uint16_t uwValue1V, uint16_t uwValue2V);
+  void pollPending();
+  void pollActive();
+  void finishPending();
+  bool preemptPending();
+  bool startQueued();
+
+  /**
+   * @brief Request that is queued by the scheduler
+   */
+  typedef struct Request_s
+  {
+    DPM86xx::Function_te teFunction;
+    uint16_t uwValue1;
+    uint16_t uwValue2;
+    uint32_t ulSubmitTime;
+    uint8_t ubDevice;
+    bool btWrite;
+  } Request_ts;
+
+  int32_t submit(Priority_te teClassV, const Request_ts &tsRequestV);
+  void removeQueued(Priority_te teClassV, uint8_t ubPositionV);
+
+  DPM86xxTransport *pclTransportP;
+#ifdef ARDUINO
+  DPM86xxSerial clSerialP;
+#endif
+
+  void detachAll();
+  static uint16_t identifyModel(uint16_t uwMaxVoltageV, uint16_t uwMaxCurrentV);
+
+  DPM86xx aclPsuP[DPM86XX_BUS_DEVICES_MAX];
+  uint16_t auwModelP[DPM86XX_BUS_DEVICES_MAX];
+  uint8_t aubAddressP[DPM86XX_BUS_DEVICES_MAX];
+  uint8_t ubCountP;
+
+  DPM86xx::Function_te ateTelemetryP[DPM86XX_BUS_TELEMETRY_MAX];
+  uint8_t ubTelemetryCountP;
+
+  //---------------------------------------------------------------------------------------------------
+  // round-robin state of telemetry polling
+  //
+  uint8_t ubPollDeviceP;
+  uint8_t ubPollFunctionP;
+  bool btPollPendingP;
+  uint32_t ulSampleCountP;
+  uint32_t ulErrorCountP;
+
+  //---------------------------------------------------------------------------------------------------
+  // queues of the scheduler, the oldest request of each class is at position 0
+  //
+  Request_ts atsQueueP[DPM86XX_BUS_PRIORITIES][DPM86XX_BUS_QUEUE_MAX];
+  uint8_t aubQueueCountP[DPM86XX_BUS_PRIORITIES];
+  uint32_t aulStaleTimeP[DPM86XX_BUS_PRIORITIES];
+  QueueStats_ts atsQueueStatsP[DPM86XX_BUS_PRIORITIES];
+  uint64_t auqWaitSumP[DPM86XX_BUS_PRIORITIES];
+  uint32_t aulStartedP[DPM86XX_BUS_PRIORITIES];
+  Request_ts tsActiveP;
+  uint32_t ulActiveWaitP;
+  Priority_te teActiveClassP;
+  bool btActivePendingP;
+};
+
+/**
+ * @brief Lightweight handle of one PSU attached to a \c #DPM86xxBus
+ *
+ * All transactions are passed to the bus, that makes sure only one transaction is on the line at a time.
+ */
+class DPM86xxHandle
+{
+public:
+  DPM86xxHandle();
+  DPM86xxHandle(DPM86xxBus *pclBusV, uint8_t ubIndexV);
+
+  /**
+   * @brief Returns \c true if the handle refers to an attached PSU
+   */
+  bool isValid();
+
+  /**
+   * @brief Read a value from PSU, see \c #DPM86xx::readFunction()
+   */
+  int32_t readFunction(DPM86xx::Function_te teFunctionV);
+
+  /**
+   * @brief Write value to PSU, see \c #DPM86xx::writeFunction()
+   */
+  int32_t writeFunction(DPM86xx::Function_te teFunctionV, uint16_t uwValue1V, uint16_t uwValue2V = 0);
+
+  /**
+   * @brief Queue a read of a value from PSU, see \c #DPM86xxBus::submitRead()
+   */
+  int32_t submitRead(DPM86xx::Function_te teFunctionV,
+                     DPM86xxBus::Priority_te teClassV = DPM86xxBus::ePRIO_TELEMETRY);
+
+  /**
+   * @brief Queue a write of a value to PSU, see \c #DPM86xxBus::submitWrite()
+   */
+  int32_t submitWrite(DPM86xx::Function_te teFunctionV, uint16_t uwValue1V, uint16_t uwValue2V = 0,
+                      DPM86xxBus::Priority_te teClassV = DPM86xxBus::ePRIO_SETPOINT);
+
+  /**
+   * @brief Returns the model number, e.g. 8624, that has been identified by discovery or loaded from the device
+   *        map, 0 if the model is not known
+   */
+  uint16_t model();
+
+  /**
+   * @brief Returns the PSU object, e.g. to access the last read values
+   *
+   * Transactions must not be started directly on the returned object, use the methods of the handle instead.
+   */
+  DPM86xx &psu();
+
+private:
+  DPM86xxBus *pclBusP;
+  uint8_t ubIndexP;
+};
+
+#endif
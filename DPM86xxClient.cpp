@@ -0,0 +1,405 @@
+//====================================================================================================================//
+// File:          DPM86xxClient.cpp                                                                                   //
+// Description:   DPM86xxClient implementation                                                                        //
+// Author:        Tiderko                                                                                             //
+//--------------------------------------------------------------------------------------------------------------------//
+//                                                                                                                    //
+//====================================================================================================================//
+
+#include <DPM86xxClient.h>
+
+#if defined(ESP32) || !defined(ARDUINO)
+
+//--------------------------------------------------------------------------------------------------------------------//
+//                                                                                                                    //
+//                                                                                                                    //
+//--------------------------------------------------------------------------------------------------------------------//
+DPM86xxRequest::DPM86xxRequest()
+{
+  slResultP = DPM86xx::eSTATUS_OK;
+  btDoneP = true;
+#ifdef ARDUINO
+  pvDoneP = xSemaphoreCreateBinaryStatic(&tsDoneBufferP);
+#endif
+}
+
+//--------------------------------------------------------------------------------------------------------------------//
+//                                                                                                                    //
+//                                                                                                                    //
+//--------------------------------------------------------------------------------------------------------------------//
+bool DPM86xxRequest::done()
+{
+#ifdef ARDUINO
+  //---------------------------------------------------------------------------------------------------
+  // the flag is set by the task that owns the token, once it has taken the semaphore given by
+  // complete(), so the worker has finished all accesses to the token before
+  //
+  if ((btDoneP.load(std::memory_order_acquire) == false) && (xSemaphoreTake(pvDoneP, 0) == pdTRUE))
+  {
+    btDoneP.store(true, std::memory_order_release);
+  }
+#else
+  //---------------------------------------------------------------------------------------------------
+  // complete() accesses the token until it has released the lock, so the flag is read under the lock
+  // and the caller can release the token as soon as it is set
+  //
+  std::lock_guard<std::mutex> clLockT(clMutexP);
+#endif
+  return btDoneP.load(std::memory_order_acquire);
+}
+
+//--------------------------------------------------------------------------------------------------------------------//
+//                                                                                                                    //
+//                                                                                                                    //
+//--------------------------------------------------------------------------------------------------------------------//
+int32_t DPM86xxRequest::result()
+{
+  if (done() == false)
+  {
+    return DPM86xx::eSTATUS_BUSY;
+  }
+  return slResultP.load(std::memory_order_relaxed);
+}
+
+//--------------------------------------------------------------------------------------------------------------------//
+//                                                                                                                    //
+//                                                                                                                    //
+//--------------------------------------------------------------------------------------------------------------------//
+int32_t DPM86xxRequest::wait()
+{
+#ifdef ARDUINO
+  //---------------------------------------------------------------------------------------------------
+  // the worker gives the semaphore of the token, so task notifications of the calling task are not
+  // touched
+  //
+  if ((btDoneP.load(std::memory_order_acquire) == false) && (xSemaphoreTake(pvDoneP, portMAX_DELAY) == pdTRUE))
+  {
+    btDoneP.store(true, std::memory_order_release);
+  }
+#else
+  std::unique_lock<std::mutex> clLockT(clMutexP);
+  clDoneP.wait(clLockT, [this]() { return btDoneP.load(std::memory_order_acquire); });
+#endif
+
+  return slResultP.load(std::memory_order_relaxed);
+}
+
+//--------------------------------------------------------------------------------------------------------------------//
+//                                                                                                                    //
+//                                                                                                                    //
+//--------------------------------------------------------------------------------------------------------------------//
+void DPM86xxRequest::prepare()
+{
+  slResultP.store(DPM86xx::eSTATUS_BUSY, std::memory_order_relaxed);
+  btDoneP.store(false, std::memory_order_release);
+#ifdef ARDUINO
+  xSemaphoreTake(pvDoneP, 0);
+#endif
+}
+
+//--------------------------------------------------------------------------------------------------------------------//
+//                                                                                                                    //
+//                                                                                                                    //
+//--------------------------------------------------------------------------------------------------------------------//
+void DPM86xxRequest::complete(int32_t slResultV)
+{
+  slResultP.store(slResultV, std::memory_order_relaxed);
+
+#ifdef ARDUINO
+  //---------------------------------------------------------------------------------------------------
+  // giving the semaphore is the last access to the token, the done flag is set by the owner
+  //
+  xSemaphoreGive(pvDoneP);
+#else
+  //---------------------------------------------------------------------------------------------------
+  // flag and notification are given under the lock, so a waiting task can neither miss the
+  // notification nor release the token before it has been given
+  //
+  std::lock_guard<std::mutex> clLockT(clMutexP);
+  btDoneP.store(true, std::memory_order_release);
+  clDoneP.notify_all();
+#endif
+}
+
+//--------------------------------------------------------------------------------------------------------------------//
+//                                                                                                                    //
+//                                                                                                                    //
+//--------------------------------------------------------------------------------------------------------------------//
+DPM86xxClient::DPM86xxClient()
+{
+  pclPsuP = nullptr;
+  btRunP = false;
+  btActiveP = false;
+  ulRequestCountP = 0;
+  ulRejectedCountP = 0;
+#ifdef ARDUINO
+  pvTaskP = nullptr;
+#endif
+}
+
+//--------------------------------------------------------------------------------------------------------------------//
+//                                                                                                                    //
+//                                                                                                                    //
+//--------------------------------------------------------------------------------------------------------------------//
+DPM86xxClient::~DPM86xxClient()
+{
+  stop();
+}
+
+//--------------------------------------------------------------------------------------------------------------------//
+//                                                                                                                    //
+//                                                                                                                    //
+//--------------------------------------------------------------------------------------------------------------------//
+bool DPM86xxClient::start(DPM86xx &clPsuR)
+{
+  if (btActiveP)
+  {
+    return false;
+  }
+
+  pclPsuP = &clPsuR;
+  btRunP = true;
+  btActiveP = true;
+
+  //---------------------------------------------------------------------------------------------------
+  // create the bus worker
+  //
+#ifdef ARDUINO
+  if (xTaskCreate(task, "DPM86xxClient", DPM86XX_CLIENT_STACK, this, 2, &pvTaskP) != pdPASS)
+  {
+    btRunP = false;
+    btActiveP = false;
+    return false;
+  }
+#else
+  clThreadP = std::thread(task, this);
+#endif
+
+  return true;
+}
+
+//--------------------------------------------------------------------------------------------------------------------//
+//                                                                                                                    //
+//                                                                                                                    //
+//--------------------------------------------------------------------------------------------------------------------//
+void DPM86xxClient::stop()
+{
+  btRunP = false;
+  wakeUp();
+
+#ifdef ARDUINO
+  while (btActiveP)
+  {
+    delay(1);
+  }
+  pvTaskP = nullptr;
+#else
+  if (clThreadP.joinable())
+  {
+    clThreadP.join();
+  }
+#endif
+}
+
+//--------------------------------------------------------------------------------------------------------------------//
+//                                                                                                                    //
+//                                                                                                                    //
+//--------------------------------------------------------------------------------------------------------------------//
+bool DPM86xxClient::submitRead(DPM86xx::Function_te teFunctionV, DPM86xxRequest &clRequestR)
+{
+  Entry_ts tsEntryT;
+
+  tsEntryT.pclRequest = &clRequestR;
+  tsEntryT.teFunction = teFunctionV;
+  tsEntryT.uwValue1 = 0;
+  tsEntryT.uwValue2 = 0;
+  tsEntryT.btWrite = false;
+
+  return submit(tsEntryT);
+}
+
+//--------------------------------------------------------------------------------------------------------------------//
+//                                                                                                                    //
+//                                                                                                                    //
+//--------------------------------------------------------------------------------------------------------------------//
+bool DPM86xxClient::submitWrite(DPM86xx::Function_te teFunctionV, uint16_t uwValue1V, uint16_t uwValue2V,
+                                DPM86xxRequest *pclRequestV)
+{
+  Entry_ts tsEntryT;
+
+  tsEntryT.pclRequest = pclRequestV;
+  tsEntryT.teFunction = teFunctionV;
+  tsEntryT.uwValue1 = uwValue1V;
+  tsEntryT.uwValue2 = uwValue2V;
+  tsEntryT.btWrite = true;
+
+  return submit(tsEntryT);
+}
+
+//--------------------------------------------------------------------------------------------------------------------//
+//                                                                                                                    //
+//                                                                                                                    //
+//--------------------------------------------------------------------------------------------------------------------//
+bool DPM86xxClient::submit(const Entry_ts &tsEntryV)
+{
+  if ((tsEntryV.pclRequest != nullptr) && (tsEntryV.pclRequest->done() == false))
+  {
+    return false;
+  }
+
+  //---------------------------------------------------------------------------------------------------
+  // the token is marked as pending before the worker can see the request
+  //
+  if (tsEntryV.pclRequest != nullptr)
+  {
+    tsEntryV.pclRequest->prepare();
+  }
+  if (clQueueP.push(tsEntryV) != true)
+  {
+    if (tsEntryV.pclRequest != nullptr)
+    {
+      tsEntryV.pclRequest->complete(DPM86xx::eSTATUS_BUSY);
+    }
+    ulRejectedCountP++;
+    return false;
+  }
+
+  wakeUp();
+  return true;
+}
+
+//--------------------------------------------------------------------------------------------------------------------//
+//                                                                                                                    //
+//                                                                                                                    //
+//--------------------------------------------------------------------------------------------------------------------//
+int32_t DPM86xxClient::readFunction(DPM86xx::Function_te teFunctionV)
+{
+  DPM86xxRequest clRequestT;
+
+  if (submitRead(teFunctionV, clRequestT) != true)
+  {
+    return DPM86xx::eSTATUS_BUSY;
+  }
+  return clRequestT.wait();
+}
+
+//--------------------------------------------------------------------------------------------------------------------//
+//                                                                                                                    //
+//                                                                                                                    //
+//--------------------------------------------------------------------------------------------------------------------//
+int32_t DPM86xxClient::writeFunction(DPM86xx::Function_te teFunctionV, uint16_t uwValue1V, uint16_t uwValue2V)
+{
+  DPM86xxRequest clRequestT;
+
+  if (submitWrite(teFunctionV, uwValue1V, uwValue2V, &clRequestT) != true)
+  {
+    return DPM86xx::eSTATUS_BUSY;
+  }
+  return clRequestT.wait();
+}
+
+//--------------------------------------------------------------------------------------------------------------------//
+//                                                                                                                    //
+//                                                                                                                    //
+//--------------------------------------------------------------------------------------------------------------------//
+uint32_t DPM86xxClient::requestCount()
+{
+  return ulRequestCountP;
+}
+
+//--------------------------------------------------------------------------------------------------------------------//
+//                                                                                                                    //
+//                                                                                                                    //
+//--------------------------------------------------------------------------------------------------------------------//
+uint32_t DPM86xxClient::rejectedCount()
+{
+  return ulRejectedCountP;
+}
+
+//--------------------------------------------------------------------------------------------------------------------//
+//                                                                                                                    //
+//                                                                                                                    //
+//--------------------------------------------------------------------------------------------------------------------//
+void DPM86xxClient::wakeUp()
+{
+#ifdef ARDUINO
+  if (pvTaskP != nullptr)
+  {
+    xTaskNotifyGive(pvTaskP);
+  }
+#else
+  //---------------------------------------------------------------------------------------------------
+  // the lock is only taken to make sure the worker either sees the new request or is already waiting
+  //
+  {
+    std::lock_guard<std::mutex> clLockT(clWakeMutexP);
+  }
+  clWakeP.notify_one();
+#endif
+}
+
+//--------------------------------------------------------------------------------------------------------------------//
+//                                                                                                                    //
+//                                                                                                                    //
+//--------------------------------------------------------------------------------------------------------------------//
+void DPM86xxClient::task(void *pvParameterV)
+{
+  static_cast<DPM86xxClient *>(pvParameterV)->run();
+
+#ifdef ARDUINO
+  vTaskDelete(nullptr);
+#endif
+}
+
+//--------------------------------------------------------------------------------------------------------------------//
+//                                                                                                                    //
+//                                                                                                                    //
+//--------------------------------------------------------------------------------------------------------------------//
+void DPM86xxClient::run()
+{
+  Entry_ts tsEntryT;
+  int32_t slResultT;
+
+  for (;;)
+  {
+    //-------------------------------------------------------------------------------------------
+    // process all queued requests, the worker is the only task that accesses the PSU
+    //
+    while (clQueueP.pop(tsEntryT))
+    {
+      if (tsEntryT.btWrite)
+      {
+        slResultT = pclPsuP->writeFunction(tsEntryT.teFunction, tsEntryT.uwValue1, tsEntryT.uwValue2);
+      }
+      else
+      {
+        slResultT = pclPsuP->readFunction(tsEntryT.teFunction);
+      }
+      ulRequestCountP++;
+
+      if (tsEntryT.pclRequest != nullptr)
+      {
+        tsEntryT.pclRequest->complete(slResultT);
+      }
+    }
+
+    if (btRunP == false)
+    {
+      break;
+    }
+
+    //-------------------------------------------------------------------------------------------
+    // sleep until a request is queued
+    //
+#ifdef ARDUINO
+    ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+#else
+    std::unique_lock<std::mutex> clLockT(clWakeMutexP);
+    clWakeP.wait(clLockT, [this]() { return (clQueueP.size() > 0) || (btRunP == false); });
+#endif
+  }
+
+  btActiveP = false;
+}
+
+#endif
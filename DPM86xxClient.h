@@ -0,0 +1,207 @@
+//====================================================================================================================//
+// File:          DPM86xxClient.h                                                                                     //
+// Description:   DPM86xxClient Class definition, thread-safe access to one PSU from several tasks                    //
+// Author:        Tiderko                                                                                             //
+//--------------------------------------------------------------------------------------------------------------------//
+//                                                                                                                    //
+//====================================================================================================================//
+
+#ifndef DPM86xxClient_h
+#define DPM86xxClient_h
+
+#include "DPM86xx.h"
+
+#if defined(ESP32) || !defined(ARDUINO)
+
+#include "DPM86xxQueue.h"
+
+#ifdef ARDUINO
+#include <freertos/FreeRTOS.h>
+#include <freertos/semphr.h>
+#include <freertos/task.h>
+#else
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#endif
+
+/**
+ * @brief Number of requests that can be queued until they are processed by the bus worker, power of two
+ *
+ */
+#ifndef DPM86XX_CLIENT_DEPTH
+#define DPM86XX_CLIENT_DEPTH 16
+#endif
+
+/**
+ * @brief Stack size in [byte] of the bus worker task on ESP32
+ *
+ */
+#ifndef DPM86XX_CLIENT_STACK
+#define DPM86XX_CLIENT_STACK 4096
+#endif
+
+class DPM86xxClient;
+
+/**
+ * @brief Completion token of a request passed to \c #DPM86xxClient
+ *
+ * The token is owned by the caller and must exist until the request has been finished. It can be reused for the
+ * next request afterwards.
+ */
+class DPM86xxRequest
+{
+public:
+  DPM86xxRequest();
+
+  /**
+   * @brief Returns \c true if the request has been finished
+   */
+  bool done();
+
+  /**
+   * @brief Returns the result of the request
+   * @return same value as returned by \c #DPM86xx::readFunction() or \c #DPM86xx::writeFunction(),
+   *         \c #DPM86xx::eSTATUS_BUSY as long as the request is not finished
+   */
+  int32_t result();
+
+  /**
+   * @brief Block the calling task until the request has been finished
+   * @return result of the request
+   *
+   * On ESP32 the task sleeps on a semaphore of the token, so its task notifications remain free for the
+   * application.
+   */
+  int32_t wait();
+
+private:
+  friend class DPM86xxClient;
+
+  void prepare();
+  void complete(int32_t slResultV);
+
+  std::atomic<int32_t> slResultP;
+  std::atomic<bool> btDoneP;
+#ifdef ARDUINO
+  SemaphoreHandle_t pvDoneP;
+  StaticSemaphore_t tsDoneBufferP;
+#else
+  std::mutex clMutexP;
+  std::condition_variable clDoneP;
+#endif
+};
+
+/**
+ * @brief Thread-safe access to one PSU
+ *
+ * Requests of any number of tasks are passed by a lock-free queue to a single bus worker, that owns the PSU object
+ * and processes them one after the other. The caller receives the result by a \c #DPM86xxRequest, so it can
+ * continue with other work and wait for the result later. On ESP32 the worker is a FreeRTOS task, that sleeps on a
+ * task notification while the queue is empty, on a host a \c std::thread.
+ *
+ * While the client is running, no other transaction must be started on the PSU object and the values of the PSU
+ * object must not be read by other tasks, use the results of the requests instead.
+ */
+class DPM86xxClient
+{
+public:
+  DPM86xxClient();
+  ~DPM86xxClient();
+
+  /**
+   * @brief Start the bus worker
+   *
+   * @param[in] clPsuR initialised PSU that should be shared
+   * @return \c true on success, \c false if the client is already running or the task could not be created
+   */
+  bool start(DPM86xx &clPsuR);
+
+  /**
+   * @brief Stop the bus worker after the pending requests have been processed
+   */
+  void stop();
+
+  /**
+   * @brief Queue a read of a value from PSU, this method never blocks
+   *
+   * @param[in] teFunctionV number from \c #DPM86xx::Function_e enumeration that should be read
+   * @param[in] clRequestR completion token, that receives the result
+   * @return \c true if the request has been queued, \c false if the queue is full or the token is still in use
+   */
+  bool submitRead(DPM86xx::Function_te teFunctionV, DPM86xxRequest &clRequestR);
+
+  /**
+   * @brief Queue a write of a value to PSU, this method never blocks
+   *
+   * @param[in] teFunctionV number from \c #DPM86xx::Function_e enumeration that should be written
+   * @param[in] uwValue1V first value that should be written
+   * @param[in] uwValue2V second value that should be written, only for \c #DPM86xx::eFUNC_SET_VC valid
+   * @param[in] pclRequestV completion token, that receives the result, \c nullptr if the result is not needed
+   * @return \c true if the request has been queued, \c false if the queue is full or the token is still in use
+   */
+  bool submitWrite(DPM86xx::Function_te teFunctionV, uint16_t uwValue1V, uint16_t uwValue2V = 0,
+                   DPM86xxRequest *pclRequestV = nullptr);
+
+  /**
+   * @brief Read a value from PSU and wait for the result, see \c #DPM86xx::readFunction()
+   *
+   * @return \c #DPM86xx::eSTATUS_BUSY if the queue is full, else the result of the read
+   */
+  int32_t readFunction(DPM86xx::Function_te teFunctionV);
+
+  /**
+   * @brief Write value to PSU and wait for the result, see \c #DPM86xx::writeFunction()
+   *
+   * @return \c #DPM86xx::eSTATUS_BUSY if the queue is full, else the result of the write
+   */
+  int32_t writeFunction(DPM86xx::Function_te teFunctionV, uint16_t uwValue1V, uint16_t uwValue2V = 0);
+
+  /**
+   * @brief Returns the number of requests that have been processed
+   */
+  uint32_t requestCount();
+
+  /**
+   * @brief Returns the number of requests that have been rejected, because the queue was full
+   */
+  uint32_t rejectedCount();
+
+private:
+  /**
+   * @brief Request that is passed to the bus worker
+   */
+  typedef struct Entry_s
+  {
+    DPM86xxRequest *pclRequest;
+    DPM86xx::Function_te teFunction;
+    uint16_t uwValue1;
+    uint16_t uwValue2;
+    bool btWrite;
+  } Entry_ts;
+
+  bool submit(const Entry_ts &tsEntryV);
+  void wakeUp();
+  static void task(void *pvParameterV);
+  void run();
+
+  DPM86xx *pclPsuP;
+
+  DPM86xxQueue<Entry_ts, DPM86XX_CLIENT_DEPTH> clQueueP;
+  std::atomic<bool> btRunP;
+  std::atomic<bool> btActiveP;
+  std::atomic<uint32_t> ulRequestCountP;
+  std::atomic<uint32_t> ulRejectedCountP;
+
+#ifdef ARDUINO
+  TaskHandle_t pvTaskP;
+#else
+  std::thread clThreadP;
+  std::mutex clWakeMutexP;
+  std::condition_variable clWakeP;
+#endif
+};
+
+#endif
+
+#endif
@@ -0,0 +1,252 @@
+//====================================================================================================================//
+// File:          DPM86xxEnergy.cpp                                                                                   //
+// Description:   DPM86xxEnergy implementation                                                                        //
+// Author:        Tiderko                                                                                             //
+//--------------------------------------------------------------------------------------------------------------------//
+//                                                                                                                    //
+//====================================================================================================================//
+
+#include <DPM86xxEnergy.h>
+
+/*--------------------------------------------------------------------------------------------------------------------*\
+** Fixed point units of the accumulators, the trapezoidal rule is applied without the division by 2:                  **
+**                                                                                                                    **
+**   1 uWh = 3600 uW * 1000000 us = 0.1 * 3600 * 1000000 [10 uW * us] -> 7.2e8 in twice [10 uW * us]                  **
+**   1 uAh = 3600 uA * 1000000 us = 0.001 * 3600 * 1000000 [mA * us]  -> 7.2e6 in twice [mA * us]                     **
+**                                                                                                                    **
+\*--------------------------------------------------------------------------------------------------------------------*/
+#define ENERGY_UNITS_PER_UWH 720000000ULL
+#define CHARGE_UNITS_PER_UAH 7200000ULL
+
+//--------------------------------------------------------------------------------------------------------------------//
+//                                                                                                                    //
+//                                                                                                                    //
+//--------------------------------------------------------------------------------------------------------------------//
+DPM86xxEnergy::DPM86xxEnergy()
+{
+  ulMaxGapP = DPM86XX_ENERGY_MAX_GAP;
+  reset();
+}
+
+//--------------------------------------------------------------------------------------------------------------------//
+//                                                                                                                    //
+//                                                                                                                    //
+//--------------------------------------------------------------------------------------------------------------------//
+void DPM86xxEnergy::reset()
+{
+  btValidP = false;
+  uqEnergyRestP = 0;
+  uqMicrowattHoursP = 0;
+  uqChargeRestP = 0;
+  uqMicroampereHoursP = 0;
+  uqIntegratedTimeP = 0;
+  ulPeakPowerP = 0;
+  ulSampleCountP = 0;
+  ulGapCountP = 0;
+}
+
+//--------------------------------------------------------------------------------------------------------------------//
+//                                                                                                                    //
+//                                                                                                                    //
+//--------------------------------------------------------------------------------------------------------------------//
+void DPM86xxEnergy::setMaxGap(uint32_t ulMaxGapV)
+{
+  ulMaxGapP = ulMaxGapV;
+}
+
+//--------------------------------------------------------------------------------------------------------------------//
+//                                                                                                                    //
+//                                                                                                                    //
+//--------------------------------------------------------------------------------------------------------------------//
+bool DPM86xxEnergy::add(const DPM86xx::Snapshot_ts &tsSnapshotV)
+{
+  if ((tsSnapshotV.ubFields & (DPM86xx::eSNAP_VOLTAGE | DPM86xx::eSNAP_CURRENT)) !=
+      (DPM86xx::eSNAP_VOLTAGE | DPM86xx::eSNAP_CURRENT))
+  {
+    return false;
+  }
+
+  add(tsSnapshotV.uwVoltage, tsSnapshotV.ulVoltageTime, tsSnapshotV.uwCurrent, tsSnapshotV.ulCurrentTime);
+  return true;
+}
+
+//--------------------------------------------------------------------------------------------------------------------//
+//                                                                                                                    //
+//                                                                                                                    //
+//--------------------------------------------------------------------------------------------------------------------//
+uint32_t DPM86xxEnergy::interpolate(uint16_t uwPreviousV, uint32_t ulPreviousTimeV, uint16_t uwValueV,
+                                    uint32_t ulTimeV, uint32_t ulAtV)
+{
+  uint32_t ulSpanT = ulTimeV - ulPreviousTimeV;
+  uint32_t ulOffsetT = ulAtV - ulPreviousTimeV;
+
+  //---------------------------------------------------------------------------------------------------
+  // only interpolate between both samples, never extrapolate
+  //
+  if ((ulSpanT == 0) || (ulOffsetT > ulSpanT))
+  {
+    return uwValueV;
+  }
+
+  int64_t sqDeltaT = (int64_t)uwValueV - (int64_t)uwPreviousV;
+  return (uint32_t)((int64_t)uwPreviousV + ((sqDeltaT * (int64_t)ulOffsetT) / (int64_t)ulSpanT));
+}
+
+//--------------------------------------------------------------------------------------------------------------------//
+//                                                                                                                    //
+//                                                                                                                    //
+//--------------------------------------------------------------------------------------------------------------------//
+void DPM86xxEnergy::add(uint16_t uwVoltageV, uint32_t ulVoltageTimeV, uint16_t uwCurrentV, uint32_t ulCurrentTimeV)
+{
+  uint32_t ulTimeT;
+  uint32_t ulVoltageT = uwVoltageV;
+  uint32_t ulCurrentT = uwCurrentV;
+  uint32_t ulPowerT;
+
+  ulSampleCountP++;
+
+  //---------------------------------------------------------------------------------------------------
+  // align both values to the earlier reception time, the later value is interpolated from its
+  // previous sample
+  //
+  if ((int32_t)(ulCurrentTimeV - ulVoltageTimeV) >= 0)
+  {
+    ulTimeT = ulVoltageTimeV;
+    if (btValidP)
+    {
+      ulCurrentT = interpolate(uwCurrentP, ulCurrentTimeP, uwCurrentV, ulCurrentTimeV, ulTimeT);
+    }
+  }
+  else
+  {
+    ulTimeT = ulCurrentTimeV;
+    if (btValidP)
+    {
+      ulVoltageT = interpolate(uwVoltageP, ulVoltageTimeP, uwVoltageV, ulVoltageTimeV, ulTimeT);
+    }
+  }
+  ulPowerT = ulVoltageT * ulCurrentT;
+
+  if (ulPowerT > ulPeakPowerP)
+  {
+    ulPeakPowerP = ulPowerT;
+  }
+
+  if (btValidP)
+  {
+    uint32_t ulPowerSpanT = ulTimeT - ulPowerTimeP;
+    uint32_t ulCurrentSpanT = ulCurrentTimeV - ulCurrentTimeP;
+
+    if ((ulPowerSpanT > (ulMaxGapP * 1000)) || (ulCurrentSpanT > (ulMaxGapP * 1000)))
+    {
+      ulGapCountP++;
+    }
+    else
+    {
+      //-------------------------------------------------------------------------------------------
+      // trapezoidal rule, energy from the aligned power and charge from the current at its own
+      // reception times
+      //
+      uqEnergyRestP += (uint64_t)(ulPowerP + ulPowerT) * ulPowerSpanT;
+      uqChargeRestP += (uint64_t)((uint32_t)uwCurrentP + uwCurrentV) * ulCurrentSpanT;
+      uqIntegratedTimeP += ulPowerSpanT;
+
+      //-------------------------------------------------------------------------------------------
+      // move whole units to the counters, so the remainders never overflow
+      //
+      if (uqEnergyRestP >= ENERGY_UNITS_PER_UWH)
+      {
+        uqMicrowattHoursP += uqEnergyRestP / ENERGY_UNITS_PER_UWH;
+        uqEnergyRestP %= ENERGY_UNITS_PER_UWH;
+      }
+      if (uqChargeRestP >= CHARGE_UNITS_PER_UAH)
+      {
+        uqMicroampereHoursP += uqChargeRestP / CHARGE_UNITS_PER_UAH;
+        uqChargeRestP %= CHARGE_UNITS_PER_UAH;
+      }
+    }
+  }
+
+  uwVoltageP = uwVoltageV;
+  ulVoltageTimeP = ulVoltageTimeV;
+  uwCurrentP = uwCurrentV;
+  ulCurrentTimeP = ulCurrentTimeV;
+  ulPowerP = ulPowerT;
+  ulPowerTimeP = ulTimeT;
+  btValidP = true;
+}
+
+//--------------------------------------------------------------------------------------------------------------------//
+//                                                                                                                    //
+//                                                                                                                    //
+//--------------------------------------------------------------------------------------------------------------------//
+uint64_t DPM86xxEnergy::microwattHours()
+{
+  return uqMicrowattHoursP;
+}
+
+//--------------------------------------------------------------------------------------------------------------------//
+//                                                                                                                    //
+//                                                                                                                    //
+//--------------------------------------------------------------------------------------------------------------------//
+uint64_t DPM86xxEnergy::microampereHours()
+{
+  return uqMicroampereHoursP;
+}
+
+//--------------------------------------------------------------------------------------------------------------------//
+//                                                                                                                    //
+//                                                                                                                    //
+//--------------------------------------------------------------------------------------------------------------------//
+double DPM86xxEnergy::wattHours()
+{
+  return ((double)uqMicrowattHoursP + ((double)uqEnergyRestP / (double)ENERGY_UNITS_PER_UWH)) / 1000000.0;
+}
+
+//--------------------------------------------------------------------------------------------------------------------//
+//                                                                                                                    //
+//                                                                                                                    //
+//--------------------------------------------------------------------------------------------------------------------//
+double DPM86xxEnergy::ampereHours()
+{
+  return ((double)uqMicroampereHoursP + ((double)uqChargeRestP / (double)CHARGE_UNITS_PER_UAH)) / 1000000.0;
+}
+
+//--------------------------------------------------------------------------------------------------------------------//
+//                                                                                                                    //
+//                                                                                                                    //
+//--------------------------------------------------------------------------------------------------------------------//
+uint32_t DPM86xxEnergy::peakMilliwatt()
+{
+  //---------------------------------------------------------------------------------------------------
+  // the power is given in [10 uW]
+  //
+  return ulPeakPowerP / 100;
+}
+
+//--------------------------------------------------------------------------------------------------------------------//
+//                                                                                                                    //
+//                                                                                                                    //
+//--------------------------------------------------------------------------------------------------------------------//
+uint32_t DPM86xxEnergy::integratedTime()
+{
+  return (uint32_t)(uqIntegratedTimeP / 1000);
+}
+
+//--------------------------------------------------------------------------------------------------------------------//
+//                                                                                                                    //
+//                                                                                                                    //
+//--------------------------------------------------------------------------------------------------------------------//
+uint32_t DPM86xxEnergy::sampleCount()
+{
+  return ulSampleCountP;
+}
+
+//--------------------------------------------------------------------------------------------------------------------//
+//                                                                                                                    //
+//                                                                                                                    //
+//--------------------------------------------------------------------------------------------------------------------//
+uint32_t DPM86xxEnergy::gapCount()
+{
+  return ulGapCountP;
+}
@@ -0,0 +1,141 @@
+//====================================================================================================================//
+// File:          DPM86xxEnergy.h                                                                                     //
+// Description:   DPM86xxEnergy Class definition, energy and charge integrated from measured values                   //
+// Author:        Tiderko                                                                                             //
+//--------------------------------------------------------------------------------------------------------------------//
+//                                                                                                                    //
+//====================================================================================================================//
+
+#ifndef DPM86xxEnergy_h
+#define DPM86xxEnergy_h
+
+#include "DPM86xx.h"
+
+/**
+ * @brief Default maximal time in [ms] between two samples, that is integrated, see DPM86xxEnergy::setMaxGap()
+ *
+ */
+#ifndef DPM86XX_ENERGY_MAX_GAP
+#define DPM86XX_ENERGY_MAX_GAP 1000
+#endif
+
+/**
+ * @brief Integrates energy and charge from timestamped samples of measured voltage and current
+ *
+ * The samples are integrated with the trapezoidal rule. Power is calculated in units of the registers, 10 mV times
+ * 1 mA, and accumulated in 64 bit fixed point, so no precision is lost and no floating point is required. Whole
+ * micro watt hours and micro ampere hours are moved to separate counters, the remainder is kept.
+ *
+ * Voltage and current are read by separate transactions with the ASCII protocol. To compensate the skew, the value
+ * that has been received later is interpolated linearly to the reception time of the other one, using its
+ * previous sample.
+ */
+class DPM86xxEnergy
+{
+public:
+  DPM86xxEnergy();
+
+  /**
+   * @brief Clear all accumulated values
+   */
+  void reset();
+
+  /**
+   * @brief Add a sample
+   *
+   * @param[in] tsSnapshotV snapshot that provides measured voltage and current, e.g. from DPM86xx::readSnapshot()
+   *            or DPM86xxSampler::pop()
+   * @return \c true if the sample has been used, \c false if voltage or current is missing
+   */
+  bool add(const DPM86xx::Snapshot_ts &tsSnapshotV);
+
+  /**
+   * @brief Add a sample
+   *
+   * @param[in] uwVoltageV measured voltage in [10 mV]
+   * @param[in] ulVoltageTimeV time in [us] given by micros() when the voltage has been received
+   * @param[in] uwCurrentV measured current in [mA]
+   * @param[in] ulCurrentTimeV time in [us] given by micros() when the current has been received
+   */
+  void add(uint16_t uwVoltageV, uint32_t ulVoltageTimeV, uint16_t uwCurrentV, uint32_t ulCurrentTimeV);
+
+  /**
+   * @brief Set the maximal time between two samples, that is integrated
+   *
+   * @param[in] ulMaxGapV time in [ms]
+   *
+   * A longer gap, e.g. caused by failed transactions, is not integrated, the integration restarts with the next
+   * sample. The number of gaps is returned by gapCount().
+   */
+  void setMaxGap(uint32_t ulMaxGapV);
+
+  /**
+   * @brief Returns the energy delivered since reset() in [uWh]
+   */
+  uint64_t microwattHours();
+
+  /**
+   * @brief Returns the charge delivered since reset() in [uAh]
+   */
+  uint64_t microampereHours();
+
+  /**
+   * @brief Returns the energy delivered since reset() in [Wh]
+   */
+  double wattHours();
+
+  /**
+   * @brief Returns the charge delivered since reset() in [Ah]
+   */
+  double ampereHours();
+
+  /**
+   * @brief Returns the highest power of all samples in [mW]
+   */
+  uint32_t peakMilliwatt();
+
+  /**
+   * @brief Returns the time in [ms] that has been integrated
+   */
+  uint32_t integratedTime();
+
+  /**
+   * @brief Returns the number of samples that have been added
+   */
+  uint32_t sampleCount();
+
+  /**
+   * @brief Returns the number of gaps that have not been integrated
+   */
+  uint32_t gapCount();
+
+private:
+  static uint32_t interpolate(uint16_t uwPreviousV, uint32_t ulPreviousTimeV, uint16_t uwValueV, uint32_t ulTimeV,
+                              uint32_t ulAtV);
+
+  //---------------------------------------------------------------------------------------------------
+  // previous sample, the power is given in [10 uW] at the aligned time
+  //
+  uint16_t uwVoltageP;
+  uint32_t ulVoltageTimeP;
+  uint16_t uwCurrentP;
+  uint32_t ulCurrentTimeP;
+  uint32_t ulPowerP;
+  uint32_t ulPowerTimeP;
+  bool btValidP;
+
+  //---------------------------------------------------------------------------------------------------
+  // accumulated values, the remainders are given in twice the product of register unit and [us]
+  //
+  uint64_t uqEnergyRestP;
+  uint64_t uqMicrowattHoursP;
+  uint64_t uqChargeRestP;
+  uint64_t uqMicroampereHoursP;
+  uint64_t uqIntegratedTimeP;
+  uint32_t ulPeakPowerP;
+  uint32_t ulMaxGapP;
+  uint32_t ulSampleCountP;
+  uint32_t ulGapCountP;
+};
+
+#endif
@@ -0,0 +1,415 @@
+//====================================================================================================================//
+// File:          DPM86xxFleet.cpp                                                                                    //
+// Description:   DPM86xxFleet implementation                                                                         //
+// Author:        Tiderko                                                                                             //
+//--------------------------------------------------------------------------------------------------------------------//
+//                                                                                                                    //
+//====================================================================================================================//
+
+#include <DPM86xxFleet.h>
+
+#if defined(ESP32) || !defined(ARDUINO)
+
+//--------------------------------------------------------------------------------------------------------------------//
+//                                                                                                                    //
+//                                                                                                                    //
+//--------------------------------------------------------------------------------------------------------------------//
+DPM86xxFleet::DPM86xxFleet()
+{
+  ubBusCountP = 0;
+  uwDeviceCountP = 0;
+  ulPeriodP = 0;
+  ubFieldsP = 0;
+  btRunP = false;
+  btStartedP = false;
+  pclTelemetryP = nullptr;
+  uwFirstDeviceP = 0;
+
+  for (uint8_t ubBusT = 0; ubBusT < DPM86XX_FLEET_BUSES_MAX; ubBusT++)
+  {
+    atsBusP[ubBusT].pclFleet = this;
+    atsBusP[ubBusT].pclTransport = nullptr;
+    atsBusP[ubBusT].btActive = false;
+    atsBusP[ubBusT].ulSweepCount = 0;
+    atsBusP[ubBusT].ulSampleCount = 0;
+    atsBusP[ubBusT].ulErrorCount = 0;
+    atsBusP[ubBusT].ubIndex = ubBusT;
+#ifdef ARDUINO
+    atsBusP[ubBusT].pvTask = nullptr;
+#endif
+  }
+
+#ifdef ARDUINO
+  pvLockP = xSemaphoreCreateMutex();
+#endif
+}
+
+//--------------------------------------------------------------------------------------------------------------------//
+//                                                                                                                    //
+//                                                                                                                    //
+//--------------------------------------------------------------------------------------------------------------------//
+DPM86xxFleet::~DPM86xxFleet()
+{
+  stop();
+}
+
+#ifdef ARDUINO
+//--------------------------------------------------------------------------------------------------------------------//
+//                                                                                                                    //
+//                                                                                                                    //
+//--------------------------------------------------------------------------------------------------------------------//
+int32_t DPM86xxFleet::addBus(HardwareSerial &clSerialIfR)
+{
+  if ((ubBusCountP >= DPM86XX_FLEET_BUSES_MAX) || btStartedP)
+  {
+    return -1;
+  }
+
+  atsBusP[ubBusCountP].clSerial.init(clSerialIfR);
+  return addBus(atsBusP[ubBusCountP].clSerial);
+}
+#endif
+
+//--------------------------------------------------------------------------------------------------------------------//
+//                                                                                                                    //
+//                                                                                                                    //
+//--------------------------------------------------------------------------------------------------------------------//
+int32_t DPM86xxFleet::addBus(DPM86xxTransport &clTransportR)
+{
+  if ((ubBusCountP >= DPM86XX_FLEET_BUSES_MAX) || btStartedP)
+  {
+    return -1;
+  }
+
+  atsBusP[ubBusCountP].pclTransport = &clTransportR;
+  return ubBusCountP++;
+}
+
+//--------------------------------------------------------------------------------------------------------------------//
+//                                                                                                                    //
+//                                                                                                                    //
+//--------------------------------------------------------------------------------------------------------------------//
+int32_t DPM86xxFleet::addDevice(uint8_t ubBusV, uint8_t ubAddressV)
+{
+  if ((ubBusV >= ubBusCountP) || (uwDeviceCountP >= DPM86XX_FLEET_DEVICES_MAX) || btStartedP)
+  {
+    return -1;
+  }
+
+  //---------------------------------------------------------------------------------------------------
+  // the worker sleeps while it waits for a response, so the other workers get the CPU
+  //
+  aclPsuP[uwDeviceCountP].init(*atsBusP[ubBusV].pclTransport, ubAddressV);
+  aclPsuP[uwDeviceCountP].setReceiveMode(DPM86xx::eRECEIVE_EVENT);
+  aubBusP[uwDeviceCountP] = ubBusV;
+
+  Reading_ts &tsReadingT = atsPublishedP[uwDeviceCountP];
+  tsReadingT.tsSnapshot.ubFields = 0;
+  tsReadingT.ulSweep = 0;
+  tsReadingT.ubBus = ubBusV;
+  tsReadingT.ubAddress = ubAddressV;
+  atsWorkP[uwDeviceCountP] = tsReadingT;
+
+  return uwDeviceCountP++;
+}
+
+//--------------------------------------------------------------------------------------------------------------------//
+//                                                                                                                    //
+//                                                                                                                    //
+//--------------------------------------------------------------------------------------------------------------------//
+DPM86xx &DPM86xxFleet::psu(uint16_t uwIndexV)
+{
+  if (uwIndexV >= DPM86XX_FLEET_DEVICES_MAX)
+  {
+    uwIndexV = 0;
+  }
+  return aclPsuP[uwIndexV];
+}
+
+//--------------------------------------------------------------------------------------------------------------------//
+//                                                                                                                    //
+//                                                                                                                    //
+//--------------------------------------------------------------------------------------------------------------------//
+void DPM86xxFleet::setTelemetry(DPM86xxTelemetry &clTelemetryR, uint16_t uwFirstDeviceV)
+{
+  if (btStartedP == false)
+  {
+    pclTelemetryP = &clTelemetryR;
+    uwFirstDeviceP = uwFirstDeviceV;
+  }
+}
+
+//--------------------------------------------------------------------------------------------------------------------//
+//                                                                                                                    //
+//                                                                                                                    //
+//--------------------------------------------------------------------------------------------------------------------//
+bool DPM86xxFleet::start(uint32_t ulPeriodV, uint8_t ubFieldsV)
+{
+  if (btStartedP)
+  {
+    return false;
+  }
+
+  ulPeriodP = ulPeriodV;
+  ubFieldsP = ubFieldsV;
+  btRunP = true;
+  btStartedP = true;
+
+  //---------------------------------------------------------------------------------------------------
+  // create one worker for each serial interface
+  //
+  for (uint8_t ubBusT = 0; ubBusT < ubBusCountP; ubBusT++)
+  {
+    Bus_ts &tsBusT = atsBusP[ubBusT];
+
+    tsBusT.btActive = true;
+#ifdef ARDUINO
+    if (xTaskCreate(task, "DPM86xxFleet", DPM86XX_FLEET_STACK, &tsBusT, 1, &tsBusT.pvTask) != pdPASS)
+    {
+      tsBusT.btActive = false;
+      stop();
+      return false;
+    }
+#else
+    tsBusT.clThread = std::thread(task, &tsBusT);
+#endif
+  }
+
+  return true;
+}
+
+//--------------------------------------------------------------------------------------------------------------------//
+//                                                                                                                    //
+//                                                                                                                    //
+//--------------------------------------------------------------------------------------------------------------------//
+void DPM86xxFleet::stop()
+{
+  btRunP = false;
+
+  for (uint8_t ubBusT = 0; ubBusT < ubBusCountP; ubBusT++)
+  {
+#ifdef ARDUINO
+    while (atsBusP[ubBusT].btActive)
+    {
+      delay(1);
+    }
+    atsBusP[ubBusT].pvTask = nullptr;
+#else
+    if (atsBusP[ubBusT].clThread.joinable())
+    {
+      atsBusP[ubBusT].clThread.join();
+    }
+#endif
+  }
+
+  btStartedP = false;
+}
+
+//--------------------------------------------------------------------------------------------------------------------//
+//                                                                                                                    //
+//                                                                                                                    //
+//--------------------------------------------------------------------------------------------------------------------//
+uint16_t DPM86xxFleet::snapshot(Reading_ts atsReadingR[], uint16_t uwSizeV)
+{
+  if (uwSizeV > uwDeviceCountP)
+  {
+    uwSizeV = uwDeviceCountP;
+  }
+
+  lock();
+  for (uint16_t uwIndexT = 0; uwIndexT < uwSizeV; uwIndexT++)
+  {
+    atsReadingR[uwIndexT] = atsPublishedP[uwIndexT];
+  }
+  unlock();
+
+  return uwSizeV;
+}
+
+//--------------------------------------------------------------------------------------------------------------------//
+//                                                                                                                    //
+//                                                                                                                    //
+//--------------------------------------------------------------------------------------------------------------------//
+uint8_t DPM86xxFleet::busCount()
+{
+  return ubBusCountP;
+}
+
+//--------------------------------------------------------------------------------------------------------------------//
+//                                                                                                                    //
+//                                                                                                                    //
+//--------------------------------------------------------------------------------------------------------------------//
+uint16_t DPM86xxFleet::deviceCount()
+{
+  return uwDeviceCountP;
+}
+
+//--------------------------------------------------------------------------------------------------------------------//
+//                                                                                                                    //
+//                                                                                                                    //
+//--------------------------------------------------------------------------------------------------------------------//
+uint32_t DPM86xxFleet::sweepCount(uint8_t ubBusV)
+{
+  if (ubBusV >= ubBusCountP)
+  {
+    return 0;
+  }
+  return atsBusP[ubBusV].ulSweepCount;
+}
+
+//--------------------------------------------------------------------------------------------------------------------//
+//                                                                                                                    //
+//                                                                                                                    //
+//--------------------------------------------------------------------------------------------------------------------//
+uint32_t DPM86xxFleet::sampleCount()
+{
+  uint32_t ulCountT = 0;
+
+  for (uint8_t ubBusT = 0; ubBusT < ubBusCountP; ubBusT++)
+  {
+    ulCountT += atsBusP[ubBusT].ulSampleCount;
+  }
+  return ulCountT;
+}
+
+//--------------------------------------------------------------------------------------------------------------------//
+//                                                                                                                    //
+//                                                                                                                    //
+//--------------------------------------------------------------------------------------------------------------------//
+uint32_t DPM86xxFleet::errorCount()
+{
+  uint32_t ulCountT = 0;
+
+  for (uint8_t ubBusT = 0; ubBusT < ubBusCountP; ubBusT++)
+  {
+    ulCountT += atsBusP[ubBusT].ulErrorCount;
+  }
+  return ulCountT;
+}
+
+//--------------------------------------------------------------------------------------------------------------------//
+//                                                                                                                    //
+//                                                                                                                    //
+//--------------------------------------------------------------------------------------------------------------------//
+void DPM86xxFleet::lock()
+{
+#ifdef ARDUINO
+  xSemaphoreTake(pvLockP, portMAX_DELAY);
+#else
+  clLockP.lock();
+#endif
+}
+
+//--------------------------------------------------------------------------------------------------------------------//
+//                                                                                                                    //
+//                                                                                                                    //
+//--------------------------------------------------------------------------------------------------------------------//
+void DPM86xxFleet::unlock()
+{
+#ifdef ARDUINO
+  xSemaphoreGive(pvLockP);
+#else
+  clLockP.unlock();
+#endif
+}
+
+//--------------------------------------------------------------------------------------------------------------------//
+//                                                                                                                    //
+//                                                                                                                    //
+//--------------------------------------------------------------------------------------------------------------------//
+void DPM86xxFleet::task(void *pvParameterV)
+{
+  Bus_ts *ptsBusT = static_cast<Bus_ts *>(pvParameterV);
+
+  ptsBusT->pclFleet->run(*ptsBusT);
+
+#ifdef ARDUINO
+  vTaskDelete(nullptr);
+#endif
+}
+
+//--------------------------------------------------------------------------------------------------------------------//
+//                                                                                                                    //
+//                                                                                                                    //
+//--------------------------------------------------------------------------------------------------------------------//
+void DPM86xxFleet::run(Bus_ts &tsBusR)
+{
+  uint32_t ulNextT = millis();
+  uint32_t ulSweepT = 0;
+  int32_t slWaitT;
+
+  while (btRunP)
+  {
+    //-------------------------------------------------------------------------------------------
+    // read all PSUs of the interface, the worker is the only task that accesses them
+    //
+    ulSweepT++;
+    for (uint16_t uwIndexT = 0; uwIndexT < uwDeviceCountP; uwIndexT++)
+    {
+      if (aubBusP[uwIndexT] != tsBusR.ubIndex)
+      {
+        continue;
+      }
+
+      Reading_ts &tsReadingT = atsWorkP[uwIndexT];
+      if (aclPsuP[uwIndexT].readSnapshot(tsReadingT.tsSnapshot, ubFieldsP) == DPM86xx::eSTATUS_OK)
+      {
+        tsBusR.ulSampleCount++;
+      }
+      else
+      {
+        tsReadingT.tsSnapshot.ubFields = 0;
+        tsBusR.ulErrorCount++;
+      }
+      tsReadingT.ulSweep = ulSweepT;
+    }
+
+    //-------------------------------------------------------------------------------------------
+    // publish the complete sweep
+    //
+    lock();
+    for (uint16_t uwIndexT = 0; uwIndexT < uwDeviceCountP; uwIndexT++)
+    {
+      if (aubBusP[uwIndexT] == tsBusR.ubIndex)
+      {
+        atsPublishedP[uwIndexT] = atsWorkP[uwIndexT];
+      }
+    }
+    unlock();
+    tsBusR.ulSweepCount++;
+
+    //-------------------------------------------------------------------------------------------
+    // the telemetry table has its own lock, failed reads are stored with no valid field
+    //
+    if (pclTelemetryP != nullptr)
+    {
+      for (uint16_t uwIndexT = 0; uwIndexT < uwDeviceCountP; uwIndexT++)
+      {
+        if (aubBusP[uwIndexT] == tsBusR.ubIndex)
+        {
+          pclTelemetryP->update((uint16_t)(uwFirstDeviceP + uwIndexT), atsWorkP[uwIndexT].tsSnapshot);
+        }
+      }
+    }
+
+    //-------------------------------------------------------------------------------------------
+    // sweeps are started on absolute times, so the period does not drift with the duration of
+    // the transactions. If a sweep took too long, the next one starts immediately.
+    //
+    ulNextT += ulPeriodP;
+    slWaitT = (int32_t)(ulNextT - (uint32_t)millis());
+    if (slWaitT > 0)
+    {
+      delay((uint32_t)slWaitT);
+    }
+    else
+    {
+      ulNextT = millis();
+      yield();
+    }
+  }
+
+  tsBusR.btActive = false;
+}
+
+#endif
@@ -0,0 +1,245 @@
+//====================================================================================================================//
+// File:          DPM86xxFleet.h                                                                                      //
+// Description:   DPM86xxFleet Class definition, PSUs on several serial interfaces read in parallel                   //
+// Author:        Tiderko                                                                                             //
+//--------------------------------------------------------------------------------------------------------------------//
+//                                                                                                                    //
+//====================================================================================================================//
+
+#ifndef DPM86xxFleet_h
+#define DPM86xxFleet_h
+
+#include "DPM86xx.h"
+#include "DPM86xxTelemetry.h"
+
+#if defined(ESP32) || !defined(ARDUINO)
+
+#include <atomic>
+
+#ifdef ARDUINO
+#include <freertos/FreeRTOS.h>
+#include <freertos/semphr.h>
+#include <freertos/task.h>
+#else
+#include <mutex>
+#include <thread>
+#endif
+
+/**
+ * @brief Maximal number of serial interfaces of a fleet
+ *
+ */
+#ifndef DPM86XX_FLEET_BUSES_MAX
+#define DPM86XX_FLEET_BUSES_MAX 8
+#endif
+
+/**
+ * @brief Maximal number of PSUs of a fleet, on all serial interfaces together
+ *
+ */
+#ifndef DPM86XX_FLEET_DEVICES_MAX
+#define DPM86XX_FLEET_DEVICES_MAX 32
+#endif
+
+/**
+ * @brief Stack size in [byte] of each bus worker task on ESP32
+ *
+ */
+#ifndef DPM86XX_FLEET_STACK
+#define DPM86XX_FLEET_STACK 4096
+#endif
+
+/**
+ * @brief PSUs on several serial interfaces, that are read by one worker per interface
+ *
+ * Every transaction blocks until the response has been received, so one task can only use one serial interface at
+ * a time. The fleet runs one worker for each serial interface, so all interfaces transact concurrently. On ESP32
+ * FreeRTOS tasks are used, on a host \c std::thread, e.g. with a \c DPM86xxTty for each port.
+ *
+ * Each worker reads the measured values of all PSUs of its interface one after the other. Once all PSUs have been
+ * read, the sweep is published under a lock, so snapshot() always returns complete sweeps of all interfaces and
+ * never a mixture of old and new values of one interface.
+ *
+ * PSUs are configured by addBus() and addDevice() before start(). While the fleet is running, no other transaction
+ * must be started on its PSUs.
+ */
+class DPM86xxFleet
+{
+public:
+  /**
+   * @brief Measured values of one PSU, returned by snapshot()
+   */
+  typedef struct Reading_s
+  {
+    /**
+     * @brief Measured values, \c ubFields is 0 if the last read failed
+     */
+    DPM86xx::Snapshot_ts tsSnapshot;
+
+    /**
+     * @brief Number of the sweep of the serial interface, that has read the values
+     */
+    uint32_t ulSweep;
+
+    uint8_t ubBus;
+    uint8_t ubAddress;
+  } Reading_ts;
+
+  DPM86xxFleet();
+  ~DPM86xxFleet();
+
+#ifdef ARDUINO
+  /**
+   * @brief Add a serial interface
+   *
+   * @param[in] clSerialIfR serial interface that has been started with the baud rate of the PSUs
+   * @return index of the interface, -1 if no further interface can be added
+   */
+  int32_t addBus(HardwareSerial &clSerialIfR);
+#endif
+
+  /**
+   * @brief Add a serial interface
+   *
+   * @param[in] clTransportR transport, e.g. a \c DPM86xxTty or \c DPM86xxSim
+   * @return index of the interface, -1 if no further interface can be added
+   */
+  int32_t addBus(DPM86xxTransport &clTransportR);
+
+  /**
+   * @brief Add a PSU to a serial interface
+   *
+   * @param[in] ubBusV index of the interface returned by addBus()
+   * @param[in] ubAddressV address of the PSU in range from 1 to 99
+   * @return index of the PSU, -1 if no further PSU can be added or the fleet is running
+   */
+  int32_t addDevice(uint8_t ubBusV, uint8_t ubAddressV);
+
+  /**
+   * @brief Returns a PSU, e.g. to change its settings before start()
+   *
+   * @param[in] uwIndexV index returned by addDevice()
+   */
+  DPM86xx &psu(uint16_t uwIndexV);
+
+  /**
+   * @brief Store the measured values of each sweep also in a telemetry table
+   *
+   * The PSU with index \p n returned by addDevice() is stored with the device id \p uwFirstDeviceV + \p n, so
+   * several fleets can share one table. Must be called before start().
+   *
+   * @param[in] clTelemetryR telemetry table
+   * @param[in] uwFirstDeviceV device id of the first PSU of the fleet
+   */
+  void setTelemetry(DPM86xxTelemetry &clTelemetryR, uint16_t uwFirstDeviceV = 0);
+
+  /**
+   * @brief Start one worker for each serial interface
+   *
+   * @param[in] ulPeriodV time in [ms] between the start of two sweeps of each interface, 0 starts the next sweep
+   *            immediately
+   * @param[in] ubFieldsV combination of \c #DPM86xx::SnapshotField_e values that should be read
+   * @return \c true on success, \c false if the fleet is already running or a worker could not be created
+   */
+  bool start(uint32_t ulPeriodV = 0,
+             uint8_t ubFieldsV = DPM86xx::eSNAP_VOLTAGE | DPM86xx::eSNAP_CURRENT | DPM86xx::eSNAP_CONSTANT_OUTPUT);
+
+  /**
+   * @brief Stop all workers and wait until they have finished
+   */
+  void stop();
+
+  /**
+   * @brief Copy the last published sweep of all serial interfaces
+   *
+   * @param[out] atsReadingR readings, ordered by the index returned by addDevice()
+   * @param[in] uwSizeV number of elements of \p atsReadingR
+   * @return number of readings that have been copied
+   */
+  uint16_t snapshot(Reading_ts atsReadingR[], uint16_t uwSizeV);
+
+  /**
+   * @brief Returns the number of serial interfaces
+   */
+  uint8_t busCount();
+
+  /**
+   * @brief Returns the number of PSUs on all serial interfaces
+   */
+  uint16_t deviceCount();
+
+  /**
+   * @brief Returns the number of sweeps that have been published by one serial interface
+   *
+   * @param[in] ubBusV index of the interface
+   */
+  uint32_t sweepCount(uint8_t ubBusV);
+
+  /**
+   * @brief Returns the number of PSUs that have been read successfully on all serial interfaces
+   */
+  uint32_t sampleCount();
+
+  /**
+   * @brief Returns the number of reads that failed on all serial interfaces
+   */
+  uint32_t errorCount();
+
+private:
+  /**
+   * @brief Serial interface and its worker
+   */
+  typedef struct Bus_s
+  {
+    DPM86xxFleet *pclFleet;
+    DPM86xxTransport *pclTransport;
+    std::atomic<bool> btActive;
+    std::atomic<uint32_t> ulSweepCount;
+    std::atomic<uint32_t> ulSampleCount;
+    std::atomic<uint32_t> ulErrorCount;
+    uint8_t ubIndex;
+#ifdef ARDUINO
+    DPM86xxSerial clSerial;
+    TaskHandle_t pvTask;
+#else
+    std::thread clThread;
+#endif
+  } Bus_ts;
+
+  static void task(void *pvParameterV);
+  void run(Bus_ts &tsBusR);
+  void lock();
+  void unlock();
+
+  Bus_ts atsBusP[DPM86XX_FLEET_BUSES_MAX];
+  uint8_t ubBusCountP;
+
+  DPM86xx aclPsuP[DPM86XX_FLEET_DEVICES_MAX];
+  uint8_t aubBusP[DPM86XX_FLEET_DEVICES_MAX];
+  uint16_t uwDeviceCountP;
+
+  //---------------------------------------------------------------------------------------------------
+  // each worker writes the readings of its PSUs to the work buffer and copies them to the published
+  // buffer under the lock once the sweep is complete
+  //
+  Reading_ts atsWorkP[DPM86XX_FLEET_DEVICES_MAX];
+  Reading_ts atsPublishedP[DPM86XX_FLEET_DEVICES_MAX];
+
+  DPM86xxTelemetry *pclTelemetryP;
+  uint16_t uwFirstDeviceP;
+
+  uint32_t ulPeriodP;
+  uint8_t ubFieldsP;
+  std::atomic<bool> btRunP;
+  bool btStartedP;
+
+#ifdef ARDUINO
+  SemaphoreHandle_t pvLockP;
+#else
+  std::mutex clLockP;
+#endif
+};
+
+#endif
+
+#endif
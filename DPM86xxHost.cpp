@@ -0,0 +1,112 @@
+//====================================================================================================================//
+// File:          DPM86xxHost.cpp                                                                                     //
+// Description:   Replacement of the Arduino API parts used by DPM86xx for builds on a host (e.g. Linux)              //
+// Author:        Tiderko                                                                                             //
+//--------------------------------------------------------------------------------------------------------------------//
+//                                                                                                                    //
+//====================================================================================================================//
+
+#include <DPM86xxHost.h>
+
+#ifndef ARDUINO
+
+#include <stdio.h>
+#include <chrono>
+#include <thread>
+
+DPM86xxHostLog Serial;
+
+static const std::chrono::steady_clock::time_point clStartTimeS = std::chrono::steady_clock::now();
+
+//--------------------------------------------------------------------------------------------------------------------//
+//                                                                                                                    //
+//                                                                                                                    //
+//--------------------------------------------------------------------------------------------------------------------//
+unsigned long millis()
+{
+  //---------------------------------------------------------------------------------------------------
+  // unsigned long has 64 bit on Linux, the counter must wrap at 32 bit like on Arduino
+  //
+  return (unsigned long)(uint32_t)std::chrono::duration_cast<std::chrono::milliseconds>(
+             std::chrono::steady_clock::now() - clStartTimeS)
+      .count();
+}
+
+//--------------------------------------------------------------------------------------------------------------------//
+//                                                                                                                    //
+//                                                                                                                    //
+//--------------------------------------------------------------------------------------------------------------------//
+unsigned long micros()
+{
+  //---------------------------------------------------------------------------------------------------
+  // wraps at 32 bit after about 71.6 minutes, like on Arduino
+  //
+  return (unsigned long)(uint32_t)std::chrono::duration_cast<std::chrono::microseconds>(
+             std::chrono::steady_clock::now() - clStartTimeS)
+      .count();
+}
+
+//--------------------------------------------------------------------------------------------------------------------//
+//                                                                                                                    //
+//                                                                                                                    //
+//--------------------------------------------------------------------------------------------------------------------//
+void delay(unsigned long ulTimeV)
+{
+  std::this_thread::sleep_for(std::chrono::milliseconds(ulTimeV));
+}
+
+//--------------------------------------------------------------------------------------------------------------------//
+//                                                                                                                    //
+//                                                                                                                    //
+//--------------------------------------------------------------------------------------------------------------------//
+void delayMicroseconds(unsigned int ulTimeV)
+{
+  std::this_thread::sleep_for(std::chrono::microseconds(ulTimeV));
+}
+
+//--------------------------------------------------------------------------------------------------------------------//
+//                                                                                                                    //
+//                                                                                                                    //
+//--------------------------------------------------------------------------------------------------------------------//
+void yield()
+{
+  std::this_thread::yield();
+}
+
+//--------------------------------------------------------------------------------------------------------------------//
+//                                                                                                                    //
+//                                                                                                                    //
+//--------------------------------------------------------------------------------------------------------------------//
+void DPM86xxHostLog::print(const char *pszStringV)
+{
+  fputs(pszStringV, stdout);
+}
+
+//--------------------------------------------------------------------------------------------------------------------//
+//                                                                                                                    //
+//                                                                                                                    //
+//--------------------------------------------------------------------------------------------------------------------//
+void DPM86xxHostLog::print(long slValueV)
+{
+  printf("%ld", slValueV);
+}
+
+//--------------------------------------------------------------------------------------------------------------------//
+//                                                                                                                    //
+//                                                                                                                    //
+//--------------------------------------------------------------------------------------------------------------------//
+void DPM86xxHostLog::println(const char *pszStringV)
+{
+  puts(pszStringV);
+}
+
+//--------------------------------------------------------------------------------------------------------------------//
+//                                                                                                                    //
+//                                                                                                                    //
+//--------------------------------------------------------------------------------------------------------------------//
+void DPM86xxHostLog::println(long slValueV)
+{
+  printf("%ld\n", slValueV);
+}
+
+#endif
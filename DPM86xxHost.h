@@ -0,0 +1,85 @@
+//====================================================================================================================//
+// File:          DPM86xxHost.h                                                                                       //
+// Description:   Replacement of the Arduino API parts used by DPM86xx for builds on a host (e.g. Linux)              //
+// Author:        Tiderko                                                                                             //
+//--------------------------------------------------------------------------------------------------------------------//
+//                                                                                                                    //
+//====================================================================================================================//
+
+#ifndef DPM86xxHost_h
+#define DPM86xxHost_h
+
+#ifndef ARDUINO
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <cctype>
+#include <string>
+
+/**
+ * @brief Returns the number of milliseconds passed since the program started, wraps around at 32 bit
+ */
+unsigned long millis();
+
+/**
+ * @brief Returns the number of microseconds passed since the program started, wraps around at 32 bit
+ */
+unsigned long micros();
+
+/**
+ * @brief Pause the program for the given time in [ms]
+ */
+void delay(unsigned long ulTimeV);
+
+/**
+ * @brief Pause the program for the given time in [us]
+ */
+void delayMicroseconds(unsigned int ulTimeV);
+
+/**
+ * @brief Pass control to other threads
+ */
+void yield();
+
+/**
+ * @brief Minimal replacement of the Arduino \c String class, as far as it is used by this library
+ */
+class String
+{
+public:
+  String() {}
+  String(const char *pszStringV) : sclStringP((pszStringV != nullptr) ? pszStringV : "") {}
+
+  String operator+(const char *pszStringV) const { return String((sclStringP + pszStringV).c_str()); }
+  unsigned int length() const { return (unsigned int)sclStringP.length(); }
+  int indexOf(char chValueV) const
+  {
+    size_t ulPosT = sclStringP.find(chValueV);
+    return (ulPosT == std::string::npos) ? -1 : (int)ulPosT;
+  }
+  bool equals(const char *pszStringV) const { return (sclStringP == pszStringV); }
+  const char *c_str() const { return sclStringP.c_str(); }
+
+private:
+  std::string sclStringP;
+};
+
+/**
+ * @brief Replacement of the Arduino \c Serial interface, all output is printed to \c stdout
+ */
+class DPM86xxHostLog
+{
+public:
+  void print(const char *pszStringV);
+  void print(long slValueV);
+  void println(const char *pszStringV = "");
+  void println(long slValueV);
+};
+
+extern DPM86xxHostLog Serial;
+
+#endif
+
+#endif
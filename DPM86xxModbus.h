@@ -0,0 +1,159 @@
+//====================================================================================================================//
+// File:          DPM86xxModbus.h                                                                                     //
+// Description:   Modbus-RTU frame encoding and CRC16 used by the RS-485 variants of DPM86xx                          //
+// Author:        Tiderko                                                                                             //
+//--------------------------------------------------------------------------------------------------------------------//
+//                                                                                                                    //
+//====================================================================================================================//
+
+#ifndef DPM86xxModbus_h
+#define DPM86xxModbus_h
+
+#include <stddef.h>
+#include <stdint.h>
+
+/**
+ * @brief Modbus function codes used by the PSU
+ *
+ */
+#define DPM86XX_MODBUS_READ_REGISTERS 0x03
+#define DPM86XX_MODBUS_WRITE_REGISTER 0x06
+#define DPM86XX_MODBUS_WRITE_REGISTERS 0x10
+
+/**
+ * @brief Bit that is set in the function code of an exception response
+ *
+ */
+#define DPM86XX_MODBUS_EXCEPTION 0x80
+
+/**
+ * @brief Holding registers of the PSU, the measured values are placed one after the other, so they can be read
+ *        with one request
+ *
+ */
+#define DPM86XX_MODBUS_REG_SET_VOLTAGE 0x0000
+#define DPM86XX_MODBUS_REG_SET_CURRENT 0x0001
+#define DPM86XX_MODBUS_REG_OUTPUT 0x0002
+#define DPM86XX_MODBUS_REG_MEASURED_VOLTAGE 0x1000
+#define DPM86XX_MODBUS_REG_MEASURED_CURRENT 0x1001
+#define DPM86XX_MODBUS_REG_CONSTANT_OUTPUT 0x1002
+#define DPM86XX_MODBUS_REG_TEMPERATURE 0x1003
+
+/**
+ * @brief Registers of the maximal output voltage and current, they are not part of the register map in the manual.
+ *        Define them according to the firmware of the PSU, otherwise \c #DPM86xx::eFUNC_MAX_VOLTAGE and
+ *        \c #DPM86xx::eFUNC_MAX_CURRENT return \c #DPM86xx::eSTATUS_UNSUPPORTED with Modbus-RTU.
+ *
+ */
+#ifndef DPM86XX_MODBUS_REG_MAX_VOLTAGE
+#undef DPM86XX_MODBUS_REG_MAX_VOLTAGE
+#endif
+#ifndef DPM86XX_MODBUS_REG_MAX_CURRENT
+#undef DPM86XX_MODBUS_REG_MAX_CURRENT
+#endif
+
+/**
+ * @brief Number of registers in the block of measured values: voltage, current, constant output and temperature
+ *
+ */
+#define DPM86XX_MODBUS_MEASURED_BLOCK 4
+
+/**
+ * @brief Encoding and decoding of Modbus-RTU frames
+ *
+ * All values are transmitted with the most significant byte first, the CRC is appended with the least significant
+ * byte first.
+ */
+class DPM86xxModbus
+{
+public:
+  /**
+   * @brief Calculate the CRC16 of a frame with a lookup table
+   *
+   * @param[in] pubDataV frame data
+   * @param[in] ubLengthV number of bytes
+   * @return CRC of the data
+   */
+  static uint16_t crc16(const uint8_t *pubDataV, uint8_t ubLengthV);
+
+  /**
+   * @brief Append the CRC16 to a frame
+   *
+   * @param[in,out] pubFrameV frame, must provide space for two further bytes
+   * @param[in] ubLengthV number of bytes in frame without CRC
+   * @return number of bytes in frame with CRC
+   */
+  static uint8_t appendCrc(uint8_t *pubFrameV, uint8_t ubLengthV);
+
+  /**
+   * @brief Check the CRC16 at the end of a frame
+   *
+   * @param[in] pubFrameV frame
+   * @param[in] ubLengthV number of bytes in frame including CRC
+   * @return \c true if the CRC is valid
+   */
+  static bool checkCrc(const uint8_t *pubFrameV, uint8_t ubLengthV);
+
+  /**
+   * @brief Create a request that reads holding registers (function code 0x03)
+   *
+   * @param[out] pubFrameV frame, at least 8 bytes
+   * @param[in] ubAddressV address of the PSU
+   * @param[in] uwRegisterV first register
+   * @param[in] ubCountV number of registers
+   * @return number of bytes in frame
+   */
+  static uint8_t encodeRead(uint8_t *pubFrameV, uint8_t ubAddressV, uint16_t uwRegisterV, uint8_t ubCountV);
+
+  /**
+   * @brief Create a request that writes one register (function code 0x06)
+   *
+   * @param[out] pubFrameV frame, at least 8 bytes
+   * @param[in] ubAddressV address of the PSU
+   * @param[in] uwRegisterV register
+   * @param[in] uwValueV value
+   * @return number of bytes in frame
+   */
+  static uint8_t encodeWrite(uint8_t *pubFrameV, uint8_t ubAddressV, uint16_t uwRegisterV, uint16_t uwValueV);
+
+  /**
+   * @brief Create a request that writes several registers (function code 0x10)
+   *
+   * @param[out] pubFrameV frame, at least 9 bytes plus 2 bytes for each register
+   * @param[in] ubAddressV address of the PSU
+   * @param[in] uwRegisterV first register
+   * @param[in] puwValueV values
+   * @param[in] ubCountV number of registers
+   * @return number of bytes in frame
+   */
+  static uint8_t encodeWriteMultiple(uint8_t *pubFrameV, uint8_t ubAddressV, uint16_t uwRegisterV,
+                                     const uint16_t *puwValueV, uint8_t ubCountV);
+
+  /**
+   * @brief Returns the length of a request, as soon as it can be derived from the received bytes
+   *
+   * @param[in] pubFrameV received bytes
+   * @param[in] ubLengthV number of received bytes
+   * @return length of the complete frame, 0 if it is not known yet
+   */
+  static uint8_t requestLength(const uint8_t *pubFrameV, uint8_t ubLengthV);
+
+  /**
+   * @brief Returns the length of a response, as soon as it can be derived from the received bytes
+   *
+   * @param[in] pubFrameV received bytes
+   * @param[in] ubLengthV number of received bytes
+   * @return length of the complete frame, 0 if it is not known yet
+   */
+  static uint8_t responseLength(const uint8_t *pubFrameV, uint8_t ubLengthV);
+
+  /**
+   * @brief Returns the 16 bit value at the given position of a frame
+   */
+  static uint16_t value(const uint8_t *pubFrameV) { return (uint16_t)((pubFrameV[0] << 8) | pubFrameV[1]); }
+
+private:
+  static const uint16_t auwCrcTableP[256];
+};
+
+#endif
@@ -0,0 +1,196 @@
+//====================================================================================================================//
+// File:          DPM86xxModel.h                                                                                      //
+// Description:   DPM86xxModel Class template, DPM86xx specialised for one model at compile time                      //
+// Author:        Tiderko                                                                                             //
+//--------------------------------------------------------------------------------------------------------------------//
+//                                                                                                                    //
+//====================================================================================================================//
+
+#ifndef DPM86xxModel_h
+#define DPM86xxModel_h
+
+#include "DPM86xx.h"
+
+/**
+ * @brief Limits of a model given in register units: voltage in [10 mV], current in [mA]
+ *
+ * @tparam uwModelV model number: 8605, 8608, 8616 or 8624
+ */
+template <uint16_t uwModelV> struct DPM86xxLimits;
+
+template <> struct DPM86xxLimits<8605>
+{
+  static constexpr uint16_t uwMaxVoltage = 6000;
+  static constexpr uint16_t uwMaxCurrent = 5000;
+};
+
+template <> struct DPM86xxLimits<8608>
+{
+  static constexpr uint16_t uwMaxVoltage = 6000;
+  static constexpr uint16_t uwMaxCurrent = 8000;
+};
+
+template <> struct DPM86xxLimits<8616>
+{
+  static constexpr uint16_t uwMaxVoltage = 6000;
+  static constexpr uint16_t uwMaxCurrent = 16000;
+};
+
+template <> struct DPM86xxLimits<8624>
+{
+  static constexpr uint16_t uwMaxVoltage = 6000;
+  static constexpr uint16_t uwMaxCurrent = 24000;
+};
+
+/**
+ * @brief DPM86xx with limits and register scaling of the model known at compile time
+ *
+ * @tparam uwModelV model number: 8605, 8608, 8616 or 8624
+ *
+ * The limits do not have to be read from the PSU at startup, setpoints are clamped to them and converted to
+ * register values by \c constexpr functions, so constant setpoints cost nothing at runtime. Only in debug builds,
+ * i.e. \c NDEBUG is not defined, init() reads the limits from the PSU and compares them with the model.
+ */
+template <uint16_t uwModelV> class DPM86xxModel : public DPM86xx
+{
+public:
+  /**
+   * @brief Maximal output voltage in [10 mV]
+   */
+  static constexpr uint16_t MAX_VOLTAGE = DPM86xxLimits<uwModelV>::uwMaxVoltage;
+
+  /**
+   * @brief Maximal output current in [mA]
+   */
+  static constexpr uint16_t MAX_CURRENT = DPM86xxLimits<uwModelV>::uwMaxCurrent;
+
+  /**
+   * @brief Convert a voltage in [mV] to the register value, rounded and limited to the maximal voltage of the model
+   */
+  static constexpr uint16_t voltageRegister(uint32_t ulMillivoltV)
+  {
+    return (millivoltRegister(ulMillivoltV) > MAX_VOLTAGE) ? MAX_VOLTAGE : millivoltRegister(ulMillivoltV);
+  }
+
+  /**
+   * @brief Convert a current in [mA] to the register value, limited to the maximal current of the model
+   */
+  static constexpr uint16_t currentRegister(uint32_t ulMilliampereV)
+  {
+    return (milliampereRegister(ulMilliampereV) > MAX_CURRENT) ? MAX_CURRENT : milliampereRegister(ulMilliampereV);
+  }
+
+  /**
+   * @brief Returns the maximum output voltage supported by the model
+   * @return float value given in [V]
+   */
+  static constexpr float maxVoltage() { return (float)MAX_VOLTAGE / 100.0f; }
+
+  /**
+   * @brief Returns the maximum output current supported by the model
+   * @return float value given in [A]
+   */
+  static constexpr float maxCurrent() { return (float)MAX_CURRENT / 1000.0f; }
+
+  /**
+   * @brief Initialisation of object parameters
+   *
+   * @param[in] clTransportR byte stream, that should be used by this object
+   * @param[in] ubAddressV address of the PSU in range from 1 to 99
+   * @return \c #eSTATUS_OK on success. In debug builds \c #eSTATUS_MODEL is returned if the PSU reports other
+   *         limits, or a negative value of \c #Status_e if they could not be read. The limits are not checked if
+   *         the protocol can not read them, see \c #eSTATUS_UNSUPPORTED.
+   */
+  int32_t init(DPM86xxTransport &clTransportR, uint8_t ubAddressV = 1)
+  {
+    DPM86xx::init(clTransportR, ubAddressV);
+    return verifyModel();
+  }
+
+#ifdef ARDUINO
+  /**
+   * @brief Initialisation of object parameters
+   *
+   * @param[in] clSerialIfR interface, that should be used by this object
+   * @param[in] ubAddressV address of the PSU in range from 1 to 99
+   * @return see init(DPM86xxTransport &, uint8_t)
+   */
+  int32_t init(HardwareSerial &clSerialIfR, uint8_t ubAddressV = 1)
+  {
+    DPM86xx::init(clSerialIfR, ubAddressV);
+    return verifyModel();
+  }
+#endif
+
+  /**
+   * @brief Write voltage setpoint
+   *
+   * @param[in] ulMillivoltV voltage in [mV], limited to the maximal voltage of the model
+   * @return see writeFunction()
+   */
+  int32_t setVoltage(uint32_t ulMillivoltV) { return writeFunction(eFUNC_SET_VOLTAGE, voltageRegister(ulMillivoltV)); }
+
+  /**
+   * @brief Write current setpoint
+   *
+   * @param[in] ulMilliampereV current in [mA], limited to the maximal current of the model
+   * @return see writeFunction()
+   */
+  int32_t setCurrent(uint32_t ulMilliampereV)
+  {
+    return writeFunction(eFUNC_SET_CURRENT, currentRegister(ulMilliampereV));
+  }
+
+  /**
+   * @brief Write voltage and current setpoint with one request
+   *
+   * @param[in] ulMillivoltV voltage in [mV], limited to the maximal voltage of the model
+   * @param[in] ulMilliampereV current in [mA], limited to the maximal current of the model
+   * @return see writeFunction()
+   */
+  int32_t setVoltageCurrent(uint32_t ulMillivoltV, uint32_t ulMilliampereV)
+  {
+    return writeFunction(eFUNC_SET_VC, voltageRegister(ulMillivoltV), currentRegister(ulMilliampereV));
+  }
+
+private:
+  int32_t verifyModel()
+  {
+#ifndef NDEBUG
+    //-------------------------------------------------------------------------------------------
+    // the limits can not be verified with Modbus-RTU, if their registers are not defined
+    //
+    int32_t slReturnT = readFunction(eFUNC_MAX_VOLTAGE);
+    if (slReturnT == eSTATUS_UNSUPPORTED)
+    {
+      return eSTATUS_OK;
+    }
+    if (slReturnT < 0)
+    {
+      return slReturnT;
+    }
+    if (slReturnT != MAX_VOLTAGE)
+    {
+      return eSTATUS_MODEL;
+    }
+
+    slReturnT = readFunction(eFUNC_MAX_CURRENT);
+    if (slReturnT < 0)
+    {
+      return slReturnT;
+    }
+    if (slReturnT != MAX_CURRENT)
+    {
+      return eSTATUS_MODEL;
+    }
+#endif
+    return eSTATUS_OK;
+  }
+};
+
+typedef DPM86xxModel<8605> DPM8605;
+typedef DPM86xxModel<8608> DPM8608;
+typedef DPM86xxModel<8616> DPM8616;
+typedef DPM86xxModel<8624> DPM8624;
+
+#endif
@@ -0,0 +1,382 @@
+//====================================================================================================================//
+// File:          DPM86xxProfile.cpp                                                                                  //
+// Description:   DPM86xxProfile implementation                                                                       //
+// Author:        Tiderko                                                                                             //
+//--------------------------------------------------------------------------------------------------------------------//
+//                                                                                                                    //
+//====================================================================================================================//
+
+#include <DPM86xxProfile.h>
+
+//--------------------------------------------------------------------------------------------------------------------//
+//                                                                                                                    //
+//                                                                                                                    //
+//--------------------------------------------------------------------------------------------------------------------//
+DPM86xxProfile::DPM86xxProfile()
+{
+  pclPsuP = nullptr;
+  uwStepCountP = 0;
+  uwStepIndexP = 0;
+  btRunningP = false;
+  btPendingP = false;
+}
+
+//--------------------------------------------------------------------------------------------------------------------//
+//                                                                                                                    //
+//                                                                                                                    //
+//--------------------------------------------------------------------------------------------------------------------//
+bool DPM86xxProfile::addStep(uint32_t ulTimeV, uint32_t ulMillivoltV, uint32_t ulMilliampereV)
+{
+  uint16_t uwVoltageT = DPM86xx::millivoltRegister(ulMillivoltV);
+  uint16_t uwCurrentT = DPM86xx::milliampereRegister(ulMilliampereV);
+
+  //---------------------------------------------------------------------------------------------------
+  // a step that does not change the registers is not written
+  //
+  if ((uwStepCountP > 0) && (atsStepP[uwStepCountP - 1].uwVoltage == uwVoltageT) &&
+      (atsStepP[uwStepCountP - 1].uwCurrent == uwCurrentT))
+  {
+    return true;
+  }
+  if (uwStepCountP >= DPM86XX_PROFILE_STEPS_MAX)
+  {
+    return false;
+  }
+
+  Step_ts &tsStepT = atsStepP[uwStepCountP++];
+  tsStepT.ulTime = ulTimeV;
+  tsStepT.uwVoltage = uwVoltageT;
+  tsStepT.uwCurrent = uwCurrentT;
+  tsStepT.slLateness = 0;
+  tsStepT.slCompletion = 0;
+  tsStepT.slResult = DPM86xx::eSTATUS_OK;
+  tsStepT.btSkipped = false;
+
+  return true;
+}
+
+//--------------------------------------------------------------------------------------------------------------------//
+//                                                                                                                    //
+//                                                                                                                    //
+//--------------------------------------------------------------------------------------------------------------------//
+uint16_t DPM86xxProfile::load(const Point_ts atsPointV[], uint16_t uwCountV, uint32_t ulRampStepV)
+{
+  if (btRunningP)
+  {
+    return 0;
+  }
+  uwStepCountP = 0;
+
+  if (ulRampStepV == 0)
+  {
+    ulRampStepV = DPM86XX_PROFILE_RAMP_STEP;
+  }
+
+  for (uint16_t uwPointT = 0; uwPointT < uwCountV; uwPointT++)
+  {
+    const Point_ts &tsPointT = atsPointV[uwPointT];
+
+    //-------------------------------------------------------------------------------------------
+    // a ramp is divided into steps, the values are interpolated at the end of each interval
+    // from the previous point
+    //
+    if ((tsPointT.teShape == eSHAPE_RAMP) && (uwPointT > 0) && (tsPointT.ulTime > atsPointV[uwPointT - 1].ulTime))
+    {
+      const Point_ts &tsStartT = atsPointV[uwPointT - 1];
+      uint32_t ulDurationT = tsPointT.ulTime - tsStartT.ulTime;
+
+      for (uint32_t ulOffsetT = ulRampStepV; ulOffsetT < ulDurationT; ulOffsetT += ulRampStepV)
+      {
+        int64_t sqVoltageT = (int64_t)tsPointT.ulMillivolt - (int64_t)tsStartT.ulMillivolt;
+        int64_t sqCurrentT = (int64_t)tsPointT.ulMilliampere - (int64_t)tsStartT.ulMilliampere;
+
+        sqVoltageT = (int64_t)tsStartT.ulMillivolt + ((sqVoltageT * ulOffsetT) / ulDurationT);
+        sqCurrentT = (int64_t)tsStartT.ulMilliampere + ((sqCurrentT * ulOffsetT) / ulDurationT);
+        if (addStep(tsStartT.ulTime + ulOffsetT, (uint32_t)sqVoltageT, (uint32_t)sqCurrentT) != true)
+        {
+          uwStepCountP = 0;
+          return 0;
+        }
+      }
+    }
+
+    if (addStep(tsPointT.ulTime, tsPointT.ulMillivolt, tsPointT.ulMilliampere) != true)
+    {
+      uwStepCountP = 0;
+      return 0;
+    }
+  }
+
+  return uwStepCountP;
+}
+
+//--------------------------------------------------------------------------------------------------------------------//
+//                                                                                                                    //
+//                                                                                                                    //
+//--------------------------------------------------------------------------------------------------------------------//
+bool DPM86xxProfile::start(DPM86xx &clPsuR)
+{
+  if ((uwStepCountP == 0) || btRunningP)
+  {
+    return false;
+  }
+
+  for (uint16_t uwIndexT = 0; uwIndexT < uwStepCountP; uwIndexT++)
+  {
+    atsStepP[uwIndexT].slLateness = 0;
+    atsStepP[uwIndexT].slCompletion = 0;
+    atsStepP[uwIndexT].slResult = DPM86xx::eSTATUS_OK;
+    atsStepP[uwIndexT].btSkipped = false;
+  }
+
+  pclPsuP = &clPsuR;
+  uwStepIndexP = 0;
+  btPendingP = false;
+  btRunningP = true;
+  ulLastTimeP = micros();
+  uqElapsedP = 0;
+
+  return true;
+}
+
+//--------------------------------------------------------------------------------------------------------------------//
+//                                                                                                                    //
+//                                                                                                                    //
+//--------------------------------------------------------------------------------------------------------------------//
+void DPM86xxProfile::stop()
+{
+  while (btPendingP)
+  {
+    process();
+  }
+  btRunningP = false;
+}
+
+//--------------------------------------------------------------------------------------------------------------------//
+//                                                                                                                    //
+//                                                                                                                    //
+//--------------------------------------------------------------------------------------------------------------------//
+uint64_t DPM86xxProfile::deadline(uint16_t uwIndexV)
+{
+  return (uint64_t)atsStepP[uwIndexV].ulTime * 1000;
+}
+
+//--------------------------------------------------------------------------------------------------------------------//
+//                                                                                                                    //
+//                                                                                                                    //
+//--------------------------------------------------------------------------------------------------------------------//
+uint64_t DPM86xxProfile::elapsed()
+{
+  uint32_t ulTimeT = micros();
+
+  //---------------------------------------------------------------------------------------------------
+  // the time since the start is accumulated from the differences of micros(), so the deadlines of
+  // long profiles can be compared although micros() wraps around after about 71 minutes
+  //
+  uqElapsedP += (uint32_t)(ulTimeT - ulLastTimeP);
+  ulLastTimeP = ulTimeT;
+
+  return uqElapsedP;
+}
+
+//--------------------------------------------------------------------------------------------------------------------//
+//                                                                                                                    //
+//                                                                                                                    //
+//--------------------------------------------------------------------------------------------------------------------//
+bool DPM86xxProfile::process()
+{
+  uint64_t uqTimeT;
+
+  if (btRunningP == false)
+  {
+    return false;
+  }
+
+  //---------------------------------------------------------------------------------------------------
+  // finish the pending write
+  //
+  if (btPendingP)
+  {
+    int32_t slResultT = pclPsuP->poll();
+    if (slResultT == DPM86xx::eSTATUS_BUSY)
+    {
+      return true;
+    }
+
+    Step_ts &tsStepT = atsStepP[uwStepIndexP];
+    tsStepT.slResult = slResultT;
+    tsStepT.slCompletion = (int32_t)((int64_t)elapsed() - (int64_t)deadline(uwStepIndexP));
+    btPendingP = false;
+    uwStepIndexP++;
+  }
+
+  if (uwStepIndexP >= uwStepCountP)
+  {
+    btRunningP = false;
+    return false;
+  }
+
+  //---------------------------------------------------------------------------------------------------
+  // wait for the deadline, steps whose successor is due already are skipped
+  //
+  uqTimeT = elapsed();
+  if (uqTimeT < deadline(uwStepIndexP))
+  {
+    return true;
+  }
+  while (((uwStepIndexP + 1) < uwStepCountP) && (uqTimeT >= deadline(uwStepIndexP + 1)))
+  {
+    atsStepP[uwStepIndexP].btSkipped = true;
+    uwStepIndexP++;
+  }
+
+  Step_ts &tsStepT = atsStepP[uwStepIndexP];
+  tsStepT.slLateness = (int32_t)(uqTimeT - deadline(uwStepIndexP));
+  tsStepT.slResult = pclPsuP->beginWrite(DPM86xx::eFUNC_SET_VC, tsStepT.uwVoltage, tsStepT.uwCurrent);
+  if (tsStepT.slResult == DPM86xx::eSTATUS_OK)
+  {
+    btPendingP = true;
+  }
+  else
+  {
+    tsStepT.slCompletion = tsStepT.slLateness;
+    uwStepIndexP++;
+  }
+
+  return true;
+}
+
+//--------------------------------------------------------------------------------------------------------------------//
+//                                                                                                                    //
+//                                                                                                                    //
+//--------------------------------------------------------------------------------------------------------------------//
+void DPM86xxProfile::run()
+{
+  uint64_t uqWaitT;
+
+  while (process())
+  {
+    //-------------------------------------------------------------------------------------------
+    // a pending write is finished by the PSU, that sleeps in event receive mode
+    //
+    if (btPendingP)
+    {
+      pclPsuP->wait();
+      continue;
+    }
+
+    //-------------------------------------------------------------------------------------------
+    // sleep until the deadline, the last millisecond is waited with a resolution of [us], a long wait
+    // is divided, so the elapsed time is updated before micros() wraps around
+    //
+    uqWaitT = deadline(uwStepIndexP);
+    if (uqWaitT > elapsed())
+    {
+      uqWaitT -= uqElapsedP;
+      if (uqWaitT >= 2000)
+      {
+        delay((uint32_t)((uqWaitT < 60000000) ? ((uqWaitT / 1000) - 1) : 60000));
+      }
+      else
+      {
+        delayMicroseconds((uint32_t)uqWaitT);
+      }
+    }
+  }
+}
+
+//--------------------------------------------------------------------------------------------------------------------//
+//                                                                                                                    //
+//                                                                                                                    //
+//--------------------------------------------------------------------------------------------------------------------//
+uint16_t DPM86xxProfile::stepCount()
+{
+  return uwStepCountP;
+}
+
+//--------------------------------------------------------------------------------------------------------------------//
+//                                                                                                                    //
+//                                                                                                                    //
+//--------------------------------------------------------------------------------------------------------------------//
+const DPM86xxProfile::Step_ts &DPM86xxProfile::step(uint16_t uwIndexV)
+{
+  if (uwIndexV >= uwStepCountP)
+  {
+    uwIndexV = 0;
+  }
+  return atsStepP[uwIndexV];
+}
+
+//--------------------------------------------------------------------------------------------------------------------//
+//                                                                                                                    //
+//                                                                                                                    //
+//--------------------------------------------------------------------------------------------------------------------//
+int32_t DPM86xxProfile::maxLateness()
+{
+  int32_t slMaxT = 0;
+
+  for (uint16_t uwIndexT = 0; uwIndexT < uwStepCountP; uwIndexT++)
+  {
+    if ((atsStepP[uwIndexT].btSkipped == false) && (atsStepP[uwIndexT].slLateness > slMaxT))
+    {
+      slMaxT = atsStepP[uwIndexT].slLateness;
+    }
+  }
+  return slMaxT;
+}
+
+//--------------------------------------------------------------------------------------------------------------------//
+//                                                                                                                    //
+//                                                                                                                    //
+//--------------------------------------------------------------------------------------------------------------------//
+int32_t DPM86xxProfile::meanLateness()
+{
+  int64_t sqSumT = 0;
+  uint16_t uwCountT = 0;
+
+  for (uint16_t uwIndexT = 0; uwIndexT < uwStepCountP; uwIndexT++)
+  {
+    if (atsStepP[uwIndexT].btSkipped == false)
+    {
+      sqSumT += atsStepP[uwIndexT].slLateness;
+      uwCountT++;
+    }
+  }
+  return (uwCountT > 0) ? (int32_t)(sqSumT / uwCountT) : 0;
+}
+
+//--------------------------------------------------------------------------------------------------------------------//
+//                                                                                                                    //
+//                                                                                                                    //
+//--------------------------------------------------------------------------------------------------------------------//
+uint16_t DPM86xxProfile::skippedCount()
+{
+  uint16_t uwCountT = 0;
+
+  for (uint16_t uwIndexT = 0; uwIndexT < uwStepCountP; uwIndexT++)
+  {
+    if (atsStepP[uwIndexT].btSkipped)
+    {
+      uwCountT++;
+    }
+  }
+  return uwCountT;
+}
+
+//--------------------------------------------------------------------------------------------------------------------//
+//                                                                                                                    //
+//                                                                                                                    //
+//--------------------------------------------------------------------------------------------------------------------//
+uint16_t DPM86xxProfile::errorCount()
+{
+  uint16_t uwCountT = 0;
+
+  for (uint16_t uwIndexT = 0; uwIndexT < uwStepCountP; uwIndexT++)
+  {
+    if ((atsStepP[uwIndexT].btSkipped == false) && (atsStepP[uwIndexT].slResult < 0))
+    {
+      uwCountT++;
+    }
+  }
+  return uwCountT;
+}
@@ -0,0 +1,201 @@
+//====================================================================================================================//
+// File:          DPM86xxProfile.h                                                                                    //
+// Description:   DPM86xxProfile Class definition, setpoint profiles written on absolute deadlines                    //
+// Author:        Tiderko                                                                                             //
+//--------------------------------------------------------------------------------------------------------------------//
+//                                                                                                                    //
+//====================================================================================================================//
+
+#ifndef DPM86xxProfile_h
+#define DPM86xxProfile_h
+
+#include "DPM86xx.h"
+
+/**
+ * @brief Maximal number of setpoint steps of one profile
+ *
+ */
+#ifndef DPM86XX_PROFILE_STEPS_MAX
+#define DPM86XX_PROFILE_STEPS_MAX 128
+#endif
+
+/**
+ * @brief Default time in [ms] between two steps of a ramp, see DPM86xxProfile::load()
+ *
+ */
+#ifndef DPM86XX_PROFILE_RAMP_STEP
+#define DPM86XX_PROFILE_RAMP_STEP 100
+#endif
+
+/**
+ * @brief Writes a profile of voltage and current setpoints on absolute deadlines
+ *
+ * The profile is given by points, that are reached either by a step or by a linear ramp. When the profile is loaded,
+ * ramps are divided into steps and the register values of all steps are calculated. While running, each step is
+ * written by one \c #DPM86xx::eFUNC_SET_VC request at the start time of the profile plus the time of the step, so
+ * the duration of the transactions does not add up. If the writes fall behind, steps whose successor is already due
+ * are skipped, so the PSU always receives the setpoint that is valid now.
+ *
+ * The lateness of each write against its deadline is recorded, see step().
+ */
+class DPM86xxProfile
+{
+public:
+  /**
+   * @brief How a point of the profile is reached from the previous one
+   */
+  typedef enum Shape_e
+  {
+    /**
+     * @brief The setpoint is written at the time of the point
+     */
+    eSHAPE_STEP = 0,
+
+    /**
+     * @brief The setpoint changes linearly from the previous point
+     */
+    eSHAPE_RAMP
+  } Shape_te;
+
+  /**
+   * @brief Point of a profile, that is passed to load()
+   */
+  typedef struct Point_s
+  {
+    /**
+     * @brief Time in [ms] relative to the start of the profile
+     */
+    uint32_t ulTime;
+
+    uint32_t ulMillivolt;
+    uint32_t ulMilliampere;
+    Shape_te teShape;
+  } Point_ts;
+
+  /**
+   * @brief Precomputed step of a profile and its achieved timing, returned by step()
+   */
+  typedef struct Step_s
+  {
+    /**
+     * @brief Time in [ms] relative to the start of the profile
+     */
+    uint32_t ulTime;
+
+    /**
+     * @brief Voltage in [10 mV] and current in [mA] as written to the registers
+     */
+    uint16_t uwVoltage;
+    uint16_t uwCurrent;
+
+    /**
+     * @brief Time in [us] from the deadline until the write has been started
+     */
+    int32_t slLateness;
+
+    /**
+     * @brief Time in [us] from the deadline until the write has been acknowledged
+     */
+    int32_t slCompletion;
+
+    /**
+     * @brief Result of the write, see DPM86xx::writeFunction()
+     */
+    int32_t slResult;
+
+    /**
+     * @brief The step has not been written, because the next step was due already
+     */
+    bool btSkipped;
+  } Step_ts;
+
+  DPM86xxProfile();
+
+  /**
+   * @brief Calculate the steps of a profile
+   *
+   * @param[in] atsPointV points with increasing time
+   * @param[in] uwCountV number of points
+   * @param[in] ulRampStepV time in [ms] between two steps of a ramp
+   * @return number of steps, 0 if the profile does not fit into \c #DPM86XX_PROFILE_STEPS_MAX steps
+   *
+   * A ramp step is only created if it changes the register values, so slow ramps cause fewer transactions.
+   */
+  uint16_t load(const Point_ts atsPointV[], uint16_t uwCountV, uint32_t ulRampStepV = DPM86XX_PROFILE_RAMP_STEP);
+
+  /**
+   * @brief Start the profile now
+   *
+   * @param[in] clPsuR initialised PSU, no other transaction must be started on it while the profile runs
+   * @return \c false if no profile is loaded
+   */
+  bool start(DPM86xx &clPsuR);
+
+  /**
+   * @brief Stop the profile, a pending write is finished before
+   */
+  void stop();
+
+  /**
+   * @brief Write the steps that are due, this method never blocks
+   *
+   * @return \c true as long as the profile is running
+   *
+   * The time since start() is accumulated in 64 bit, so a profile may last longer than micros() needs to wrap
+   * around, as long as this method is called at least once in 70 minutes.
+   */
+  bool process();
+
+  /**
+   * @brief Run the profile until it is finished, the calling task sleeps until the next deadline
+   */
+  void run();
+
+  /**
+   * @brief Returns the number of steps of the loaded profile
+   */
+  uint16_t stepCount();
+
+  /**
+   * @brief Returns a step of the loaded profile
+   *
+   * @param[in] uwIndexV index in range from 0 to stepCount() - 1
+   */
+  const Step_ts &step(uint16_t uwIndexV);
+
+  /**
+   * @brief Returns the maximal lateness in [us] of all written steps
+   */
+  int32_t maxLateness();
+
+  /**
+   * @brief Returns the mean lateness in [us] of all written steps
+   */
+  int32_t meanLateness();
+
+  /**
+   * @brief Returns the number of steps that have been skipped
+   */
+  uint16_t skippedCount();
+
+  /**
+   * @brief Returns the number of writes that failed
+   */
+  uint16_t errorCount();
+
+private:
+  bool addStep(uint32_t ulTimeV, uint32_t ulMillivoltV, uint32_t ulMilliampereV);
+  uint64_t deadline(uint16_t uwIndexV);
+  uint64_t elapsed();
+
+  DPM86xx *pclPsuP;
+  Step_ts atsStepP[DPM86XX_PROFILE_STEPS_MAX];
+  uint16_t uwStepCountP;
+  uint16_t uwStepIndexP;
+  uint32_t ulLastTimeP;
+  uint64_t uqElapsedP;
+  bool btRunningP;
+  bool btPendingP;
+};
+
+#endif
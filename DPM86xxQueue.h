@@ -0,0 +1,110 @@
+//====================================================================================================================//
+// File:          DPM86xxQueue.h                                                                                      //
+// Description:   Lock-free multi-producer / single-consumer queue                                                    //
+// Author:        Tiderko                                                                                             //
+//--------------------------------------------------------------------------------------------------------------------//
+//                                                                                                                    //
+//====================================================================================================================//
+
+#ifndef DPM86xxQueue_h
+#define DPM86xxQueue_h
+
+#include <stdint.h>
+#include <atomic>
+
+/**
+ * @brief Bounded lock-free queue for any number of producer threads and exactly one consumer thread
+ *
+ * @tparam T type of the elements
+ * @tparam N number of elements, must be a power of two
+ *
+ * Each slot carries a sequence number, that tells whether it is free for the producer of a given position or
+ * filled for the consumer. Producers reserve a position with compare-and-swap on the head index, so they never
+ * block each other for longer than this single instruction. If the queue is full, push() fails and the element
+ * is discarded.
+ */
+template <typename T, uint32_t N> class DPM86xxQueue
+{
+  static_assert((N > 0) && ((N & (N - 1)) == 0), "Size of DPM86xxQueue must be a power of two");
+
+public:
+  DPM86xxQueue() : ulHeadP(0), ulTailP(0)
+  {
+    for (uint32_t ulIndexT = 0; ulIndexT < N; ulIndexT++)
+    {
+      atsSlotP[ulIndexT].ulSequence.store(ulIndexT, std::memory_order_relaxed);
+    }
+  }
+
+  /**
+   * @brief Append an element, may be called by any thread
+   * @return \c true on success, \c false if the queue is full
+   */
+  bool push(const T &tElementR)
+  {
+    uint32_t ulHeadT = ulHeadP.load(std::memory_order_relaxed);
+    Slot_ts *ptsSlotT;
+
+    for (;;)
+    {
+      ptsSlotT = &atsSlotP[ulHeadT & (N - 1)];
+      int32_t slDiffT = (int32_t)(ptsSlotT->ulSequence.load(std::memory_order_acquire) - ulHeadT);
+      if (slDiffT == 0)
+      {
+        if (ulHeadP.compare_exchange_weak(ulHeadT, ulHeadT + 1, std::memory_order_relaxed))
+        {
+          break;
+        }
+      }
+      else if (slDiffT < 0)
+      {
+        return false;
+      }
+      else
+      {
+        ulHeadT = ulHeadP.load(std::memory_order_relaxed);
+      }
+    }
+
+    ptsSlotT->tElement = tElementR;
+    ptsSlotT->ulSequence.store(ulHeadT + 1, std::memory_order_release);
+    return true;
+  }
+
+  /**
+   * @brief Remove the oldest element, must only be called by the consumer
+   * @return \c true on success, \c false if the queue is empty
+   */
+  bool pop(T &tElementR)
+  {
+    uint32_t ulTailT = ulTailP.load(std::memory_order_relaxed);
+    Slot_ts *ptsSlotT = &atsSlotP[ulTailT & (N - 1)];
+
+    if (ptsSlotT->ulSequence.load(std::memory_order_acquire) != (ulTailT + 1))
+    {
+      return false;
+    }
+    tElementR = ptsSlotT->tElement;
+    ptsSlotT->ulSequence.store(ulTailT + N, std::memory_order_release);
+    ulTailP.store(ulTailT + 1, std::memory_order_release);
+    return true;
+  }
+
+  /**
+   * @brief Returns the number of elements in the queue, including those that are being appended
+   */
+  uint32_t size() { return ulHeadP.load(std::memory_order_acquire) - ulTailP.load(std::memory_order_acquire); }
+
+private:
+  typedef struct Slot_s
+  {
+    std::atomic<uint32_t> ulSequence;
+    T tElement;
+  } Slot_ts;
+
+  Slot_ts atsSlotP[N];
+  std::atomic<uint32_t> ulHeadP;
+  std::atomic<uint32_t> ulTailP;
+};
+
+#endif
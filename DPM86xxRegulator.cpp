@@ -0,0 +1,326 @@
+//====================================================================================================================//
+// File:          DPM86xxRegulator.cpp                                                                                //
+// Description:   DPM86xxRegulator implementation                                                                     //
+// Author:        Tiderko                                                                                             //
+//--------------------------------------------------------------------------------------------------------------------//
+//                                                                                                                    //
+//====================================================================================================================//
+
+#include <DPM86xxRegulator.h>
+
+//--------------------------------------------------------------------------------------------------------------------//
+//                                                                                                                    //
+//                                                                                                                    //
+//--------------------------------------------------------------------------------------------------------------------//
+DPM86xxRegulator::DPM86xxRegulator()
+{
+  pclPsuP = nullptr;
+  teModeP = eMODE_POWER;
+  uwMaxVoltageP = 0;
+  uwCurrentLimitP = 0;
+  ulTargetP = 0;
+  ulMilliohmP = 0;
+  slProportionalP = 0;
+  slIntegralP = 0;
+  ulPeriodP = 0;
+  btRunningP = false;
+  uwSetpointP = 0;
+  uwVoltageP = 0;
+  uwCurrentP = 0;
+  resetLoopStats();
+}
+
+//--------------------------------------------------------------------------------------------------------------------//
+//                                                                                                                    //
+//                                                                                                                    //
+//--------------------------------------------------------------------------------------------------------------------//
+void DPM86xxRegulator::init(DPM86xx &clPsuR, uint32_t ulMaxMillivoltV, uint32_t ulMaxMilliampereV)
+{
+  pclPsuP = &clPsuR;
+  uwMaxVoltageP = DPM86xx::millivoltRegister(ulMaxMillivoltV);
+  uwCurrentLimitP = DPM86xx::milliampereRegister(ulMaxMilliampereV);
+  btRunningP = false;
+  resetLoopStats();
+}
+
+//--------------------------------------------------------------------------------------------------------------------//
+//                                                                                                                    //
+//                                                                                                                    //
+//--------------------------------------------------------------------------------------------------------------------//
+void DPM86xxRegulator::setGains(int32_t slProportionalV, int32_t slIntegralV)
+{
+  slProportionalP = slProportionalV;
+  slIntegralP = slIntegralV;
+}
+
+//--------------------------------------------------------------------------------------------------------------------//
+//                                                                                                                    //
+//                                                                                                                    //
+//--------------------------------------------------------------------------------------------------------------------//
+void DPM86xxRegulator::setPower(uint32_t ulMilliwattV)
+{
+  teModeP = eMODE_POWER;
+  ulTargetP = ulMilliwattV;
+}
+
+//--------------------------------------------------------------------------------------------------------------------//
+//                                                                                                                    //
+//                                                                                                                    //
+//--------------------------------------------------------------------------------------------------------------------//
+void DPM86xxRegulator::setLoadLine(uint32_t ulMillivoltV, uint32_t ulMilliohmV)
+{
+  teModeP = eMODE_LOAD_LINE;
+  ulTargetP = ulMillivoltV;
+  ulMilliohmP = ulMilliohmV;
+}
+
+//--------------------------------------------------------------------------------------------------------------------//
+//                                                                                                                    //
+//                                                                                                                    //
+//--------------------------------------------------------------------------------------------------------------------//
+void DPM86xxRegulator::setPeriod(uint32_t ulPeriodV)
+{
+  ulPeriodP = ulPeriodV;
+  ulNextCycleP = micros();
+}
+
+//--------------------------------------------------------------------------------------------------------------------//
+//                                                                                                                    //
+//                                                                                                                    //
+//--------------------------------------------------------------------------------------------------------------------//
+int32_t DPM86xxRegulator::deviation()
+{
+  int64_t sqTargetT;
+
+  //---------------------------------------------------------------------------------------------------
+  // power in [mW] is given by [10 mV] * [mA] / 100, the load line voltage in [10 mV] by
+  // ([mV] - [mOhm] * [mA] / 1000) / 10
+  //
+  if (teModeP == eMODE_POWER)
+  {
+    return (int32_t)ulTargetP - (int32_t)measuredMilliwatt();
+  }
+
+  sqTargetT = ((int64_t)ulTargetP - (((int64_t)ulMilliohmP * uwCurrentP) / 1000)) / 10;
+  if (sqTargetT < 0)
+  {
+    sqTargetT = 0;
+  }
+  return (int32_t)sqTargetT - (int32_t)uwVoltageP;
+}
+
+//--------------------------------------------------------------------------------------------------------------------//
+//                                                                                                                    //
+//                                                                                                                    //
+//--------------------------------------------------------------------------------------------------------------------//
+int32_t DPM86xxRegulator::process()
+{
+  DPM86xx::Snapshot_ts tsSnapshotT;
+  uint32_t ulTimeT;
+  uint32_t ulElapsedT;
+  int32_t slDeviationT;
+  int64_t sqOutputT;
+  int64_t sqLimitT = (int64_t)uwMaxVoltageP << DPM86XX_REGULATOR_SHIFT;
+  int32_t slResultT;
+
+  if (pclPsuP == nullptr)
+  {
+    return DPM86xx::eSTATUS_BUSY;
+  }
+
+  //---------------------------------------------------------------------------------------------------
+  // wait for the start of the cycle, the next one is planned from the deadline, so the period does
+  // not drift
+  //
+  if (ulPeriodP > 0)
+  {
+    int32_t slWaitT = (int32_t)(ulNextCycleP - (uint32_t)micros());
+    if (slWaitT >= 2000)
+    {
+      delay((uint32_t)(slWaitT / 1000) - 1);
+      slWaitT = (int32_t)(ulNextCycleP - (uint32_t)micros());
+    }
+    if (slWaitT > 0)
+    {
+      delayMicroseconds((uint32_t)slWaitT);
+    }
+  }
+  ulTimeT = micros();
+
+  //---------------------------------------------------------------------------------------------------
+  // loop timing, the first cycle after resetLoopStats() has no period
+  //
+  ulElapsedT = btRunningP ? (ulTimeT - ulLastCycleP) : 0;
+  if (btRunningP && (tsLoopStatsP.ulCycles > 0))
+  {
+    uqPeriodSumP += ulElapsedT;
+    ulPeriodsP++;
+    if (ulElapsedT < tsLoopStatsP.ulMinPeriod)
+    {
+      tsLoopStatsP.ulMinPeriod = ulElapsedT;
+    }
+    if (ulElapsedT > tsLoopStatsP.ulMaxPeriod)
+    {
+      tsLoopStatsP.ulMaxPeriod = ulElapsedT;
+    }
+  }
+  if (ulPeriodP > 0)
+  {
+    if ((int32_t)(ulTimeT - ulNextCycleP) >= (int32_t)ulPeriodP)
+    {
+      tsLoopStatsP.ulOverruns++;
+      ulNextCycleP = ulTimeT;
+    }
+    ulNextCycleP += ulPeriodP;
+  }
+  ulLastCycleP = ulTimeT;
+
+  //---------------------------------------------------------------------------------------------------
+  // a pause of the loop is not integrated as a whole, the time of one cycle is limited to the period
+  // or to DPM86XX_REGULATOR_GAP_MAX, so the integral does not jump or overflow
+  //
+  if (ulPeriodP > 0)
+  {
+    if (ulElapsedT > ulPeriodP)
+    {
+      ulElapsedT = ulPeriodP;
+    }
+  }
+  else if (ulElapsedT > DPM86XX_REGULATOR_GAP_MAX)
+  {
+    tsLoopStatsP.ulOverruns++;
+    ulElapsedT = DPM86XX_REGULATOR_GAP_MAX;
+  }
+
+  //---------------------------------------------------------------------------------------------------
+  // read the measured values
+  //
+  slResultT = pclPsuP->readSnapshot(tsSnapshotT, DPM86xx::eSNAP_VOLTAGE | DPM86xx::eSNAP_CURRENT);
+  if (slResultT < 0)
+  {
+    tsLoopStatsP.ulErrors++;
+    tsLoopStatsP.ulCycles++;
+    return slResultT;
+  }
+  uwVoltageP = tsSnapshotT.uwVoltage;
+  uwCurrentP = tsSnapshotT.uwCurrent;
+
+  //---------------------------------------------------------------------------------------------------
+  // the first cycle starts the integral at the measured voltage, so the output does not jump
+  //
+  if (btRunningP == false)
+  {
+    sqIntegralP = (int64_t)uwVoltageP << DPM86XX_REGULATOR_SHIFT;
+    btRunningP = true;
+  }
+
+  //---------------------------------------------------------------------------------------------------
+  // PI controller, the integral is limited to the range of the setpoint, and it is not increased while
+  // the output is limited by the current setpoint, because a higher voltage does not change the output
+  // then, so the integral does not wind up
+  //
+  slDeviationT = deviation();
+  if ((slDeviationT < 0) || (uwCurrentP < uwCurrentLimitP))
+  {
+    sqIntegralP += ((int64_t)slIntegralP * slDeviationT * ulElapsedT) / 1000000;
+  }
+  if (sqIntegralP < 0)
+  {
+    sqIntegralP = 0;
+  }
+  if (sqIntegralP > sqLimitT)
+  {
+    sqIntegralP = sqLimitT;
+  }
+
+  sqOutputT = sqIntegralP + ((int64_t)slProportionalP * slDeviationT);
+  if (sqOutputT < 0)
+  {
+    sqOutputT = 0;
+  }
+  if (sqOutputT > sqLimitT)
+  {
+    sqOutputT = sqLimitT;
+  }
+  uwSetpointP = (uint16_t)((sqOutputT + (1 << (DPM86XX_REGULATOR_SHIFT - 1))) >> DPM86XX_REGULATOR_SHIFT);
+
+  //---------------------------------------------------------------------------------------------------
+  // write the setpoints, merged into one request if both have changed
+  //
+  pclPsuP->stageVoltage(uwSetpointP);
+  pclPsuP->stageCurrent(uwCurrentLimitP);
+  slResultT = pclPsuP->commitSetpoints();
+
+  tsLoopStatsP.ulCycles++;
+  if (slResultT < 0)
+  {
+    tsLoopStatsP.ulErrors++;
+    return slResultT;
+  }
+
+  return DPM86xx::eSTATUS_OK;
+}
+
+//--------------------------------------------------------------------------------------------------------------------//
+//                                                                                                                    //
+//                                                                                                                    //
+//--------------------------------------------------------------------------------------------------------------------//
+uint32_t DPM86xxRegulator::measuredMilliwatt()
+{
+  return ((uint32_t)uwVoltageP * uwCurrentP) / 100;
+}
+
+//--------------------------------------------------------------------------------------------------------------------//
+//                                                                                                                    //
+//                                                                                                                    //
+//--------------------------------------------------------------------------------------------------------------------//
+uint16_t DPM86xxRegulator::measuredVoltage()
+{
+  return uwVoltageP;
+}
+
+//--------------------------------------------------------------------------------------------------------------------//
+//                                                                                                                    //
+//                                                                                                                    //
+//--------------------------------------------------------------------------------------------------------------------//
+uint16_t DPM86xxRegulator::voltageSetpoint()
+{
+  return uwSetpointP;
+}
+
+//--------------------------------------------------------------------------------------------------------------------//
+//                                                                                                                    //
+//                                                                                                                    //
+//--------------------------------------------------------------------------------------------------------------------//
+DPM86xxRegulator::LoopStats_ts DPM86xxRegulator::loopStats()
+{
+  LoopStats_ts tsStatsT = tsLoopStatsP;
+
+  if (ulPeriodsP > 0)
+  {
+    tsStatsT.ulMeanPeriod = (uint32_t)(uqPeriodSumP / ulPeriodsP);
+  }
+  else
+  {
+    tsStatsT.ulMinPeriod = 0;
+  }
+
+  return tsStatsT;
+}
+
+//--------------------------------------------------------------------------------------------------------------------//
+//                                                                                                                    //
+//                                                                                                                    //
+//--------------------------------------------------------------------------------------------------------------------//
+void DPM86xxRegulator::resetLoopStats()
+{
+  tsLoopStatsP.ulCycles = 0;
+  tsLoopStatsP.ulOverruns = 0;
+  tsLoopStatsP.ulErrors = 0;
+  tsLoopStatsP.ulMinPeriod = 0xFFFFFFFF;
+  tsLoopStatsP.ulMeanPeriod = 0;
+  tsLoopStatsP.ulMaxPeriod = 0;
+  uqPeriodSumP = 0;
+  ulPeriodsP = 0;
+  ulNextCycleP = micros();
+}
@@ -0,0 +1,204 @@
+//====================================================================================================================//
+// File:          DPM86xxRegulator.h                                                                                  //
+// Description:   DPM86xxRegulator Class definition, constant power and load line regulation by a PI controller       //
+// Author:        Tiderko                                                                                             //
+//--------------------------------------------------------------------------------------------------------------------//
+//                                                                                                                    //
+//====================================================================================================================//
+
+#ifndef DPM86xxRegulator_h
+#define DPM86xxRegulator_h
+
+#include "DPM86xx.h"
+
+/**
+ * @brief Number of fractional bits of the controller gains, see DPM86xxRegulator::setGains()
+ *
+ */
+#define DPM86XX_REGULATOR_SHIFT 16
+
+/**
+ * @brief Maximal time in [us] that is integrated by one cycle, if no period is given by
+ * DPM86xxRegulator::setPeriod()
+ *
+ */
+#ifndef DPM86XX_REGULATOR_GAP_MAX
+#define DPM86XX_REGULATOR_GAP_MAX 100000
+#endif
+
+/**
+ * @brief Regulates output power or a load line by the voltage setpoint of a PSU
+ *
+ * The PSU only provides constant voltage and constant current. Each cycle of the control loop reads measured voltage
+ * and current, calculates the deviation from the target and updates the voltage setpoint by a PI controller. The
+ * current setpoint is kept at the current limit. Setpoints are written by DPM86xx::commitSetpoints(), so a cycle
+ * without change of the setpoint needs no write.
+ *
+ * All calculations are done in fixed point, the voltage setpoint is given in [10 mV] like the register of the PSU.
+ */
+class DPM86xxRegulator
+{
+public:
+  /**
+   * @brief Controlled value
+   */
+  typedef enum Mode_e
+  {
+    /**
+     * @brief Output power given by setPower(), deviation in [mW]
+     */
+    eMODE_POWER = 0,
+
+    /**
+     * @brief Output voltage that drops with the current, given by setLoadLine(), deviation in [10 mV]
+     */
+    eMODE_LOAD_LINE
+  } Mode_te;
+
+  /**
+   * @brief Timing of the control loop, returned by loopStats()
+   */
+  typedef struct LoopStats_s
+  {
+    /**
+     * @brief Number of cycles that have been finished
+     */
+    uint32_t ulCycles;
+
+    /**
+     * @brief Number of cycles that took longer than the period given by setPeriod()
+     *
+     * Without a period, cycles that took longer than \c #DPM86XX_REGULATOR_GAP_MAX are counted. The integral of
+     * such a cycle only covers the period or \c #DPM86XX_REGULATOR_GAP_MAX, so a pause of the loop does not
+     * make it jump.
+     */
+    uint32_t ulOverruns;
+
+    /**
+     * @brief Number of cycles that failed because of a transaction error
+     */
+    uint32_t ulErrors;
+
+    /**
+     * @brief Time in [us] between the start of two cycles
+     */
+    uint32_t ulMinPeriod;
+    uint32_t ulMeanPeriod;
+    uint32_t ulMaxPeriod;
+  } LoopStats_ts;
+
+  DPM86xxRegulator();
+
+  /**
+   * @brief Initialisation of the regulator
+   *
+   * @param[in] clPsuR initialised PSU, no other transaction must be started on it while the regulator runs
+   * @param[in] ulMaxMillivoltV maximal voltage setpoint in [mV]
+   * @param[in] ulMaxMilliampereV current setpoint in [mA], that limits the output current
+   *
+   * The integral of the PI controller is not increased while the measured current is at the current setpoint.
+   */
+  void init(DPM86xx &clPsuR, uint32_t ulMaxMillivoltV, uint32_t ulMaxMilliampereV);
+
+  /**
+   * @brief Set the gains of the PI controller
+   *
+   * @param[in] slProportionalV change of the voltage setpoint in [10 mV] per unit of the deviation, scaled by
+   *            2^\c #DPM86XX_REGULATOR_SHIFT
+   * @param[in] slIntegralV change of the voltage setpoint in [10 mV] per unit of the deviation and second, scaled by
+   *            2^\c #DPM86XX_REGULATOR_SHIFT
+   *
+   * The unit of the deviation depends on the mode, see \c #Mode_e.
+   */
+  void setGains(int32_t slProportionalV, int32_t slIntegralV);
+
+  /**
+   * @brief Regulate the output power
+   *
+   * @param[in] ulMilliwattV target power in [mW]
+   */
+  void setPower(uint32_t ulMilliwattV);
+
+  /**
+   * @brief Regulate the output voltage along a load line
+   *
+   * @param[in] ulMillivoltV target voltage in [mV] without load
+   * @param[in] ulMilliohmV resistance in [mOhm], the target voltage drops by this value times the current
+   */
+  void setLoadLine(uint32_t ulMillivoltV, uint32_t ulMilliohmV);
+
+  /**
+   * @brief Set the period of the control loop
+   *
+   * @param[in] ulPeriodV time in [us] between the start of two cycles, 0 runs the loop as fast as the bus allows
+   */
+  void setPeriod(uint32_t ulPeriodV);
+
+  /**
+   * @brief Run one cycle of the control loop
+   *
+   * @return On success \c #DPM86xx::eSTATUS_OK is returned. On failure, a negative value of \c #DPM86xx::Status_e
+   *         is returned and the setpoint is not changed.
+   *
+   * If a period is given, the method waits for the start of the next cycle before.
+   */
+  int32_t process();
+
+  /**
+   * @brief Returns the measured power in [mW] of the last cycle
+   */
+  uint32_t measuredMilliwatt();
+
+  /**
+   * @brief Returns the measured voltage in [10 mV] of the last cycle
+   */
+  uint16_t measuredVoltage();
+
+  /**
+   * @brief Returns the voltage setpoint in [10 mV] written by the last cycle
+   */
+  uint16_t voltageSetpoint();
+
+  /**
+   * @brief Returns the timing of the control loop
+   */
+  LoopStats_ts loopStats();
+
+  /**
+   * @brief Clear the timing of the control loop
+   */
+  void resetLoopStats();
+
+private:
+  int32_t deviation();
+
+  DPM86xx *pclPsuP;
+  Mode_te teModeP;
+  uint16_t uwMaxVoltageP;
+  uint16_t uwCurrentLimitP;
+  uint32_t ulTargetP;
+  uint32_t ulMilliohmP;
+  int32_t slProportionalP;
+  int32_t slIntegralP;
+
+  //---------------------------------------------------------------------------------------------------
+  // controller state, the integral is given in [10 mV] scaled by 2^DPM86XX_REGULATOR_SHIFT
+  //
+  int64_t sqIntegralP;
+  uint16_t uwSetpointP;
+  uint16_t uwVoltageP;
+  uint16_t uwCurrentP;
+  uint32_t ulLastCycleP;
+  bool btRunningP;
+
+  //---------------------------------------------------------------------------------------------------
+  // timing of the control loop
+  //
+  uint32_t ulPeriodP;
+  uint32_t ulNextCycleP;
+  uint64_t uqPeriodSumP;
+  uint32_t ulPeriodsP;
+  LoopStats_ts tsLoopStatsP;
+};
+
+#endif
@@ -0,0 +1,74 @@
+//====================================================================================================================//
+// File:          DPM86xxRing.h                                                                                       //
+// Description:   Lock-free single-producer / single-consumer ring buffer                                             //
+// Author:        Tiderko                                                                                             //
+//--------------------------------------------------------------------------------------------------------------------//
+//                                                                                                                    //
+//====================================================================================================================//
+
+#ifndef DPM86xxRing_h
+#define DPM86xxRing_h
+
+#include <stdint.h>
+#include <atomic>
+
+/**
+ * @brief Lock-free ring buffer for exactly one producer and one consumer thread
+ *
+ * @tparam T type of the elements
+ * @tparam N number of elements, must be a power of two
+ *
+ * The producer only writes the head index and the consumer only writes the tail index, so neither of them ever
+ * waits for the other one. If the ring is full, push() fails and the element is discarded.
+ */
+template <typename T, uint32_t N> class DPM86xxRing
+{
+  static_assert((N > 0) && ((N & (N - 1)) == 0), "Size of DPM86xxRing must be a power of two");
+
+public:
+  DPM86xxRing() : ulHeadP(0), ulTailP(0) {}
+
+  /**
+   * @brief Append an element, must only be called by the producer
+   * @return \c true on success, \c false if the ring is full
+   */
+  bool push(const T &tElementR)
+  {
+    uint32_t ulHeadT = ulHeadP.load(std::memory_order_relaxed);
+    if ((ulHeadT - ulTailP.load(std::memory_order_acquire)) >= N)
+    {
+      return false;
+    }
+    atElementP[ulHeadT & (N - 1)] = tElementR;
+    ulHeadP.store(ulHeadT + 1, std::memory_order_release);
+    return true;
+  }
+
+  /**
+   * @brief Remove the oldest element, must only be called by the consumer
+   * @return \c true on success, \c false if the ring is empty
+   */
+  bool pop(T &tElementR)
+  {
+    uint32_t ulTailT = ulTailP.load(std::memory_order_relaxed);
+    if (ulTailT == ulHeadP.load(std::memory_order_acquire))
+    {
+      return false;
+    }
+    tElementR = atElementP[ulTailT & (N - 1)];
+    ulTailP.store(ulTailT + 1, std::memory_order_release);
+    return true;
+  }
+
+  /**
+   * @brief Returns the number of elements in the ring
+   */
+  uint32_t size() { return ulHeadP.load(std::memory_order_acquire) - ulTailP.load(std::memory_order_acquire); }
+
+private:
+  T atElementP[N];
+  std::atomic<uint32_t> ulHeadP;
+  std::atomic<uint32_t> ulTailP;
+};
+
+#endif
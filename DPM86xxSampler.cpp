@@ -0,0 +1,188 @@
+//====================================================================================================================//
+// File:          DPM86xxSampler.cpp                                                                                  //
+// Description:   DPM86xxSampler implementation                                                                       //
+// Author:        Tiderko                                                                                             //
+//--------------------------------------------------------------------------------------------------------------------//
+//                                                                                                                    //
+//====================================================================================================================//
+
+#include <DPM86xxSampler.h>
+
+#if defined(ESP32) || !defined(ARDUINO)
+
+//--------------------------------------------------------------------------------------------------------------------//
+//                                                                                                                    //
+//                                                                                                                    //
+//--------------------------------------------------------------------------------------------------------------------//
+DPM86xxSampler::DPM86xxSampler()
+{
+  pclPsuP = nullptr;
+  btRunP = false;
+  btActiveP = false;
+  ulSampleCountP = 0;
+  ulDroppedCountP = 0;
+  ulErrorCountP = 0;
+}
+
+//--------------------------------------------------------------------------------------------------------------------//
+//                                                                                                                    //
+//                                                                                                                    //
+//--------------------------------------------------------------------------------------------------------------------//
+DPM86xxSampler::~DPM86xxSampler()
+{
+  stop();
+}
+
+//--------------------------------------------------------------------------------------------------------------------//
+//                                                                                                                    //
+//                                                                                                                    //
+//--------------------------------------------------------------------------------------------------------------------//
+bool DPM86xxSampler::start(DPM86xx &clPsuR, uint32_t ulPeriodV, uint8_t ubFieldsV)
+{
+  if (btActiveP)
+  {
+    return false;
+  }
+
+  pclPsuP = &clPsuR;
+  ulPeriodP = ulPeriodV;
+  ubFieldsP = ubFieldsV;
+  btRunP = true;
+  btActiveP = true;
+
+  //---------------------------------------------------------------------------------------------------
+  // create the background task
+  //
+#ifdef ARDUINO
+  if (xTaskCreate(task, "DPM86xxSampler", DPM86XX_SAMPLER_STACK, this, 1, &pvTaskP) != pdPASS)
+  {
+    btRunP = false;
+    btActiveP = false;
+    return false;
+  }
+#else
+  clThreadP = std::thread(task, this);
+#endif
+
+  return true;
+}
+
+//--------------------------------------------------------------------------------------------------------------------//
+//                                                                                                                    //
+//                                                                                                                    //
+//--------------------------------------------------------------------------------------------------------------------//
+void DPM86xxSampler::stop()
+{
+  btRunP = false;
+
+#ifdef ARDUINO
+  while (btActiveP)
+  {
+    delay(1);
+  }
+#else
+  if (clThreadP.joinable())
+  {
+    clThreadP.join();
+  }
+#endif
+}
+
+//--------------------------------------------------------------------------------------------------------------------//
+//                                                                                                                    //
+//                                                                                                                    //
+//--------------------------------------------------------------------------------------------------------------------//
+bool DPM86xxSampler::pop(DPM86xx::Snapshot_ts &tsSnapshotR)
+{
+  return clRingP.pop(tsSnapshotR);
+}
+
+//--------------------------------------------------------------------------------------------------------------------//
+//                                                                                                                    //
+//                                                                                                                    //
+//--------------------------------------------------------------------------------------------------------------------//
+uint32_t DPM86xxSampler::sampleCount()
+{
+  return ulSampleCountP;
+}
+
+//--------------------------------------------------------------------------------------------------------------------//
+//                                                                                                                    //
+//                                                                                                                    //
+//--------------------------------------------------------------------------------------------------------------------//
+uint32_t DPM86xxSampler::droppedCount()
+{
+  return ulDroppedCountP;
+}
+
+//--------------------------------------------------------------------------------------------------------------------//
+//                                                                                                                    //
+//                                                                                                                    //
+//--------------------------------------------------------------------------------------------------------------------//
+uint32_t DPM86xxSampler::errorCount()
+{
+  return ulErrorCountP;
+}
+
+//--------------------------------------------------------------------------------------------------------------------//
+//                                                                                                                    //
+//                                                                                                                    //
+//--------------------------------------------------------------------------------------------------------------------//
+void DPM86xxSampler::task(void *pvParameterV)
+{
+  static_cast<DPM86xxSampler *>(pvParameterV)->run();
+
+#ifdef ARDUINO
+  vTaskDelete(nullptr);
+#endif
+}
+
+//--------------------------------------------------------------------------------------------------------------------//
+//                                                                                                                    //
+//                                                                                                                    //
+//--------------------------------------------------------------------------------------------------------------------//
+void DPM86xxSampler::run()
+{
+  DPM86xx::Snapshot_ts tsSnapshotT;
+  uint32_t ulNextT = millis();
+  int32_t slWaitT;
+
+  while (btRunP)
+  {
+    //-------------------------------------------------------------------------------------------
+    // read the sample and pass it to the application
+    //
+    if (pclPsuP->readSnapshot(tsSnapshotT, ubFieldsP) == DPM86xx::eSTATUS_OK)
+    {
+      ulSampleCountP++;
+      if (clRingP.push(tsSnapshotT) != true)
+      {
+        ulDroppedCountP++;
+      }
+    }
+    else
+    {
+      ulErrorCountP++;
+    }
+
+    //-------------------------------------------------------------------------------------------
+    // samples are started on absolute times, so the period does not drift with the duration of
+    // the transactions. If a sample took too long, the next one starts immediately.
+    //
+    ulNextT += ulPeriodP;
+    slWaitT = (int32_t)(ulNextT - (uint32_t)millis());
+    if (slWaitT > 0)
+    {
+      delay((uint32_t)slWaitT);
+    }
+    else
+    {
+      ulNextT = millis();
+      yield();
+    }
+  }
+
+  btActiveP = false;
+}
+
+#endif
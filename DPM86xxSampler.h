@@ -0,0 +1,117 @@
+//====================================================================================================================//
+// File:          DPM86xxSampler.h                                                                                    //
+// Description:   DPM86xxSampler Class definition, background sampling of measured values                            //
+// Author:        Tiderko                                                                                             //
+//--------------------------------------------------------------------------------------------------------------------//
+//                                                                                                                    //
+//====================================================================================================================//
+
+#ifndef DPM86xxSampler_h
+#define DPM86xxSampler_h
+
+#include "DPM86xx.h"
+
+#if defined(ESP32) || !defined(ARDUINO)
+
+#include "DPM86xxRing.h"
+
+#ifdef ARDUINO
+#include <freertos/FreeRTOS.h>
+#include <freertos/task.h>
+#else
+#include <thread>
+#endif
+
+/**
+ * @brief Number of samples that can be buffered until they are taken by the application, power of two
+ *
+ */
+#ifndef DPM86XX_SAMPLER_DEPTH
+#define DPM86XX_SAMPLER_DEPTH 32
+#endif
+
+/**
+ * @brief Stack size in [byte] of the sampling task on ESP32
+ *
+ */
+#ifndef DPM86XX_SAMPLER_STACK
+#define DPM86XX_SAMPLER_STACK 4096
+#endif
+
+/**
+ * @brief Reads measured values of a PSU periodically in a background task
+ *
+ * The samples are passed to the application by a lock-free ring buffer, so the application never waits for the
+ * serial interface. On ESP32 a FreeRTOS task is used, on a host a \c std::thread.
+ *
+ * While the sampler is running, no other transaction must be started on the PSU object.
+ */
+class DPM86xxSampler
+{
+public:
+  DPM86xxSampler();
+  ~DPM86xxSampler();
+
+  /**
+   * @brief Start sampling
+   *
+   * @param[in] clPsuR initialised PSU that should be sampled
+   * @param[in] ulPeriodV time in [ms] between the start of two samples
+   * @param[in] ubFieldsV combination of \c #DPM86xx::SnapshotField_e values that should be read
+   * @return \c true on success, \c false if sampler is already running or the task could not be created
+   */
+  bool start(DPM86xx &clPsuR, uint32_t ulPeriodV, uint8_t ubFieldsV = DPM86xx::eSNAP_ALL);
+
+  /**
+   * @brief Stop sampling and wait until the background task has finished
+   */
+  void stop();
+
+  /**
+   * @brief Take the oldest sample, this method never blocks
+   *
+   * @param[out] tsSnapshotR sample
+   * @return \c true if a sample has been taken, \c false if no sample is available
+   */
+  bool pop(DPM86xx::Snapshot_ts &tsSnapshotR);
+
+  /**
+   * @brief Returns the number of samples that have been read successfully
+   */
+  uint32_t sampleCount();
+
+  /**
+   * @brief Returns the number of samples that have been discarded, because the ring buffer was full
+   */
+  uint32_t droppedCount();
+
+  /**
+   * @brief Returns the number of samples that could not be read
+   */
+  uint32_t errorCount();
+
+private:
+  static void task(void *pvParameterV);
+  void run();
+
+  DPM86xx *pclPsuP;
+  uint32_t ulPeriodP;
+  uint8_t ubFieldsP;
+
+  DPM86xxRing<DPM86xx::Snapshot_ts, DPM86XX_SAMPLER_DEPTH> clRingP;
+  std::atomic<bool> btRunP;
+  std::atomic<bool> btActiveP;
+  std::atomic<uint32_t> ulSampleCountP;
+  std::atomic<uint32_t> ulDroppedCountP;
+  std::atomic<uint32_t> ulErrorCountP;
+
+#ifdef ARDUINO
+  TaskHandle_t pvTaskP;
+#else
+  std::thread clThreadP;
+#endif
+};
+
+#endif
+
+#endif
@@ -0,0 +1,702 @@
+//====================================================================================================================//
+// File:          DPM86xxSim.cpp                                                                                      //
+// Description:   Simulated bus with DPM86xx PSUs implementation                                                      //
+// Author:        Tiderko                                                                                             //
+//--------------------------------------------------------------------------------------------------------------------//
+//                                                                                                                    //
+//====================================================================================================================//
+
+#include <DPM86xxSim.h>
+#include <math.h>
+#include <stdio.h>
+
+//--------------------------------------------------------------------------------------------------------------------//
+//                                                                                                                    //
+//                                                                                                                    //
+//--------------------------------------------------------------------------------------------------------------------//
+DPM86xxSim::DPM86xxSim()
+{
+  init(9600);
+}
+
+//--------------------------------------------------------------------------------------------------------------------//
+//                                                                                                                    //
+//                                                                                                                    //
+//--------------------------------------------------------------------------------------------------------------------//
+void DPM86xxSim::init(uint32_t ulBaudRateV, uint32_t ulTurnaroundV)
+{
+  //---------------------------------------------------------------------------------------------------
+  // one byte is transmitted with 10 bits: start bit, 8 data bits and stop bit
+  //
+  ulBaudRateP = ulBaudRateV;
+  ulByteTimeP = (uint32_t)((1000000UL * 10UL) / ulBaudRateV);
+  ulTurnaroundP = ulTurnaroundV;
+  ulLineFreeP = micros();
+
+  ubDeviceCountP = 0;
+  ubRequestLengthP = 0;
+  ubResponseLengthP = 0;
+  ubResponseReadP = 0;
+  ulResponseStartP = ulLineFreeP;
+  ulResponseCountP = 0;
+  btModbusP = false;
+}
+
+//--------------------------------------------------------------------------------------------------------------------//
+//                                                                                                                    //
+//                                                                                                                    //
+//--------------------------------------------------------------------------------------------------------------------//
+bool DPM86xxSim::addDevice(uint8_t ubAddressV, uint16_t uwModelV)
+{
+  Device_ts *ptsDeviceT;
+
+  if ((ubDeviceCountP >= DPM86XX_SIM_DEVICES_MAX) || (ubAddressV < 1) || (ubAddressV > 99) ||
+      (device(ubAddressV) != nullptr))
+  {
+    return false;
+  }
+
+  //---------------------------------------------------------------------------------------------------
+  // the last two digits of the model number give the maximal current in [A]
+  //
+  if ((uwModelV != 8605) && (uwModelV != 8608) && (uwModelV != 8616) && (uwModelV != 8624))
+  {
+    return false;
+  }
+
+  ptsDeviceT = &atsDeviceP[ubDeviceCountP++];
+  ptsDeviceT->ubAddress = ubAddressV;
+  ptsDeviceT->uwMaxCurrent = (uint16_t)((uwModelV % 100) * 1000);
+  ptsDeviceT->uwSetVoltage = 0;
+  ptsDeviceT->uwSetCurrent = 0;
+  ptsDeviceT->uwOutput = 0;
+  ptsDeviceT->ulLoad = DPM86XX_SIM_LOAD;
+  ptsDeviceT->ulSettling = DPM86XX_SIM_SETTLING * 1000;
+  ptsDeviceT->ftVoltage = 0.0f;
+  ptsDeviceT->ftCurrent = 0.0f;
+  ptsDeviceT->ulOutputTime = micros();
+
+  return true;
+}
+
+//--------------------------------------------------------------------------------------------------------------------//
+//                                                                                                                    //
+//                                                                                                                    //
+//--------------------------------------------------------------------------------------------------------------------//
+void DPM86xxSim::setLoad(uint8_t ubAddressV, uint32_t ulLoadV)
+{
+  Device_ts *ptsDeviceT = device(ubAddressV);
+  if (ptsDeviceT != nullptr)
+  {
+    settle(ptsDeviceT);
+    ptsDeviceT->ulLoad = ulLoadV;
+  }
+}
+
+//--------------------------------------------------------------------------------------------------------------------//
+//                                                                                                                    //
+//                                                                                                                    //
+//--------------------------------------------------------------------------------------------------------------------//
+void DPM86xxSim::setSettling(uint8_t ubAddressV, uint32_t ulTimeConstantV)
+{
+  Device_ts *ptsDeviceT = device(ubAddressV);
+  if (ptsDeviceT != nullptr)
+  {
+    settle(ptsDeviceT);
+    ptsDeviceT->ulSettling = ulTimeConstantV * 1000;
+  }
+}
+
+//--------------------------------------------------------------------------------------------------------------------//
+//                                                                                                                    //
+//                                                                                                                    //
+//--------------------------------------------------------------------------------------------------------------------//
+void DPM86xxSim::setModbus(bool btEnableV)
+{
+  btModbusP = btEnableV;
+  ubRequestLengthP = 0;
+}
+
+//--------------------------------------------------------------------------------------------------------------------//
+//                                                                                                                    //
+//                                                                                                                    //
+//--------------------------------------------------------------------------------------------------------------------//
+uint32_t DPM86xxSim::responseCount()
+{
+  return ulResponseCountP;
+}
+
+//--------------------------------------------------------------------------------------------------------------------//
+//                                                                                                                    //
+//                                                                                                                    //
+//--------------------------------------------------------------------------------------------------------------------//
+DPM86xxSim::Device_ts *DPM86xxSim::device(uint8_t ubAddressV)
+{
+  for (uint8_t ubIndexT = 0; ubIndexT < ubDeviceCountP; ubIndexT++)
+  {
+    if (atsDeviceP[ubIndexT].ubAddress == ubAddressV)
+    {
+      return &atsDeviceP[ubIndexT];
+    }
+  }
+  return nullptr;
+}
+
+//--------------------------------------------------------------------------------------------------------------------//
+//                                                                                                                    //
+//                                                                                                                    //
+//--------------------------------------------------------------------------------------------------------------------//
+int32_t DPM86xxSim::available()
+{
+  int32_t slElapsedT = (int32_t)((uint32_t)micros() - ulResponseStartP);
+  uint32_t ulReceivedT;
+
+  if ((ubResponseReadP >= ubResponseLengthP) || (slElapsedT < 0))
+  {
+    return 0;
+  }
+
+  //---------------------------------------------------------------------------------------------------
+  // a byte is available once it has been completely transmitted
+  //
+  ulReceivedT = (uint32_t)slElapsedT / ulByteTimeP;
+  if (ulReceivedT > ubResponseLengthP)
+  {
+    ulReceivedT = ubResponseLengthP;
+  }
+  if (ulReceivedT <= ubResponseReadP)
+  {
+    return 0;
+  }
+
+  return (int32_t)(ulReceivedT - ubResponseReadP);
+}
+
+//--------------------------------------------------------------------------------------------------------------------//
+//                                                                                                                    //
+//                                                                                                                    //
+//--------------------------------------------------------------------------------------------------------------------//
+int32_t DPM86xxSim::read()
+{
+  if (available() <= 0)
+  {
+    return -1;
+  }
+  return (int32_t)(uint8_t)aszResponseP[ubResponseReadP++];
+}
+
+//--------------------------------------------------------------------------------------------------------------------//
+//                                                                                                                    //
+//                                                                                                                    //
+//--------------------------------------------------------------------------------------------------------------------//
+size_t DPM86xxSim::write(const uint8_t *pubDataV, size_t ulSizeV)
+{
+  uint32_t ulNowT = micros();
+  uint8_t ubLengthT;
+
+  //---------------------------------------------------------------------------------------------------
+  // a Modbus frame is terminated by a silence of 3.5 characters, so older bytes are discarded
+  //
+  if (btModbusP && ((int32_t)(ulNowT - ulLineFreeP) > (int32_t)((ulByteTimeP * 35) / 10)))
+  {
+    ubRequestLengthP = 0;
+  }
+
+  //---------------------------------------------------------------------------------------------------
+  // the written bytes occupy the line after the bytes that are still in transmission
+  //
+  if ((int32_t)(ulLineFreeP - ulNowT) < 0)
+  {
+    ulLineFreeP = ulNowT;
+  }
+  ulLineFreeP += (uint32_t)ulSizeV * ulByteTimeP;
+
+  for (size_t ulIndexT = 0; ulIndexT < ulSizeV; ulIndexT++)
+  {
+    //-------------------------------------------------------------------------------------------
+    // a Modbus request is complete when the length derived from the function code is reached
+    //
+    if (btModbusP)
+    {
+      aszRequestP[ubRequestLengthP++] = (char)pubDataV[ulIndexT];
+      ubLengthT = DPM86xxModbus::requestLength((const uint8_t *)aszRequestP, ubRequestLengthP);
+      if ((ubLengthT > 0) && (ubRequestLengthP >= ubLengthT))
+      {
+        processModbusRequest();
+        ubRequestLengthP = 0;
+      }
+      else if (ubRequestLengthP >= DPM86XX_SIM_FRAME_MAX)
+      {
+        ubRequestLengthP = 0;
+      }
+      continue;
+    }
+
+    //-------------------------------------------------------------------------------------------
+    // a new frame starts with ':', bytes that do not fit into the buffer are dropped
+    //
+    if (pubDataV[ulIndexT] == ':')
+    {
+      ubRequestLengthP = 0;
+    }
+    if (ubRequestLengthP < (DPM86XX_SIM_FRAME_MAX - 1))
+    {
+      aszRequestP[ubRequestLengthP++] = (char)pubDataV[ulIndexT];
+    }
+
+    if (pubDataV[ulIndexT] == '\n')
+    {
+      aszRequestP[ubRequestLengthP] = '\0';
+      processRequest();
+      ubRequestLengthP = 0;
+    }
+  }
+
+  return ulSizeV;
+}
+
+//--------------------------------------------------------------------------------------------------------------------//
+//                                                                                                                    //
+//                                                                                                                    //
+//--------------------------------------------------------------------------------------------------------------------//
+void DPM86xxSim::flush()
+{
+  //---------------------------------------------------------------------------------------------------
+  // wait until all written bytes have been transmitted
+  //
+  while ((int32_t)(ulLineFreeP - (uint32_t)micros()) > 0)
+  {
+    yield();
+  }
+}
+
+//--------------------------------------------------------------------------------------------------------------------//
+//                                                                                                                    //
+//                                                                                                                    //
+//--------------------------------------------------------------------------------------------------------------------//
+uint32_t DPM86xxSim::baudRate()
+{
+  return ulBaudRateP;
+}
+
+//--------------------------------------------------------------------------------------------------------------------//
+//                                                                                                                    //
+//                                                                                                                    //
+//--------------------------------------------------------------------------------------------------------------------//
+bool DPM86xxSim::waitReadable(uint32_t ulTimeoutV)
+{
+  int32_t slWaitT;
+
+  if (available() > 0)
+  {
+    return true;
+  }
+
+  //---------------------------------------------------------------------------------------------------
+  // sleep until the next byte of the response has been transmitted, without response no byte can
+  // arrive until the next request
+  //
+  slWaitT = (int32_t)ulTimeoutV;
+  if (ubResponseReadP < ubResponseLengthP)
+  {
+    uint32_t ulNextByteT = ulResponseStartP + ((uint32_t)(ubResponseReadP + 1) * ulByteTimeP);
+    int32_t slNextT = (int32_t)(ulNextByteT - (uint32_t)micros());
+    if (slNextT < slWaitT)
+    {
+      slWaitT = slNextT;
+    }
+  }
+  if (slWaitT > 0)
+  {
+    delayMicroseconds((unsigned int)slWaitT);
+  }
+
+  return (available() > 0);
+}
+
+//--------------------------------------------------------------------------------------------------------------------//
+//                                                                                                                    //
+//                                                                                                                    //
+//--------------------------------------------------------------------------------------------------------------------//
+bool DPM86xxSim::targetValue(Device_ts *ptsDeviceV, uint32_t &ulVoltageR, uint32_t &ulCurrentR)
+{
+  bool btConstantCurrentT = false;
+
+  ulVoltageR = 0; // [mV]
+  ulCurrentR = 0; // [mA]
+
+  //---------------------------------------------------------------------------------------------------
+  // the output follows the voltage setpoint as long as the load current stays below the current
+  // setpoint, otherwise the current is limited and the voltage drops
+  //
+  if (ptsDeviceV->uwOutput != 0)
+  {
+    ulVoltageR = (uint32_t)ptsDeviceV->uwSetVoltage * 10;
+    if (ptsDeviceV->ulLoad > 0)
+    {
+      ulCurrentR = (uint32_t)(((uint64_t)ulVoltageR * 1000) / ptsDeviceV->ulLoad);
+      if (ulCurrentR > ptsDeviceV->uwSetCurrent)
+      {
+        ulCurrentR = ptsDeviceV->uwSetCurrent;
+        ulVoltageR = (uint32_t)(((uint64_t)ulCurrentR * ptsDeviceV->ulLoad) / 1000);
+        btConstantCurrentT = true;
+      }
+    }
+  }
+
+  return btConstantCurrentT;
+}
+
+//--------------------------------------------------------------------------------------------------------------------//
+//                                                                                                                    //
+//                                                                                                                    //
+//--------------------------------------------------------------------------------------------------------------------//
+void DPM86xxSim::settle(Device_ts *ptsDeviceV)
+{
+  uint32_t ulVoltageT;
+  uint32_t ulCurrentT;
+  uint32_t ulTimeT = micros();
+  float ftFactorT = 1.0f;
+
+  targetValue(ptsDeviceV, ulVoltageT, ulCurrentT);
+
+  //---------------------------------------------------------------------------------------------------
+  // first order response to the values given by the present setpoints, that are valid since the
+  // last call
+  //
+  if (ptsDeviceV->ulSettling > 0)
+  {
+    ftFactorT = 1.0f - expf(-(float)(ulTimeT - ptsDeviceV->ulOutputTime) / (float)ptsDeviceV->ulSettling);
+  }
+  ptsDeviceV->ftVoltage += ((float)ulVoltageT - ptsDeviceV->ftVoltage) * ftFactorT;
+  ptsDeviceV->ftCurrent += ((float)ulCurrentT - ptsDeviceV->ftCurrent) * ftFactorT;
+  ptsDeviceV->ulOutputTime = ulTimeT;
+}
+
+//--------------------------------------------------------------------------------------------------------------------//
+//                                                                                                                    //
+//                                                                                                                    //
+//--------------------------------------------------------------------------------------------------------------------//
+uint16_t DPM86xxSim::measuredValue(Device_ts *ptsDeviceV, uint8_t ubFunctionV)
+{
+  uint32_t ulVoltageT;
+  uint32_t ulCurrentT;
+  uint16_t uwConstantCurrentT = targetValue(ptsDeviceV, ulVoltageT, ulCurrentT) ? 1 : 0;
+
+  settle(ptsDeviceV);
+  ulVoltageT = (uint32_t)(ptsDeviceV->ftVoltage + 0.5f);
+  ulCurrentT = (uint32_t)(ptsDeviceV->ftCurrent + 0.5f);
+
+  switch (ubFunctionV)
+  {
+  case 30:
+    return (uint16_t)(ulVoltageT / 10);
+  case 31:
+    return (uint16_t)ulCurrentT;
+  case 32:
+    return uwConstantCurrentT;
+  default:
+    break;
+  }
+
+  return 25; // temperature in [deg C]
+}
+
+//--------------------------------------------------------------------------------------------------------------------//
+//                                                                                                                    //
+//                                                                                                                    //
+//--------------------------------------------------------------------------------------------------------------------//
+bool DPM86xxSim::readValue(Device_ts *ptsDeviceV, uint8_t ubFunctionV, uint16_t &uwValueR)
+{
+  switch (ubFunctionV)
+  {
+  case 0:
+    uwValueR = 6000;
+    break;
+  case 1:
+    uwValueR = ptsDeviceV->uwMaxCurrent;
+    break;
+  case 10:
+    uwValueR = ptsDeviceV->uwSetVoltage;
+    break;
+  case 11:
+    uwValueR = ptsDeviceV->uwSetCurrent;
+    break;
+  case 12:
+    uwValueR = ptsDeviceV->uwOutput;
+    break;
+  case 30:
+  case 31:
+  case 32:
+  case 33:
+    uwValueR = measuredValue(ptsDeviceV, ubFunctionV);
+    break;
+  default:
+    return false;
+  }
+
+  return true;
+}
+
+//--------------------------------------------------------------------------------------------------------------------//
+//                                                                                                                    //
+//                                                                                                                    //
+//--------------------------------------------------------------------------------------------------------------------//
+bool DPM86xxSim::writeValue(Device_ts *ptsDeviceV, uint8_t ubFunctionV, uint16_t uwValueV)
+{
+  //---------------------------------------------------------------------------------------------------
+  // setpoints are limited to the capabilities of the model, the output settles from its present
+  // values
+  //
+  settle(ptsDeviceV);
+  switch (ubFunctionV)
+  {
+  case 10:
+    ptsDeviceV->uwSetVoltage = (uwValueV > 6000) ? 6000 : uwValueV;
+    break;
+  case 11:
+    ptsDeviceV->uwSetCurrent = (uwValueV > ptsDeviceV->uwMaxCurrent) ? ptsDeviceV->uwMaxCurrent : uwValueV;
+    break;
+  case 12:
+    ptsDeviceV->uwOutput = uwValueV;
+    break;
+  default:
+    return false;
+  }
+
+  return true;
+}
+
+//--------------------------------------------------------------------------------------------------------------------//
+//                                                                                                                    //
+//                                                                                                                    //
+//--------------------------------------------------------------------------------------------------------------------//
+uint8_t DPM86xxSim::modbusFunction(uint16_t uwRegisterV)
+{
+  switch (uwRegisterV)
+  {
+#ifdef DPM86XX_MODBUS_REG_MAX_VOLTAGE
+  case DPM86XX_MODBUS_REG_MAX_VOLTAGE:
+    return 0;
+#endif
+#ifdef DPM86XX_MODBUS_REG_MAX_CURRENT
+  case DPM86XX_MODBUS_REG_MAX_CURRENT:
+    return 1;
+#endif
+  case DPM86XX_MODBUS_REG_SET_VOLTAGE:
+    return 10;
+  case DPM86XX_MODBUS_REG_SET_CURRENT:
+    return 11;
+  case DPM86XX_MODBUS_REG_OUTPUT:
+    return 12;
+  case DPM86XX_MODBUS_REG_MEASURED_VOLTAGE:
+  case DPM86XX_MODBUS_REG_MEASURED_CURRENT:
+  case DPM86XX_MODBUS_REG_CONSTANT_OUTPUT:
+  case DPM86XX_MODBUS_REG_TEMPERATURE:
+    return (uint8_t)(30 + (uwRegisterV - DPM86XX_MODBUS_REG_MEASURED_VOLTAGE));
+  default:
+    break;
+  }
+
+  return 0xFF;
+}
+
+//--------------------------------------------------------------------------------------------------------------------//
+//                                                                                                                    //
+//                                                                                                                    //
+//--------------------------------------------------------------------------------------------------------------------//
+void DPM86xxSim::respond(const char *pszFrameV, uint8_t ubLengthV)
+{
+  //---------------------------------------------------------------------------------------------------
+  // the response starts after the request has been transmitted and the PSU has processed it
+  //
+  ubResponseLengthP = ubLengthV;
+  memcpy(aszResponseP, pszFrameV, ubResponseLengthP);
+  ubResponseReadP = 0;
+  ulResponseStartP = ulLineFreeP + ulTurnaroundP;
+  ulLineFreeP = ulResponseStartP + (uint32_t)ubResponseLengthP * ulByteTimeP;
+  ulResponseCountP++;
+}
+
+//--------------------------------------------------------------------------------------------------------------------//
+//                                                                                                                    //
+//                                                                                                                    //
+//--------------------------------------------------------------------------------------------------------------------//
+void DPM86xxSim::processRequest()
+{
+  char aszFrameT[DPM86XX_SIM_FRAME_MAX];
+  uint32_t aulValueT[2] = {0, 0};
+  uint8_t ubValueCountT = 0;
+  const char *pszScanT = aszRequestP;
+  Device_ts *ptsDeviceT;
+  uint8_t ubAddressT;
+  uint8_t ubFunctionT;
+  char chCommandT;
+
+  //---------------------------------------------------------------------------------------------------
+  // request frame ":<address><command><function>=<value1>,[<value2>,]\r\n"
+  //
+  if ((ubRequestLengthP < 10) || (pszScanT[0] != ':') || !isdigit(pszScanT[1]) || !isdigit(pszScanT[2]) ||
+      !isdigit(pszScanT[4]) || !isdigit(pszScanT[5]) || (pszScanT[6] != '='))
+  {
+    return;
+  }
+  ubAddressT = (uint8_t)(((pszScanT[1] - '0') * 10) + (pszScanT[2] - '0'));
+  chCommandT = pszScanT[3];
+  ubFunctionT = (uint8_t)(((pszScanT[4] - '0') * 10) + (pszScanT[5] - '0'));
+  pszScanT += 7;
+
+  while (isdigit(*pszScanT) && (ubValueCountT < 2))
+  {
+    while (isdigit(*pszScanT))
+    {
+      aulValueT[ubValueCountT] = (aulValueT[ubValueCountT] * 10) + (uint32_t)(*pszScanT - '0');
+      pszScanT++;
+    }
+    if (*pszScanT != ',')
+    {
+      return;
+    }
+    pszScanT++;
+    ubValueCountT++;
+  }
+
+  //---------------------------------------------------------------------------------------------------
+  // only the addressed PSU responds
+  //
+  ptsDeviceT = device(ubAddressT);
+  if ((ptsDeviceT == nullptr) || (ubValueCountT == 0))
+  {
+    return;
+  }
+
+  if (chCommandT == 'r')
+  {
+    uint16_t uwValueT;
+    if (readValue(ptsDeviceT, ubFunctionT, uwValueT) != true)
+    {
+      return;
+    }
+    snprintf(aszFrameT, sizeof(aszFrameT), ":%02ur%02u=%u.\r\n", ubAddressT, ubFunctionT, uwValueT);
+  }
+  else if (chCommandT == 'w')
+  {
+    if (ubFunctionT == 20)
+    {
+      if ((ubValueCountT != 2) || (writeValue(ptsDeviceT, 10, (uint16_t)aulValueT[0]) != true) ||
+          (writeValue(ptsDeviceT, 11, (uint16_t)aulValueT[1]) != true))
+      {
+        return;
+      }
+    }
+    else if (writeValue(ptsDeviceT, ubFunctionT, (uint16_t)aulValueT[0]) != true)
+    {
+      return;
+    }
+    snprintf(aszFrameT, sizeof(aszFrameT), ":%02uok\r\n", ubAddressT);
+  }
+  else
+  {
+    return;
+  }
+
+  respond(aszFrameT, (uint8_t)strlen(aszFrameT));
+}
+
+//--------------------------------------------------------------------------------------------------------------------//
+//                                                                                                                    //
+//                                                                                                                    //
+//--------------------------------------------------------------------------------------------------------------------//
+void DPM86xxSim::processModbusRequest()
+{
+  uint8_t aubFrameT[DPM86XX_SIM_FRAME_MAX];
+  const uint8_t *pubRequestT = (const uint8_t *)aszRequestP;
+  uint8_t ubLengthT = 0;
+  uint8_t ubExceptionT = 0;
+  uint16_t uwRegisterT;
+  uint16_t uwCountT;
+  uint16_t uwValueT;
+  Device_ts *ptsDeviceT;
+
+  //---------------------------------------------------------------------------------------------------
+  // frames with wrong CRC are ignored, only the addressed PSU responds
+  //
+  if ((DPM86xxModbus::checkCrc(pubRequestT, ubRequestLengthP) != true) ||
+      ((ptsDeviceT = device(pubRequestT[0])) == nullptr))
+  {
+    return;
+  }
+  uwRegisterT = DPM86xxModbus::value(&pubRequestT[2]);
+  uwCountT = DPM86xxModbus::value(&pubRequestT[4]);
+
+  aubFrameT[ubLengthT++] = pubRequestT[0];
+  aubFrameT[ubLengthT++] = pubRequestT[1];
+
+  switch (pubRequestT[1])
+  {
+  case DPM86XX_MODBUS_READ_REGISTERS:
+    if ((uwCountT == 0) || (uwCountT > ((DPM86XX_SIM_FRAME_MAX - 5) / 2)))
+    {
+      ubExceptionT = 0x03;
+      break;
+    }
+    aubFrameT[ubLengthT++] = (uint8_t)(uwCountT * 2);
+    for (uint16_t uwIndexT = 0; uwIndexT < uwCountT; uwIndexT++)
+    {
+      if (readValue(ptsDeviceT, modbusFunction((uint16_t)(uwRegisterT + uwIndexT)), uwValueT) != true)
+      {
+        ubExceptionT = 0x02;
+        break;
+      }
+      aubFrameT[ubLengthT++] = (uint8_t)(uwValueT >> 8);
+      aubFrameT[ubLengthT++] = (uint8_t)(uwValueT & 0xFF);
+    }
+    break;
+
+  case DPM86XX_MODBUS_WRITE_REGISTER:
+    if (writeValue(ptsDeviceT, modbusFunction(uwRegisterT), uwCountT) != true)
+    {
+      ubExceptionT = 0x02;
+      break;
+    }
+    memcpy(&aubFrameT[ubLengthT], &pubRequestT[2], 4);
+    ubLengthT += 4;
+    break;
+
+  case DPM86XX_MODBUS_WRITE_REGISTERS:
+    if ((uwCountT == 0) || (pubRequestT[6] != (uint8_t)(uwCountT * 2)))
+    {
+      ubExceptionT = 0x03;
+      break;
+    }
+    for (uint16_t uwIndexT = 0; uwIndexT < uwCountT; uwIndexT++)
+    {
+      uwValueT = DPM86xxModbus::value(&pubRequestT[7 + (uwIndexT * 2)]);
+      if (writeValue(ptsDeviceT, modbusFunction((uint16_t)(uwRegisterT + uwIndexT)), uwValueT) != true)
+      {
+        ubExceptionT = 0x02;
+        break;
+      }
+    }
+    memcpy(&aubFrameT[ubLengthT], &pubRequestT[2], 4);
+    ubLengthT += 4;
+    break;
+
+  default:
+    ubExceptionT = 0x01;
+    break;
+  }
+
+  //---------------------------------------------------------------------------------------------------
+  // an exception response contains only the exception code
+  //
+  if (ubExceptionT != 0)
+  {
+    aubFrameT[1] |= DPM86XX_MODBUS_EXCEPTION;
+    aubFrameT[2] = ubExceptionT;
+    ubLengthT = 3;
+  }
+
+  ubLengthT = DPM86xxModbus::appendCrc(aubFrameT, ubLengthT);
+  respond((const char *)aubFrameT, ubLengthT);
+}
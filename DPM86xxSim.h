@@ -0,0 +1,166 @@
+//====================================================================================================================//
+// File:          DPM86xxSim.h                                                                                        //
+// Description:   Simulated bus with DPM86xx PSUs, that can be used as transport instead of a serial interface        //
+// Author:        Tiderko                                                                                             //
+//--------------------------------------------------------------------------------------------------------------------//
+//                                                                                                                    //
+//====================================================================================================================//
+
+#ifndef DPM86xxSim_h
+#define DPM86xxSim_h
+
+#ifdef ARDUINO
+#include "Arduino.h"
+#else
+#include "DPM86xxHost.h"
+#endif
+#include "DPM86xxTransport.h"
+#include "DPM86xxModbus.h"
+
+/**
+ * @brief Maximal number of PSUs that can be connected to one simulated bus
+ *
+ */
+#define DPM86XX_SIM_DEVICES_MAX 16
+
+/**
+ * @brief Maximal number of byte of a request or response frame handled by the simulated bus
+ *
+ */
+#define DPM86XX_SIM_FRAME_MAX 32
+
+/**
+ * @brief Default time in [us] a simulated PSU needs between the end of a request and the begin of the response
+ *
+ */
+#define DPM86XX_SIM_TURNAROUND 1000
+
+/**
+ * @brief Default load resistance in [mOhm] connected to the output of a simulated PSU
+ *
+ */
+#define DPM86XX_SIM_LOAD 10000
+
+/**
+ * @brief Default time constant in [ms] of the output of a simulated PSU, 0 means the output follows immediately
+ *
+ */
+#define DPM86XX_SIM_SETTLING 0
+
+/**
+ * @brief Simulated bus with DPM8605, DPM8608, DPM8616 or DPM8624 PSUs
+ *
+ * The PSUs speak the ASCII protocol of the TTL version or Modbus-RTU of the RS-485 version. The transmission time
+ * of each byte is calculated from the baud rate, so bytes of a response become available at the same time as on a
+ * real serial interface. The output of each PSU is connected to a resistive load, so measured values and the
+ * constant current / voltage mode follow the setpoints.
+ */
+class DPM86xxSim : public DPM86xxTransport
+{
+public:
+  DPM86xxSim();
+
+  /**
+   * @brief Initialisation of the simulated bus, all PSUs are removed
+   *
+   * @param[in] ulBaudRateV baud rate of the simulated bus
+   * @param[in] ulTurnaroundV time in [us] between end of request and begin of response
+   */
+  void init(uint32_t ulBaudRateV, uint32_t ulTurnaroundV = DPM86XX_SIM_TURNAROUND);
+
+  /**
+   * @brief Connect a simulated PSU to the bus
+   *
+   * @param[in] ubAddressV address of the PSU in range from 1 to 99
+   * @param[in] uwModelV model number: 8605, 8608, 8616 or 8624
+   * @return \c true on success, \c false if no further PSU can be added or parameters are not valid
+   */
+  bool addDevice(uint8_t ubAddressV, uint16_t uwModelV);
+
+  /**
+   * @brief Change the load resistance that is connected to the output of a PSU
+   *
+   * @param[in] ubAddressV address of the PSU
+   * @param[in] ulLoadV load resistance in [mOhm], 0 means that no load is connected
+   */
+  void setLoad(uint8_t ubAddressV, uint32_t ulLoadV);
+
+  /**
+   * @brief Change the time the output of a PSU needs to follow a change of setpoints or load
+   *
+   * @param[in] ubAddressV address of the PSU
+   * @param[in] ulTimeConstantV time constant in [ms] of the first order response of the output
+   *
+   * A real PSU needs about 0.6 s to settle, that corresponds to a time constant of about 150 ms.
+   */
+  void setSettling(uint8_t ubAddressV, uint32_t ulTimeConstantV);
+
+  /**
+   * @brief Select the protocol spoken by all simulated PSUs
+   *
+   * @param[in] btEnableV \c true for Modbus-RTU, \c false for the ASCII protocol (default)
+   */
+  void setModbus(bool btEnableV);
+
+  /**
+   * @brief Returns the number of requests that have been answered by the simulated PSUs
+   */
+  uint32_t responseCount();
+
+  int32_t available() override;
+  int32_t read() override;
+  size_t write(const uint8_t *pubDataV, size_t ulSizeV) override;
+  void flush() override;
+  uint32_t baudRate() override;
+  bool waitReadable(uint32_t ulTimeoutV) override;
+
+private:
+  typedef struct Device_s
+  {
+    uint8_t ubAddress;
+    uint16_t uwMaxCurrent;
+    uint16_t uwSetVoltage;
+    uint16_t uwSetCurrent;
+    uint16_t uwOutput;
+    uint32_t ulLoad;
+
+    //-------------------------------------------------------------------------------------------
+    // output voltage in [mV] and current in [mA] that approach the values given by setpoints
+    // and load with the time constant in [us]
+    //
+    uint32_t ulSettling;
+    float ftVoltage;
+    float ftCurrent;
+    uint32_t ulOutputTime;
+  } Device_ts;
+
+  Device_ts *device(uint8_t ubAddressV);
+  void processRequest();
+  void processModbusRequest();
+  bool readValue(Device_ts *ptsDeviceV, uint8_t ubFunctionV, uint16_t &uwValueR);
+  bool writeValue(Device_ts *ptsDeviceV, uint8_t ubFunctionV, uint16_t uwValueV);
+  static uint8_t modbusFunction(uint16_t uwRegisterV);
+  static bool targetValue(Device_ts *ptsDeviceV, uint32_t &ulVoltageR, uint32_t &ulCurrentR);
+  void settle(Device_ts *ptsDeviceV);
+  uint16_t measuredValue(Device_ts *ptsDeviceV, uint8_t ubFunctionV);
+  void respond(const char *pszFrameV, uint8_t ubLengthV);
+
+  Device_ts atsDeviceP[DPM86XX_SIM_DEVICES_MAX];
+  uint8_t ubDeviceCountP;
+
+  char aszRequestP[DPM86XX_SIM_FRAME_MAX];
+  uint8_t ubRequestLengthP;
+  char aszResponseP[DPM86XX_SIM_FRAME_MAX];
+  uint8_t ubResponseLengthP;
+  uint8_t ubResponseReadP;
+  uint32_t ulResponseStartP;
+  uint32_t ulResponseCountP;
+  bool btModbusP;
+
+  uint32_t ulBaudRateP;
+  uint32_t ulByteTimeP;
+  uint32_t ulTurnaroundP;
+  uint32_t ulLineFreeP;
+};
+
+#endif
@@ -0,0 +1,289 @@
+//====================================================================================================================//
+// File:          DPM86xxSweep.cpp                                                                                    //
+// Description:   DPM86xxSweep implementation                                                                         //
+// Author:        Tiderko                                                                                             //
+//--------------------------------------------------------------------------------------------------------------------//
+//                                                                                                                    //
+//====================================================================================================================//
+
+#include <DPM86xxSweep.h>
+
+//--------------------------------------------------------------------------------------------------------------------//
+//                                                                                                                    //
+//                                                                                                                    //
+//--------------------------------------------------------------------------------------------------------------------//
+DPM86xxSweep::DPM86xxSweep()
+{
+  uwPointCountP = 0;
+  uwToleranceVoltageP = 2;
+  uwToleranceCurrentP = 2;
+  ubWindowP = 4;
+  ulWindowTimeP = DPM86XX_SWEEP_WINDOW_TIME;
+  ulTimeoutP = DPM86XX_SWEEP_TIMEOUT;
+  ulDurationP = 0;
+}
+
+//--------------------------------------------------------------------------------------------------------------------//
+//                                                                                                                    //
+//                                                                                                                    //
+//--------------------------------------------------------------------------------------------------------------------//
+void DPM86xxSweep::setTolerance(uint16_t uwVoltageV, uint16_t uwCurrentV)
+{
+  uwToleranceVoltageP = uwVoltageV;
+  uwToleranceCurrentP = uwCurrentV;
+}
+
+//--------------------------------------------------------------------------------------------------------------------//
+//                                                                                                                    //
+//                                                                                                                    //
+//--------------------------------------------------------------------------------------------------------------------//
+void DPM86xxSweep::setWindow(uint8_t ubSamplesV, uint32_t ulTimeV)
+{
+  if (ubSamplesV < 2)
+  {
+    ubSamplesV = 2;
+  }
+  if (ubSamplesV > DPM86XX_SWEEP_WINDOW_MAX)
+  {
+    ubSamplesV = DPM86XX_SWEEP_WINDOW_MAX;
+  }
+  ubWindowP = ubSamplesV;
+  ulWindowTimeP = ulTimeV;
+}
+
+//--------------------------------------------------------------------------------------------------------------------//
+//                                                                                                                    //
+//                                                                                                                    //
+//--------------------------------------------------------------------------------------------------------------------//
+void DPM86xxSweep::setTimeout(uint32_t ulTimeoutV)
+{
+  ulTimeoutP = ulTimeoutV;
+}
+
+//--------------------------------------------------------------------------------------------------------------------//
+//                                                                                                                    //
+//                                                                                                                    //
+//--------------------------------------------------------------------------------------------------------------------//
+int32_t DPM86xxSweep::sweepVoltage(DPM86xx &clPsuR, uint32_t ulStartV, uint32_t ulStopV, uint32_t ulStepV,
+                                   uint32_t ulMilliampereV)
+{
+  return sweep(clPsuR, ulStartV, ulStopV, ulStepV, ulMilliampereV, false);
+}
+
+//--------------------------------------------------------------------------------------------------------------------//
+//                                                                                                                    //
+//                                                                                                                    //
+//--------------------------------------------------------------------------------------------------------------------//
+int32_t DPM86xxSweep::sweepCurrent(DPM86xx &clPsuR, uint32_t ulStartV, uint32_t ulStopV, uint32_t ulStepV,
+                                   uint32_t ulMillivoltV)
+{
+  return sweep(clPsuR, ulStartV, ulStopV, ulStepV, ulMillivoltV, true);
+}
+
+//--------------------------------------------------------------------------------------------------------------------//
+//                                                                                                                    //
+//                                                                                                                    //
+//--------------------------------------------------------------------------------------------------------------------//
+int32_t DPM86xxSweep::sweep(DPM86xx &clPsuR, uint32_t ulStartV, uint32_t ulStopV, uint32_t ulStepV,
+                            uint32_t ulLimitV, bool btCurrentV)
+{
+  uint32_t ulValueT = ulStartV;
+  uint32_t ulStartTimeT = millis();
+  uint32_t ulRangeT = (ulStopV > ulStartV) ? (ulStopV - ulStartV) : (ulStartV - ulStopV);
+  int32_t slResultT;
+
+  uwPointCountP = 0;
+  ulDurationP = 0;
+
+  if (ulStepV == 0)
+  {
+    ulStepV = 1;
+  }
+
+  //---------------------------------------------------------------------------------------------------
+  // the sweep is not started if its points do not fit, so a curve is never truncated
+  //
+  if (((((uint64_t)ulRangeT + ulStepV - 1) / ulStepV) + 1) > DPM86XX_SWEEP_POINTS_MAX)
+  {
+    return DPM86xx::eSTATUS_RANGE;
+  }
+
+  while (uwPointCountP < DPM86XX_SWEEP_POINTS_MAX)
+  {
+    Point_ts &tsPointT = atsPointP[uwPointCountP];
+
+    //-------------------------------------------------------------------------------------------
+    // voltage and current are written by one request, the swept value is the only one that
+    // changes
+    //
+    if (btCurrentV)
+    {
+      tsPointT.uwSetVoltage = DPM86xx::millivoltRegister(ulLimitV);
+      tsPointT.uwSetCurrent = DPM86xx::milliampereRegister(ulValueT);
+    }
+    else
+    {
+      tsPointT.uwSetVoltage = DPM86xx::millivoltRegister(ulValueT);
+      tsPointT.uwSetCurrent = DPM86xx::milliampereRegister(ulLimitV);
+    }
+
+    slResultT = clPsuR.writeFunction(DPM86xx::eFUNC_SET_VC, tsPointT.uwSetVoltage, tsPointT.uwSetCurrent);
+    if (slResultT < 0)
+    {
+      ulDurationP = (uint32_t)millis() - ulStartTimeT;
+      return slResultT;
+    }
+
+    measure(clPsuR, tsPointT);
+    uwPointCountP++;
+
+    //-------------------------------------------------------------------------------------------
+    // next value in direction of the stop value, the stop value itself is always measured
+    //
+    if (ulValueT == ulStopV)
+    {
+      break;
+    }
+    if (ulStopV > ulValueT)
+    {
+      ulValueT = ((ulStopV - ulValueT) > ulStepV) ? (ulValueT + ulStepV) : ulStopV;
+    }
+    else
+    {
+      ulValueT = ((ulValueT - ulStopV) > ulStepV) ? (ulValueT - ulStepV) : ulStopV;
+    }
+  }
+
+  ulDurationP = (uint32_t)millis() - ulStartTimeT;
+  return uwPointCountP;
+}
+
+//--------------------------------------------------------------------------------------------------------------------//
+//                                                                                                                    //
+//                                                                                                                    //
+//--------------------------------------------------------------------------------------------------------------------//
+void DPM86xxSweep::measure(DPM86xx &clPsuR, Point_ts &tsPointR)
+{
+  DPM86xx::Snapshot_ts tsSnapshotT;
+  uint16_t auwVoltageT[DPM86XX_SWEEP_WINDOW_MAX];
+  uint16_t auwCurrentT[DPM86XX_SWEEP_WINDOW_MAX];
+  uint16_t auwModeT[DPM86XX_SWEEP_WINDOW_MAX];
+  uint32_t ulLastTimeT = 0;
+  uint8_t ubNextT = 0;
+  uint8_t ubCountT = 0;
+  uint32_t ulStartT = millis();
+  uint32_t ulVoltageSumT;
+  uint32_t ulCurrentSumT;
+  uint16_t uwVoltageMinT, uwVoltageMaxT;
+  uint16_t uwCurrentMinT, uwCurrentMaxT;
+  bool btSameModeT;
+
+  tsPointR.uwVoltage = 0;
+  tsPointR.uwCurrent = 0;
+  tsPointR.uwSamples = 0;
+  tsPointR.btConstantCurrent = false;
+  tsPointR.btSettled = false;
+
+  for (;;)
+  {
+    tsPointR.ulSettleTime = (uint32_t)millis() - ulStartT;
+
+    //-------------------------------------------------------------------------------------------
+    // samples are taken into the window with a minimal distance, so the window covers the window
+    // time also if the bus is fast
+    //
+    if (clPsuR.readSnapshot(tsSnapshotT, DPM86xx::eSNAP_VOLTAGE | DPM86xx::eSNAP_CURRENT |
+                                             DPM86xx::eSNAP_CONSTANT_OUTPUT) == DPM86xx::eSTATUS_OK)
+    {
+      tsPointR.uwSamples++;
+      if ((ubCountT == 0) || ((tsSnapshotT.ulTimestamp - ulLastTimeT) >= (ulWindowTimeP / (ubWindowP - 1))))
+      {
+        auwVoltageT[ubNextT] = tsSnapshotT.uwVoltage;
+        auwCurrentT[ubNextT] = tsSnapshotT.uwCurrent;
+        auwModeT[ubNextT] = tsSnapshotT.uwConstantOutput;
+        ulLastTimeT = tsSnapshotT.ulTimestamp;
+        ubNextT = (uint8_t)((ubNextT + 1) % ubWindowP);
+        if (ubCountT < ubWindowP)
+        {
+          ubCountT++;
+        }
+      }
+    }
+
+    //-------------------------------------------------------------------------------------------
+    // the output has settled if the samples of the window lie within the tolerance band and show
+    // the same mode
+    //
+    if (ubCountT > 0)
+    {
+      ulVoltageSumT = 0;
+      ulCurrentSumT = 0;
+      uwVoltageMinT = 0xFFFF;
+      uwVoltageMaxT = 0;
+      uwCurrentMinT = 0xFFFF;
+      uwCurrentMaxT = 0;
+      btSameModeT = true;
+
+      for (uint8_t ubIndexT = 0; ubIndexT < ubCountT; ubIndexT++)
+      {
+        ulVoltageSumT += auwVoltageT[ubIndexT];
+        ulCurrentSumT += auwCurrentT[ubIndexT];
+        uwVoltageMinT = (auwVoltageT[ubIndexT] < uwVoltageMinT) ? auwVoltageT[ubIndexT] : uwVoltageMinT;
+        uwVoltageMaxT = (auwVoltageT[ubIndexT] > uwVoltageMaxT) ? auwVoltageT[ubIndexT] : uwVoltageMaxT;
+        uwCurrentMinT = (auwCurrentT[ubIndexT] < uwCurrentMinT) ? auwCurrentT[ubIndexT] : uwCurrentMinT;
+        uwCurrentMaxT = (auwCurrentT[ubIndexT] > uwCurrentMaxT) ? auwCurrentT[ubIndexT] : uwCurrentMaxT;
+        if (auwModeT[ubIndexT] != auwModeT[0])
+        {
+          btSameModeT = false;
+        }
+      }
+
+      tsPointR.uwVoltage = (uint16_t)((ulVoltageSumT + (ubCountT / 2)) / ubCountT);
+      tsPointR.uwCurrent = (uint16_t)((ulCurrentSumT + (ubCountT / 2)) / ubCountT);
+      tsPointR.btConstantCurrent = (auwModeT[(ubNextT + ubWindowP - 1) % ubWindowP] != 0);
+
+      if ((ubCountT == ubWindowP) && btSameModeT && ((uwVoltageMaxT - uwVoltageMinT) <= uwToleranceVoltageP) &&
+          ((uwCurrentMaxT - uwCurrentMinT) <= uwToleranceCurrentP))
+      {
+        tsPointR.btSettled = true;
+        return;
+      }
+    }
+
+    if (((uint32_t)millis() - ulStartT) >= ulTimeoutP)
+    {
+      return;
+    }
+  }
+}
+
+//--------------------------------------------------------------------------------------------------------------------//
+//                                                                                                                    //
+//                                                                                                                    //
+//--------------------------------------------------------------------------------------------------------------------//
+uint16_t DPM86xxSweep::pointCount()
+{
+  return uwPointCountP;
+}
+
+//--------------------------------------------------------------------------------------------------------------------//
+//                                                                                                                    //
+//                                                                                                                    //
+//--------------------------------------------------------------------------------------------------------------------//
+const DPM86xxSweep::Point_ts &DPM86xxSweep::point(uint16_t uwIndexV)
+{
+  if (uwIndexV >= uwPointCountP)
+  {
+    uwIndexV = 0;
+  }
+  return atsPointP[uwIndexV];
+}
+
+//--------------------------------------------------------------------------------------------------------------------//
+//                                                                                                                    //
+//                                                                                                                    //
+//--------------------------------------------------------------------------------------------------------------------//
+uint32_t DPM86xxSweep::duration()
+{
+  return ulDurationP;
+}
@@ -0,0 +1,184 @@
+//====================================================================================================================//
+// File:          DPM86xxSweep.h                                                                                      //
+// Description:   DPM86xxSweep Class definition, I-V characterisation that waits until the output has settled        //
+// Author:        Tiderko                                                                                             //
+//--------------------------------------------------------------------------------------------------------------------//
+//                                                                                                                    //
+//====================================================================================================================//
+
+#ifndef DPM86xxSweep_h
+#define DPM86xxSweep_h
+
+#include "DPM86xx.h"
+
+/**
+ * @brief Maximal number of points of one sweep
+ *
+ */
+#ifndef DPM86XX_SWEEP_POINTS_MAX
+#define DPM86XX_SWEEP_POINTS_MAX 64
+#endif
+
+/**
+ * @brief Maximal number of samples that are used to detect the settled output, see DPM86xxSweep::setWindow()
+ *
+ */
+#ifndef DPM86XX_SWEEP_WINDOW_MAX
+#define DPM86XX_SWEEP_WINDOW_MAX 16
+#endif
+
+/**
+ * @brief Default minimal time in [ms] covered by the samples that detect the settled output, see
+ *        DPM86xxSweep::setWindow()
+ *
+ */
+#ifndef DPM86XX_SWEEP_WINDOW_TIME
+#define DPM86XX_SWEEP_WINDOW_TIME 150
+#endif
+
+/**
+ * @brief Default maximal time in [ms] to wait for the output to settle, see DPM86xxSweep::setTimeout()
+ *
+ */
+#ifndef DPM86XX_SWEEP_TIMEOUT
+#define DPM86XX_SWEEP_TIMEOUT 3000
+#endif
+
+/**
+ * @brief Steps voltage or current setpoint and records the settled output as I-V curve
+ *
+ * After each setpoint has been written, measured voltage, current and constant current / voltage mode are read as
+ * fast as the bus allows. The output is settled as soon as the last samples lie within a tolerance band and show
+ * the same mode. Their mean value is recorded and the next setpoint is written, so no fixed delay is necessary.
+ */
+class DPM86xxSweep
+{
+public:
+  /**
+   * @brief Point of the I-V curve returned by point()
+   */
+  typedef struct Point_s
+  {
+    /**
+     * @brief Setpoints of voltage in [10 mV] and current in [mA] as written to the registers
+     */
+    uint16_t uwSetVoltage;
+    uint16_t uwSetCurrent;
+
+    /**
+     * @brief Mean of the measured voltage in [10 mV] and current in [mA] of the settled samples
+     */
+    uint16_t uwVoltage;
+    uint16_t uwCurrent;
+
+    /**
+     * @brief Time in [ms] from the acknowledge of the setpoints until the output has settled
+     */
+    uint32_t ulSettleTime;
+
+    /**
+     * @brief Number of samples that have been read for this point
+     */
+    uint16_t uwSamples;
+
+    /**
+     * @brief The output has been in constant current mode, otherwise in constant voltage mode
+     */
+    bool btConstantCurrent;
+
+    /**
+     * @brief \c false if the output did not settle within the time given by setTimeout()
+     */
+    bool btSettled;
+  } Point_ts;
+
+  DPM86xxSweep();
+
+  /**
+   * @brief Set the tolerance band of the settled output
+   *
+   * @param[in] uwVoltageV maximal difference of the measured voltage in [10 mV], default 2
+   * @param[in] uwCurrentV maximal difference of the measured current in [mA], default 2
+   */
+  void setTolerance(uint16_t uwVoltageV, uint16_t uwCurrentV);
+
+  /**
+   * @brief Set the consecutive samples that must lie within the tolerance band
+   *
+   * @param[in] ubSamplesV number in range from 2 to \c #DPM86XX_SWEEP_WINDOW_MAX, default 4
+   * @param[in] ulTimeV minimal time in [ms] between the first and the last sample
+   *
+   * At a high baud rate the samples follow each other closely, so a slowly settling output changes by less than
+   * the tolerance between them. Therefore samples are only taken into the window with a minimal distance. If the
+   * window covers at least the time constant of the output, the remaining error of a settled point is in the
+   * range of the tolerance.
+   */
+  void setWindow(uint8_t ubSamplesV, uint32_t ulTimeV = DPM86XX_SWEEP_WINDOW_TIME);
+
+  /**
+   * @brief Set the maximal time to wait for the output to settle
+   *
+   * @param[in] ulTimeoutV time in [ms]
+   */
+  void setTimeout(uint32_t ulTimeoutV);
+
+  /**
+   * @brief Sweep the voltage setpoint with a fixed current limit
+   *
+   * @param[in] clPsuR initialised PSU with output switched on
+   * @param[in] ulStartV first voltage in [mV]
+   * @param[in] ulStopV last voltage in [mV], may be lower than \p ulStartV
+   * @param[in] ulStepV voltage step in [mV]
+   * @param[in] ulMilliampereV current limit in [mA]
+   * @return number of points on success, a negative value of \c #DPM86xx::Status_e if a write failed or
+   *         \c #DPM86xx::eSTATUS_RANGE if the sweep needs more than \c #DPM86XX_SWEEP_POINTS_MAX points
+   */
+  int32_t sweepVoltage(DPM86xx &clPsuR, uint32_t ulStartV, uint32_t ulStopV, uint32_t ulStepV,
+                       uint32_t ulMilliampereV);
+
+  /**
+   * @brief Sweep the current setpoint with a fixed voltage limit
+   *
+   * @param[in] clPsuR initialised PSU with output switched on
+   * @param[in] ulStartV first current in [mA]
+   * @param[in] ulStopV last current in [mA], may be lower than \p ulStartV
+   * @param[in] ulStepV current step in [mA]
+   * @param[in] ulMillivoltV voltage limit in [mV]
+   * @return number of points on success, a negative value of \c #DPM86xx::Status_e if a write failed or
+   *         \c #DPM86xx::eSTATUS_RANGE if the sweep needs more than \c #DPM86XX_SWEEP_POINTS_MAX points
+   */
+  int32_t sweepCurrent(DPM86xx &clPsuR, uint32_t ulStartV, uint32_t ulStopV, uint32_t ulStepV, uint32_t ulMillivoltV);
+
+  /**
+   * @brief Returns the number of points of the last sweep
+   */
+  uint16_t pointCount();
+
+  /**
+   * @brief Returns a point of the last sweep
+   *
+   * @param[in] uwIndexV index in range from 0 to pointCount() - 1
+   */
+  const Point_ts &point(uint16_t uwIndexV);
+
+  /**
+   * @brief Returns the duration of the last sweep in [ms]
+   */
+  uint32_t duration();
+
+private:
+  int32_t sweep(DPM86xx &clPsuR, uint32_t ulStartV, uint32_t ulStopV, uint32_t ulStepV, uint32_t ulLimitV,
+                bool btCurrentV);
+  void measure(DPM86xx &clPsuR, Point_ts &tsPointR);
+
+  Point_ts atsPointP[DPM86XX_SWEEP_POINTS_MAX];
+  uint16_t uwPointCountP;
+  uint16_t uwToleranceVoltageP;
+  uint16_t uwToleranceCurrentP;
+  uint8_t ubWindowP;
+  uint32_t ulWindowTimeP;
+  uint32_t ulTimeoutP;
+  uint32_t ulDurationP;
+};
+
+#endif
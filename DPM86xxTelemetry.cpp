@@ -0,0 +1,372 @@
+//====================================================================================================================//
+// File:          DPM86xxTelemetry.cpp                                                                                //
+// Description:   DPM86xxTelemetry implementation                                                                     //
+// Author:        Tiderko                                                                                             //
+//--------------------------------------------------------------------------------------------------------------------//
+//                                                                                                                    //
+//====================================================================================================================//
+
+#include <DPM86xxTelemetry.h>
+
+//--------------------------------------------------------------------------------------------------------------------//
+//                                                                                                                    //
+//                                                                                                                    //
+//--------------------------------------------------------------------------------------------------------------------//
+DPM86xxTelemetry::DPM86xxTelemetry()
+{
+  for (uint16_t uwDeviceT = 0; uwDeviceT < DPM86XX_TELEMETRY_DEVICES_MAX; uwDeviceT++)
+  {
+    auwVoltageP[uwDeviceT] = 0;
+    auwCurrentP[uwDeviceT] = 0;
+    auwTemperatureP[uwDeviceT] = 0;
+    aulPowerP[uwDeviceT] = 0;
+    aubConstantCurrentP[uwDeviceT] = 0;
+    aubFieldsP[uwDeviceT] = 0;
+    aulTimestampP[uwDeviceT] = 0;
+  }
+  uwDeviceCountP = 0;
+
+#if defined(ESP32) && defined(ARDUINO)
+  pvLockP = xSemaphoreCreateMutex();
+#endif
+}
+
+//--------------------------------------------------------------------------------------------------------------------//
+//                                                                                                                    //
+//                                                                                                                    //
+//--------------------------------------------------------------------------------------------------------------------//
+void DPM86xxTelemetry::lock()
+{
+#if defined(ESP32) || !defined(ARDUINO)
+#ifdef ARDUINO
+  xSemaphoreTake(pvLockP, portMAX_DELAY);
+#else
+  clLockP.lock();
+#endif
+#endif
+}
+
+//--------------------------------------------------------------------------------------------------------------------//
+//                                                                                                                    //
+//                                                                                                                    //
+//--------------------------------------------------------------------------------------------------------------------//
+void DPM86xxTelemetry::unlock()
+{
+#if defined(ESP32) || !defined(ARDUINO)
+#ifdef ARDUINO
+  xSemaphoreGive(pvLockP);
+#else
+  clLockP.unlock();
+#endif
+#endif
+}
+
+//--------------------------------------------------------------------------------------------------------------------//
+//                                                                                                                    //
+//                                                                                                                    //
+//--------------------------------------------------------------------------------------------------------------------//
+void DPM86xxTelemetry::store(uint16_t uwDeviceV, const DPM86xx::Snapshot_ts &tsSnapshotV)
+{
+  if (uwDeviceV >= DPM86XX_TELEMETRY_DEVICES_MAX)
+  {
+    return;
+  }
+
+  if (tsSnapshotV.ubFields & DPM86xx::eSNAP_VOLTAGE)
+  {
+    auwVoltageP[uwDeviceV] = tsSnapshotV.uwVoltage;
+  }
+  if (tsSnapshotV.ubFields & DPM86xx::eSNAP_CURRENT)
+  {
+    auwCurrentP[uwDeviceV] = tsSnapshotV.uwCurrent;
+  }
+  if (tsSnapshotV.ubFields & DPM86xx::eSNAP_CONSTANT_OUTPUT)
+  {
+    aubConstantCurrentP[uwDeviceV] = (tsSnapshotV.uwConstantOutput != 0) ? 1 : 0;
+  }
+  if (tsSnapshotV.ubFields & DPM86xx::eSNAP_TEMPERATURE)
+  {
+    auwTemperatureP[uwDeviceV] = tsSnapshotV.uwTemperature;
+  }
+  aulPowerP[uwDeviceV] = ((uint32_t)auwVoltageP[uwDeviceV] * auwCurrentP[uwDeviceV]) / 100;
+  aubFieldsP[uwDeviceV] = tsSnapshotV.ubFields;
+  aulTimestampP[uwDeviceV] = tsSnapshotV.ulTimestamp;
+
+  if (uwDeviceV >= uwDeviceCountP)
+  {
+    uwDeviceCountP = (uint16_t)(uwDeviceV + 1);
+  }
+}
+
+//--------------------------------------------------------------------------------------------------------------------//
+//                                                                                                                    //
+//                                                                                                                    //
+//--------------------------------------------------------------------------------------------------------------------//
+void DPM86xxTelemetry::update(uint16_t uwDeviceV, const DPM86xx::Snapshot_ts &tsSnapshotV)
+{
+  lock();
+  store(uwDeviceV, tsSnapshotV);
+  unlock();
+}
+
+//--------------------------------------------------------------------------------------------------------------------//
+//                                                                                                                    //
+//                                                                                                                    //
+//--------------------------------------------------------------------------------------------------------------------//
+void DPM86xxTelemetry::update(uint16_t uwFirstDeviceV, const DPM86xx::Snapshot_ts atsSnapshotV[], uint16_t uwCountV)
+{
+  lock();
+  for (uint16_t uwIndexT = 0; uwIndexT < uwCountV; uwIndexT++)
+  {
+    store((uint16_t)(uwFirstDeviceV + uwIndexT), atsSnapshotV[uwIndexT]);
+  }
+  unlock();
+}
+
+//--------------------------------------------------------------------------------------------------------------------//
+//                                                                                                                    //
+//                                                                                                                    //
+//--------------------------------------------------------------------------------------------------------------------//
+void DPM86xxTelemetry::invalidate(uint16_t uwDeviceV)
+{
+  if (uwDeviceV < DPM86XX_TELEMETRY_DEVICES_MAX)
+  {
+    lock();
+    aubFieldsP[uwDeviceV] = 0;
+    unlock();
+  }
+}
+
+//--------------------------------------------------------------------------------------------------------------------//
+//                                                                                                                    //
+//                                                                                                                    //
+//--------------------------------------------------------------------------------------------------------------------//
+uint8_t DPM86xxTelemetry::columnFields(Column_te teColumnV)
+{
+  switch (teColumnV)
+  {
+  case eCOLUMN_VOLTAGE:
+    return DPM86xx::eSNAP_VOLTAGE;
+  case eCOLUMN_CURRENT:
+    return DPM86xx::eSNAP_CURRENT;
+  case eCOLUMN_TEMPERATURE:
+    return DPM86xx::eSNAP_TEMPERATURE;
+  default:
+    return DPM86xx::eSNAP_VOLTAGE | DPM86xx::eSNAP_CURRENT;
+  }
+}
+
+//--------------------------------------------------------------------------------------------------------------------//
+//                                                                                                                    //
+//                                                                                                                    //
+//--------------------------------------------------------------------------------------------------------------------//
+uint32_t DPM86xxTelemetry::column(uint16_t uwDeviceV, Column_te teColumnV)
+{
+  uint8_t ubFieldsT = columnFields(teColumnV);
+
+  if ((aubFieldsP[uwDeviceV] & ubFieldsT) != ubFieldsT)
+  {
+    return 0;
+  }
+
+  switch (teColumnV)
+  {
+  case eCOLUMN_VOLTAGE:
+    return auwVoltageP[uwDeviceV];
+  case eCOLUMN_CURRENT:
+    return auwCurrentP[uwDeviceV];
+  case eCOLUMN_TEMPERATURE:
+    return auwTemperatureP[uwDeviceV];
+  default:
+    return aulPowerP[uwDeviceV];
+  }
+}
+
+//--------------------------------------------------------------------------------------------------------------------//
+//                                                                                                                    //
+//                                                                                                                    //
+//--------------------------------------------------------------------------------------------------------------------//
+uint16_t DPM86xxTelemetry::expire(uint32_t ulMaxAgeV)
+{
+  uint32_t ulNowT = millis();
+  uint16_t uwCountT = 0;
+
+  lock();
+  for (uint16_t uwDeviceT = 0; uwDeviceT < uwDeviceCountP; uwDeviceT++)
+  {
+    if ((aubFieldsP[uwDeviceT] != 0) && ((ulNowT - aulTimestampP[uwDeviceT]) > ulMaxAgeV))
+    {
+      aubFieldsP[uwDeviceT] = 0;
+      uwCountT++;
+    }
+  }
+  unlock();
+
+  return uwCountT;
+}
+
+//--------------------------------------------------------------------------------------------------------------------//
+//                                                                                                                    //
+//                                                                                                                    //
+//--------------------------------------------------------------------------------------------------------------------//
+template <typename T> DPM86xxTelemetry::Summary_ts DPM86xxTelemetry::summarize(const T atColumnV[], uint8_t ubFieldsV)
+{
+  Summary_ts tsSummaryT;
+  T tMinT = (T)~(T)0;
+  T tMaxT = 0;
+  uint64_t uqSumT = 0;
+  uint32_t ulCountT = 0;
+
+  //---------------------------------------------------------------------------------------------------
+  // unused device ids have no valid field, so the last block may contain them
+  //
+  uint32_t ulEndT = ((uwDeviceCountP + DPM86XX_TELEMETRY_BLOCK - 1) / DPM86XX_TELEMETRY_BLOCK) *
+                    DPM86XX_TELEMETRY_BLOCK;
+
+  //---------------------------------------------------------------------------------------------------
+  // the mask has all bits set for PSUs that provide the value. Values of other PSUs are set to all
+  // bits for the minimum and to 0 for maximum and sum, so the loop needs no branch.
+  //
+  for (uint32_t ulBlockT = 0; ulBlockT < ulEndT; ulBlockT += DPM86XX_TELEMETRY_BLOCK)
+  {
+    const T *ptValueT = &atColumnV[ulBlockT];
+    const uint8_t *pubFieldsT = &aubFieldsP[ulBlockT];
+    uint32_t ulBlockSumT = 0;
+
+    for (uint32_t ulIndexT = 0; ulIndexT < DPM86XX_TELEMETRY_BLOCK; ulIndexT++)
+    {
+      T tMaskT = (T)(0 - (((pubFieldsT[ulIndexT] & ubFieldsV) == ubFieldsV) ? 1 : 0));
+      T tLowT = (T)(ptValueT[ulIndexT] | (T)~tMaskT);
+      T tHighT = (T)(ptValueT[ulIndexT] & tMaskT);
+
+      tMinT = (tLowT < tMinT) ? tLowT : tMinT;
+      tMaxT = (tHighT > tMaxT) ? tHighT : tMaxT;
+      ulBlockSumT += tHighT;
+      ulCountT += tMaskT & 1;
+    }
+    uqSumT += ulBlockSumT;
+  }
+
+  tsSummaryT.uwCount = (uint16_t)ulCountT;
+  tsSummaryT.ulMin = (ulCountT > 0) ? (uint32_t)tMinT : 0xFFFFFFFF;
+  tsSummaryT.ulMax = tMaxT;
+  tsSummaryT.uqSum = uqSumT;
+
+  return tsSummaryT;
+}
+
+//--------------------------------------------------------------------------------------------------------------------//
+//                                                                                                                    //
+//                                                                                                                    //
+//--------------------------------------------------------------------------------------------------------------------//
+DPM86xxTelemetry::Summary_ts DPM86xxTelemetry::summary(Column_te teColumnV)
+{
+  Summary_ts tsSummaryT;
+  uint8_t ubFieldsT = columnFields(teColumnV);
+
+  lock();
+  switch (teColumnV)
+  {
+  case eCOLUMN_VOLTAGE:
+    tsSummaryT = summarize(auwVoltageP, ubFieldsT);
+    break;
+  case eCOLUMN_CURRENT:
+    tsSummaryT = summarize(auwCurrentP, ubFieldsT);
+    break;
+  case eCOLUMN_TEMPERATURE:
+    tsSummaryT = summarize(auwTemperatureP, ubFieldsT);
+    break;
+  default:
+    tsSummaryT = summarize(aulPowerP, ubFieldsT);
+    break;
+  }
+  unlock();
+
+  return tsSummaryT;
+}
+
+//--------------------------------------------------------------------------------------------------------------------//
+//                                                                                                                    //
+//                                                                                                                    //
+//--------------------------------------------------------------------------------------------------------------------//
+uint16_t DPM86xxTelemetry::constantCurrentCount()
+{
+  uint32_t ulCountT = 0;
+
+  lock();
+  for (uint16_t uwDeviceT = 0; uwDeviceT < uwDeviceCountP; uwDeviceT++)
+  {
+    ulCountT += aubConstantCurrentP[uwDeviceT] & (uint8_t)(aubFieldsP[uwDeviceT] / DPM86xx::eSNAP_CONSTANT_OUTPUT);
+  }
+  unlock();
+
+  return (uint16_t)ulCountT;
+}
+
+//--------------------------------------------------------------------------------------------------------------------//
+//                                                                                                                    //
+//                                                                                                                    //
+//--------------------------------------------------------------------------------------------------------------------//
+uint16_t DPM86xxTelemetry::findAbove(Column_te teColumnV, uint32_t ulLimitV, uint16_t auwDeviceR[], uint16_t uwSizeV)
+{
+  uint16_t uwCountT = 0;
+
+  lock();
+  for (uint16_t uwDeviceT = 0; uwDeviceT < uwDeviceCountP; uwDeviceT++)
+  {
+    if (column(uwDeviceT, teColumnV) > ulLimitV)
+    {
+      if (uwCountT < uwSizeV)
+      {
+        auwDeviceR[uwCountT] = uwDeviceT;
+      }
+      uwCountT++;
+    }
+  }
+  unlock();
+
+  return uwCountT;
+}
+
+//--------------------------------------------------------------------------------------------------------------------//
+//                                                                                                                    //
+//                                                                                                                    //
+//--------------------------------------------------------------------------------------------------------------------//
+uint16_t DPM86xxTelemetry::deviceCount()
+{
+  return uwDeviceCountP;
+}
+
+//--------------------------------------------------------------------------------------------------------------------//
+//                                                                                                                    //
+//                                                                                                                    //
+//--------------------------------------------------------------------------------------------------------------------//
+uint32_t DPM86xxTelemetry::value(uint16_t uwDeviceV, Column_te teColumnV)
+{
+  uint32_t ulValueT = 0;
+
+  if (uwDeviceV < DPM86XX_TELEMETRY_DEVICES_MAX)
+  {
+    lock();
+    ulValueT = column(uwDeviceV, teColumnV);
+    unlock();
+  }
+  return ulValueT;
+}
+
+//--------------------------------------------------------------------------------------------------------------------//
+//                                                                                                                    //
+//                                                                                                                    //
+//--------------------------------------------------------------------------------------------------------------------//
+uint32_t DPM86xxTelemetry::timestamp(uint16_t uwDeviceV)
+{
+  uint32_t ulTimeT = 0;
+
+  if (uwDeviceV < DPM86XX_TELEMETRY_DEVICES_MAX)
+  {
+    lock();
+    ulTimeT = aulTimestampP[uwDeviceV];
+    unlock();
+  }
+  return ulTimeT;
+}
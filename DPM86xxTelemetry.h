@@ -0,0 +1,208 @@
+//====================================================================================================================//
+// File:          DPM86xxTelemetry.h                                                                                  //
+// Description:   DPM86xxTelemetry Class definition, measured values of many PSUs stored column by column             //
+// Author:        Tiderko                                                                                             //
+//--------------------------------------------------------------------------------------------------------------------//
+//                                                                                                                    //
+//====================================================================================================================//
+
+#ifndef DPM86xxTelemetry_h
+#define DPM86xxTelemetry_h
+
+#include "DPM86xx.h"
+
+#if defined(ESP32) || !defined(ARDUINO)
+#ifdef ARDUINO
+#include <freertos/FreeRTOS.h>
+#include <freertos/semphr.h>
+#else
+#include <mutex>
+#endif
+#endif
+
+/**
+ * @brief Maximal number of PSUs whose values are stored by a \c DPM86xxTelemetry
+ *
+ */
+#ifndef DPM86XX_TELEMETRY_DEVICES_MAX
+#define DPM86XX_TELEMETRY_DEVICES_MAX 1024
+#endif
+
+/**
+ * @brief Number of PSUs that are evaluated by one inner loop of a query
+ *
+ * The inner loop has a fixed number of iterations, so the compiler vectorizes it also with the cost model of -O2.
+ * \c #DPM86XX_TELEMETRY_DEVICES_MAX must be a multiple of it. The sum of one block is calculated in 32 bit, so
+ * at most 2048 is allowed.
+ */
+#ifndef DPM86XX_TELEMETRY_BLOCK
+#define DPM86XX_TELEMETRY_BLOCK 256
+#endif
+
+static_assert((DPM86XX_TELEMETRY_DEVICES_MAX % DPM86XX_TELEMETRY_BLOCK) == 0,
+              "DPM86XX_TELEMETRY_DEVICES_MAX must be a multiple of DPM86XX_TELEMETRY_BLOCK");
+static_assert((DPM86XX_TELEMETRY_BLOCK > 0) && (DPM86XX_TELEMETRY_BLOCK <= 2048),
+              "DPM86XX_TELEMETRY_BLOCK must be in range from 1 to 2048");
+
+/**
+ * @brief Measured values of many PSUs, stored as one array per value and indexed by a device id
+ *
+ * A query over all PSUs, e.g. the maximal temperature, reads one contiguous array instead of one member of each
+ * \c DPM86xx object. The power is calculated once when the values are stored. The loops of the queries have no
+ * branches and evaluate blocks of \c #DPM86XX_TELEMETRY_BLOCK PSUs, so the compiler can vectorize them.
+ *
+ * On ESP32 and on a host, updates and queries are protected by a lock, so a \c DPM86xxFleet can update the values
+ * from its workers while the application runs queries.
+ */
+class DPM86xxTelemetry
+{
+public:
+  /**
+   * @brief Value that is evaluated by summary()
+   */
+  typedef enum Column_e
+  {
+    /**
+     * @brief Measured voltage in [10 mV]
+     */
+    eCOLUMN_VOLTAGE = 0,
+
+    /**
+     * @brief Measured current in [mA]
+     */
+    eCOLUMN_CURRENT,
+
+    /**
+     * @brief Temperature in [deg C]
+     */
+    eCOLUMN_TEMPERATURE,
+
+    /**
+     * @brief Power in [mW], calculated from measured voltage and current
+     */
+    eCOLUMN_POWER
+  } Column_te;
+
+  /**
+   * @brief Result of summary()
+   */
+  typedef struct Summary_s
+  {
+    /**
+     * @brief Number of PSUs that provide a valid value
+     */
+    uint16_t uwCount;
+
+    uint32_t ulMin;
+    uint32_t ulMax;
+    uint64_t uqSum;
+  } Summary_ts;
+
+  DPM86xxTelemetry();
+
+  /**
+   * @brief Store the values of a snapshot
+   *
+   * @param[in] uwDeviceV device id in range from 0 to \c #DPM86XX_TELEMETRY_DEVICES_MAX - 1
+   * @param[in] tsSnapshotV snapshot, only the fields given by \c ubFields are stored
+   */
+  void update(uint16_t uwDeviceV, const DPM86xx::Snapshot_ts &tsSnapshotV);
+
+  /**
+   * @brief Store the values of several snapshots under one lock
+   *
+   * @param[in] uwFirstDeviceV device id of the first snapshot, the following ones get the next ids
+   * @param[in] atsSnapshotV snapshots
+   * @param[in] uwCountV number of snapshots
+   */
+  void update(uint16_t uwFirstDeviceV, const DPM86xx::Snapshot_ts atsSnapshotV[], uint16_t uwCountV);
+
+  /**
+   * @brief Mark all values of a PSU as not valid, e.g. after a failed read
+   *
+   * @param[in] uwDeviceV device id
+   */
+  void invalidate(uint16_t uwDeviceV);
+
+  /**
+   * @brief Mark the values of all PSUs as not valid, that have not been updated for a given time
+   *
+   * @param[in] ulMaxAgeV maximal age in [ms] of the values
+   * @return number of PSUs whose values have been marked as not valid
+   */
+  uint16_t expire(uint32_t ulMaxAgeV);
+
+  /**
+   * @brief Calculate minimum, maximum and sum of one value over all PSUs that provide a valid value
+   *
+   * @param[in] teColumnV value
+   * @return summary, \c ulMin is 0xFFFFFFFF if no PSU provides a valid value
+   */
+  Summary_ts summary(Column_te teColumnV);
+
+  /**
+   * @brief Returns the number of PSUs in constant current mode
+   */
+  uint16_t constantCurrentCount();
+
+  /**
+   * @brief Find the PSUs whose value exceeds a limit, e.g. for an over temperature alarm
+   *
+   * @param[in] teColumnV value
+   * @param[in] ulLimitV limit in the unit of the value
+   * @param[out] auwDeviceR device ids of the PSUs that exceed the limit
+   * @param[in] uwSizeV number of elements of \p auwDeviceR
+   * @return number of PSUs that exceed the limit, may be larger than \p uwSizeV
+   */
+  uint16_t findAbove(Column_te teColumnV, uint32_t ulLimitV, uint16_t auwDeviceR[], uint16_t uwSizeV);
+
+  /**
+   * @brief Returns the number of device ids in use, the highest id plus one
+   */
+  uint16_t deviceCount();
+
+  /**
+   * @brief Returns a value of one PSU, 0 if it is not valid
+   *
+   * @param[in] uwDeviceV device id
+   * @param[in] teColumnV value
+   */
+  uint32_t value(uint16_t uwDeviceV, Column_te teColumnV);
+
+  /**
+   * @brief Returns the time in [ms] given by millis() when the values of a PSU have been stored
+   *
+   * @param[in] uwDeviceV device id
+   */
+  uint32_t timestamp(uint16_t uwDeviceV);
+
+private:
+  void lock();
+  void unlock();
+  void store(uint16_t uwDeviceV, const DPM86xx::Snapshot_ts &tsSnapshotV);
+  uint32_t column(uint16_t uwDeviceV, Column_te teColumnV);
+  static uint8_t columnFields(Column_te teColumnV);
+  template <typename T> Summary_ts summarize(const T atColumnV[], uint8_t ubFieldsV);
+
+  //---------------------------------------------------------------------------------------------------
+  // one array for each value, the valid fields of each PSU are given as DPM86xx::SnapshotField_e
+  //
+  uint16_t auwVoltageP[DPM86XX_TELEMETRY_DEVICES_MAX];
+  uint16_t auwCurrentP[DPM86XX_TELEMETRY_DEVICES_MAX];
+  uint16_t auwTemperatureP[DPM86XX_TELEMETRY_DEVICES_MAX];
+  uint32_t aulPowerP[DPM86XX_TELEMETRY_DEVICES_MAX];
+  uint8_t aubConstantCurrentP[DPM86XX_TELEMETRY_DEVICES_MAX];
+  uint8_t aubFieldsP[DPM86XX_TELEMETRY_DEVICES_MAX];
+  uint32_t aulTimestampP[DPM86XX_TELEMETRY_DEVICES_MAX];
+  uint16_t uwDeviceCountP;
+
+#if defined(ESP32) || !defined(ARDUINO)
+#ifdef ARDUINO
+  SemaphoreHandle_t pvLockP;
+#else
+  std::mutex clLockP;
+#endif
+#endif
+};
+
+#endif
@@ -0,0 +1,143 @@
+//====================================================================================================================//
+// File:          DPM86xxTransport.cpp                                                                                //
+// Description:   Byte stream transport implementation for HardwareSerial                                             //
+// Author:        Tiderko                                                                                             //
+//--------------------------------------------------------------------------------------------------------------------//
+//                                                                                                                    //
+//====================================================================================================================//
+
+#include <DPM86xxTransport.h>
+
+#ifndef ARDUINO
+#include "DPM86xxHost.h"
+#endif
+
+//--------------------------------------------------------------------------------------------------------------------//
+//                                                                                                                    //
+//                                                                                                                    //
+//--------------------------------------------------------------------------------------------------------------------//
+bool DPM86xxTransport::waitReadable(uint32_t ulTimeoutV)
+{
+  uint32_t ulStartT = micros();
+
+  while (available() <= 0)
+  {
+    if (((uint32_t)micros() - ulStartT) >= ulTimeoutV)
+    {
+      return false;
+    }
+    yield();
+  }
+
+  return true;
+}
+
+#ifdef ARDUINO
+
+//--------------------------------------------------------------------------------------------------------------------//
+//                                                                                                                    //
+//                                                                                                                    //
+//--------------------------------------------------------------------------------------------------------------------//
+DPM86xxSerial::DPM86xxSerial()
+{
+  pclSeralP = nullptr;
+#ifdef ESP32
+  pvReceiveP = nullptr;
+#endif
+}
+
+//--------------------------------------------------------------------------------------------------------------------//
+//                                                                                                                    //
+//                                                                                                                    //
+//--------------------------------------------------------------------------------------------------------------------//
+void DPM86xxSerial::init(HardwareSerial &clSerialIfR)
+{
+  pclSeralP = &clSerialIfR;
+
+#ifdef ESP32
+  //---------------------------------------------------------------------------------------------------
+  // the callback is called by the UART event task whenever data has been received
+  //
+  if (pvReceiveP == nullptr)
+  {
+    pvReceiveP = xSemaphoreCreateBinary();
+  }
+  SemaphoreHandle_t pvReceiveT = pvReceiveP;
+  pclSeralP->onReceive([pvReceiveT]() { xSemaphoreGive(pvReceiveT); });
+#endif
+}
+
+//--------------------------------------------------------------------------------------------------------------------//
+//                                                                                                                    //
+//                                                                                                                    //
+//--------------------------------------------------------------------------------------------------------------------//
+int32_t DPM86xxSerial::available()
+{
+  return (int32_t)pclSeralP->available();
+}
+
+//--------------------------------------------------------------------------------------------------------------------//
+//                                                                                                                    //
+//                                                                                                                    //
+//--------------------------------------------------------------------------------------------------------------------//
+int32_t DPM86xxSerial::read()
+{
+  return (int32_t)pclSeralP->read();
+}
+
+//--------------------------------------------------------------------------------------------------------------------//
+//                                                                                                                    //
+//                                                                                                                    //
+//--------------------------------------------------------------------------------------------------------------------//
+size_t DPM86xxSerial::write(const uint8_t *pubDataV, size_t ulSizeV)
+{
+  return pclSeralP->write(pubDataV, ulSizeV);
+}
+
+//--------------------------------------------------------------------------------------------------------------------//
+//                                                                                                                    //
+//                                                                                                                    //
+//--------------------------------------------------------------------------------------------------------------------//
+void DPM86xxSerial::flush()
+{
+  pclSeralP->flush();
+}
+
+//--------------------------------------------------------------------------------------------------------------------//
+//                                                                                                                    //
+//                                                                                                                    //
+//--------------------------------------------------------------------------------------------------------------------//
+uint32_t DPM86xxSerial::baudRate()
+{
+  return (uint32_t)pclSeralP->baudRate();
+}
+
+#ifdef ESP32
+//--------------------------------------------------------------------------------------------------------------------//
+//                                                                                                                    //
+//                                                                                                                    //
+//--------------------------------------------------------------------------------------------------------------------//
+bool DPM86xxSerial::waitReadable(uint32_t ulTimeoutV)
+{
+  uint32_t ulStartT = micros();
+  uint32_t ulElapsedT;
+
+  //---------------------------------------------------------------------------------------------------
+  // the semaphore may have been given for bytes that have already been read, so check again after
+  // each wake up
+  //
+  while (pclSeralP->available() <= 0)
+  {
+    ulElapsedT = (uint32_t)micros() - ulStartT;
+    if (ulElapsedT >= ulTimeoutV)
+    {
+      return false;
+    }
+    xSemaphoreTake(pvReceiveP, pdMS_TO_TICKS(((ulTimeoutV - ulElapsedT) + 999) / 1000));
+  }
+
+  return true;
+}
+#endif
+
+#endif
@@ -0,0 +1,110 @@
+//====================================================================================================================//
+// File:          DPM86xxTransport.h                                                                                  //
+// Description:   Byte stream transport used by DPM86xx Class                                                         //
+// Author:        Tiderko                                                                                             //
+//--------------------------------------------------------------------------------------------------------------------//
+//                                                                                                                    //
+//====================================================================================================================//
+
+#ifndef DPM86xxTransport_h
+#define DPM86xxTransport_h
+
+#include <stddef.h>
+#include <stdint.h>
+
+/**
+ * @brief Interface of a byte stream, that is used by DPM86xx to transmit requests and receive responses
+ *
+ * The methods have the same meaning as the corresponding ones of the Arduino \c HardwareSerial class.
+ */
+class DPM86xxTransport
+{
+public:
+  virtual ~DPM86xxTransport() {}
+
+  /**
+   * @brief Returns the number of bytes that can be read without waiting
+   */
+  virtual int32_t available() = 0;
+
+  /**
+   * @brief Read one byte
+   * @return value of the byte or -1 if no byte is available
+   */
+  virtual int32_t read() = 0;
+
+  /**
+   * @brief Write bytes to the stream
+   *
+   * @param[in] pubDataV pointer to the data that should be written
+   * @param[in] ulSizeV number of bytes that should be written
+   * @return number of written bytes
+   */
+  virtual size_t write(const uint8_t *pubDataV, size_t ulSizeV) = 0;
+
+  /**
+   * @brief Wait until all written bytes have been transmitted
+   */
+  virtual void flush() = 0;
+
+  /**
+   * @brief Returns the baud rate of the stream, used to calculate timing values
+   */
+  virtual uint32_t baudRate() = 0;
+
+  /**
+   * @brief Wait until at least one byte can be read
+   *
+   * @param[in] ulTimeoutV maximal time in [us] to wait
+   * @return \c true if a byte is available, \c false if the time has expired
+   *
+   * The default implementation checks available() in a loop and only passes control to other tasks meanwhile.
+   * Transports that are notified about received data override it, so the waiting task sleeps.
+   */
+  virtual bool waitReadable(uint32_t ulTimeoutV);
+};
+
+#ifdef ARDUINO
+#include "Arduino.h"
+
+#ifdef ESP32
+#include <freertos/FreeRTOS.h>
+#include <freertos/semphr.h>
+#endif
+
+/**
+ * @brief Transport that uses an Arduino \c HardwareSerial interface
+ *
+ * On ESP32 the receive callback of the interface gives a semaphore, so waitReadable() sleeps until data has been
+ * received. The received bytes are buffered by the UART driver until they are read.
+ */
+class DPM86xxSerial : public DPM86xxTransport
+{
+public:
+  DPM86xxSerial();
+
+  /**
+   * @brief Initialisation of object parameters
+   *
+   * @param[in] clSerialIfR interface, that should be used by this object
+   */
+  void init(HardwareSerial &clSerialIfR);
+
+  int32_t available() override;
+  int32_t read() override;
+  size_t write(const uint8_t *pubDataV, size_t ulSizeV) override;
+  void flush() override;
+  uint32_t baudRate() override;
+#ifdef ESP32
+  bool waitReadable(uint32_t ulTimeoutV) override;
+#endif
+
+private:
+  HardwareSerial *pclSeralP;
+#ifdef ESP32
+  SemaphoreHandle_t pvReceiveP;
+#endif
+};
+#endif
+
+#endif
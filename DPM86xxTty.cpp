@@ -0,0 +1,279 @@
+//====================================================================================================================//
+// File:          DPM86xxTty.cpp                                                                                      //
+// Description:   Transport that uses a serial device of a Linux host implementation                                  //
+// Author:        Tiderko                                                                                             //
+//--------------------------------------------------------------------------------------------------------------------//
+//                                                                                                                    //
+//====================================================================================================================//
+
+#include <DPM86xxTty.h>
+
+#if !defined(ARDUINO) && defined(__linux__)
+
+#include <errno.h>
+#include <fcntl.h>
+#include <sys/epoll.h>
+#include <sys/ioctl.h>
+#include <termios.h>
+#include <unistd.h>
+
+//--------------------------------------------------------------------------------------------------------------------//
+//                                                                                                                    //
+//                                                                                                                    //
+//--------------------------------------------------------------------------------------------------------------------//
+DPM86xxTty::DPM86xxTty()
+{
+  slDeviceP = -1;
+  slEpollP = -1;
+  ulBaudRateP = 9600;
+  ubBufferLengthP = 0;
+  ubBufferReadP = 0;
+}
+
+//--------------------------------------------------------------------------------------------------------------------//
+//                                                                                                                    //
+//                                                                                                                    //
+//--------------------------------------------------------------------------------------------------------------------//
+DPM86xxTty::~DPM86xxTty()
+{
+  close();
+}
+
+//--------------------------------------------------------------------------------------------------------------------//
+//                                                                                                                    //
+//                                                                                                                    //
+//--------------------------------------------------------------------------------------------------------------------//
+bool DPM86xxTty::open(const char *pszDeviceV, uint32_t ulBaudRateV)
+{
+  struct termios tsTermT;
+  struct epoll_event tsEventT;
+  speed_t ulSpeedT;
+
+  switch (ulBaudRateV)
+  {
+  case 1200:
+    ulSpeedT = B1200;
+    break;
+  case 2400:
+    ulSpeedT = B2400;
+    break;
+  case 4800:
+    ulSpeedT = B4800;
+    break;
+  case 9600:
+    ulSpeedT = B9600;
+    break;
+  case 19200:
+    ulSpeedT = B19200;
+    break;
+  case 38400:
+    ulSpeedT = B38400;
+    break;
+  case 57600:
+    ulSpeedT = B57600;
+    break;
+  case 115200:
+    ulSpeedT = B115200;
+    break;
+  default:
+    return false;
+  }
+
+  close();
+
+  //---------------------------------------------------------------------------------------------------
+  // open the device non-blocking and configure raw 8N1 transmission
+  //
+  slDeviceP = ::open(pszDeviceV, O_RDWR | O_NOCTTY | O_NONBLOCK);
+  if (slDeviceP < 0)
+  {
+    return false;
+  }
+
+  if (tcgetattr(slDeviceP, &tsTermT) != 0)
+  {
+    close();
+    return false;
+  }
+  cfmakeraw(&tsTermT);
+  tsTermT.c_cflag |= (CLOCAL | CREAD);
+  tsTermT.c_cflag &= ~(CSTOPB | CRTSCTS);
+  cfsetispeed(&tsTermT, ulSpeedT);
+  cfsetospeed(&tsTermT, ulSpeedT);
+  if (tcsetattr(slDeviceP, TCSANOW, &tsTermT) != 0)
+  {
+    close();
+    return false;
+  }
+  tcflush(slDeviceP, TCIOFLUSH);
+
+  //---------------------------------------------------------------------------------------------------
+  // the epoll instance wakes up waitReadable() as soon as data has been received
+  //
+  slEpollP = epoll_create1(0);
+  tsEventT.events = EPOLLIN;
+  tsEventT.data.fd = slDeviceP;
+  if ((slEpollP < 0) || (epoll_ctl(slEpollP, EPOLL_CTL_ADD, slDeviceP, &tsEventT) != 0))
+  {
+    close();
+    return false;
+  }
+
+  ulBaudRateP = ulBaudRateV;
+  ubBufferLengthP = 0;
+  ubBufferReadP = 0;
+
+  return true;
+}
+
+//--------------------------------------------------------------------------------------------------------------------//
+//                                                                                                                    //
+//                                                                                                                    //
+//--------------------------------------------------------------------------------------------------------------------//
+void DPM86xxTty::close()
+{
+  if (slEpollP >= 0)
+  {
+    ::close(slEpollP);
+    slEpollP = -1;
+  }
+  if (slDeviceP >= 0)
+  {
+    ::close(slDeviceP);
+    slDeviceP = -1;
+  }
+}
+
+//--------------------------------------------------------------------------------------------------------------------//
+//                                                                                                                    //
+//                                                                                                                    //
+//--------------------------------------------------------------------------------------------------------------------//
+void DPM86xxTty::fill()
+{
+  ssize_t slCountT;
+
+  if ((ubBufferReadP < ubBufferLengthP) || (slDeviceP < 0))
+  {
+    return;
+  }
+
+  slCountT = ::read(slDeviceP, aubBufferP, sizeof(aubBufferP));
+  ubBufferReadP = 0;
+  ubBufferLengthP = (slCountT > 0) ? (uint8_t)slCountT : 0;
+}
+
+//--------------------------------------------------------------------------------------------------------------------//
+//                                                                                                                    //
+//                                                                                                                    //
+//--------------------------------------------------------------------------------------------------------------------//
+int32_t DPM86xxTty::available()
+{
+  int slPendingT = 0;
+
+  fill();
+  if ((slDeviceP >= 0) && (ioctl(slDeviceP, FIONREAD, &slPendingT) != 0))
+  {
+    slPendingT = 0;
+  }
+
+  return (int32_t)(ubBufferLengthP - ubBufferReadP) + (int32_t)slPendingT;
+}
+
+//--------------------------------------------------------------------------------------------------------------------//
+//                                                                                                                    //
+//                                                                                                                    //
+//--------------------------------------------------------------------------------------------------------------------//
+int32_t DPM86xxTty::read()
+{
+  fill();
+  if (ubBufferReadP >= ubBufferLengthP)
+  {
+    return -1;
+  }
+  return (int32_t)aubBufferP[ubBufferReadP++];
+}
+
+//--------------------------------------------------------------------------------------------------------------------//
+//                                                                                                                    //
+//                                                                                                                    //
+//--------------------------------------------------------------------------------------------------------------------//
+size_t DPM86xxTty::write(const uint8_t *pubDataV, size_t ulSizeV)
+{
+  size_t ulWrittenT = 0;
+  ssize_t slCountT;
+
+  while ((slDeviceP >= 0) && (ulWrittenT < ulSizeV))
+  {
+    slCountT = ::write(slDeviceP, &pubDataV[ulWrittenT], ulSizeV - ulWrittenT);
+    if (slCountT > 0)
+    {
+      ulWrittenT += (size_t)slCountT;
+    }
+    else if ((slCountT < 0) && ((errno == EAGAIN) || (errno == EWOULDBLOCK)))
+    {
+      //-------------------------------------------------------------------------------------------
+      // the transmit buffer of the driver is full, wait until it has been sent
+      //
+      tcdrain(slDeviceP);
+    }
+    else if ((slCountT < 0) && (errno == EINTR))
+    {
+      continue;
+    }
+    else
+    {
+      //-------------------------------------------------------------------------------------------
+      // the device can not be written, e.g. the adapter has been unplugged
+      //
+      break;
+    }
+  }
+
+  return ulWrittenT;
+}
+
+//--------------------------------------------------------------------------------------------------------------------//
+//                                                                                                                    //
+//                                                                                                                    //
+//--------------------------------------------------------------------------------------------------------------------//
+void DPM86xxTty::flush()
+{
+  if (slDeviceP >= 0)
+  {
+    tcdrain(slDeviceP);
+  }
+}
+
+//--------------------------------------------------------------------------------------------------------------------//
+//                                                                                                                    //
+//                                                                                                                    //
+//--------------------------------------------------------------------------------------------------------------------//
+uint32_t DPM86xxTty::baudRate()
+{
+  return ulBaudRateP;
+}
+
+//--------------------------------------------------------------------------------------------------------------------//
+//                                                                                                                    //
+//                                                                                                                    //
+//--------------------------------------------------------------------------------------------------------------------//
+bool DPM86xxTty::waitReadable(uint32_t ulTimeoutV)
+{
+  struct epoll_event tsEventT;
+
+  if (available() > 0)
+  {
+    return true;
+  }
+  if (slEpollP < 0)
+  {
+    return false;
+  }
+
+  //---------------------------------------------------------------------------------------------------
+  // epoll_wait() accepts the timeout in [ms], so it is rounded up
+  //
+  return (epoll_wait(slEpollP, &tsEventT, 1, (int)((ulTimeoutV + 999) / 1000)) > 0);
+}
+
+#endif
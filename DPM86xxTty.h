@@ -0,0 +1,70 @@
+//====================================================================================================================//
+// File:          DPM86xxTty.h                                                                                        //
+// Description:   Transport that uses a serial device of a Linux host, e.g. /dev/ttyUSB0                              //
+// Author:        Tiderko                                                                                             //
+//--------------------------------------------------------------------------------------------------------------------//
+//                                                                                                                    //
+//====================================================================================================================//
+
+#ifndef DPM86xxTty_h
+#define DPM86xxTty_h
+
+#if !defined(ARDUINO) && defined(__linux__)
+
+#include "DPM86xxHost.h"
+#include "DPM86xxTransport.h"
+
+/**
+ * @brief Number of byte that are read from the device with one system call
+ *
+ */
+#define DPM86XX_TTY_BUFFER 64
+
+/**
+ * @brief Transport that uses a serial device of a Linux host
+ *
+ * The device is configured for raw 8N1 transmission. waitReadable() sleeps in \c epoll_wait() until the device
+ * becomes readable, so no CPU time is used while waiting for a response.
+ */
+class DPM86xxTty : public DPM86xxTransport
+{
+public:
+  DPM86xxTty();
+  ~DPM86xxTty();
+
+  /**
+   * @brief Open and configure the serial device
+   *
+   * @param[in] pszDeviceV path of the device, e.g. "/dev/ttyUSB0"
+   * @param[in] ulBaudRateV baud rate, one of the standard values from 1200 to 115200
+   * @return \c true on success
+   */
+  bool open(const char *pszDeviceV, uint32_t ulBaudRateV);
+
+  /**
+   * @brief Close the serial device
+   */
+  void close();
+
+  int32_t available() override;
+  int32_t read() override;
+  size_t write(const uint8_t *pubDataV, size_t ulSizeV) override;
+  void flush() override;
+  uint32_t baudRate() override;
+  bool waitReadable(uint32_t ulTimeoutV) override;
+
+private:
+  void fill();
+
+  int32_t slDeviceP;
+  int32_t slEpollP;
+  uint32_t ulBaudRateP;
+
+  uint8_t aubBufferP[DPM86XX_TTY_BUFFER];
+  uint8_t ubBufferLengthP;
+  uint8_t ubBufferReadP;
+};
+
+#endif
+
+#endif
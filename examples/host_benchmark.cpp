@@ -0,0 +1,1277 @@
+//====================================================================================================================//
+// File:          host_benchmark.cpp                                                                                  //
+// Description:   Measure throughput and latency of DPM86xx with a simulated PSU on a host (e.g. Linux)               //
+// Author:        Tiderko                                                                                             //
+//--------------------------------------------------------------------------------------------------------------------//
+//                                                                                                                    //
+//====================================================================================================================//
+
+/*--------------------------------------------------------------------------------------------------------------------*\
+** Build and run from the root directory of the library:                                                              **
+**                                                                                                                    **
+**   g++ -std=c++17 -O2 -I. *.cpp examples/host_benchmark.cpp -o host_benchmark -lpthread                             **
+**   ./host_benchmark                                                                                                 **
+**                                                                                                                    **
+** Add -DDPM86XX_LEGACY_PARSER to compare the single-pass response parser with the former one.                        **
+**                                                                                                                    **
+** The program returns a non-zero exit code if a check fails, e.g. a transaction allocated heap memory.              **
+\*--------------------------------------------------------------------------------------------------------------------*/
+
+/*--------------------------------------------------------------------------------------------------------------------*\
+** include files                                                                                                      **
+**                                                                                                                    **
+\*--------------------------------------------------------------------------------------------------------------------*/
+#include <DPM86xx.h>
+#include <DPM86xxBus.h>
+#include <DPM86xxClient.h>
+#include <DPM86xxEnergy.h>
+#include <DPM86xxFleet.h>
+#include <DPM86xxProfile.h>
+#include <DPM86xxRegulator.h>
+#include <DPM86xxSim.h>
+#include <DPM86xxSweep.h>
+#include <DPM86xxTelemetry.h>
+#include <atomic>
+#include <new>
+#include <stdio.h>
+#include <time.h>
+#include <thread>
+#ifdef DPM86XX_LEGACY_PARSER
+#include <string>
+#include <unistd.h>
+#include <vector>
+#endif
+
+/**
+ * @brief Number of transactions used for each measurement
+ *
+ */
+#define BENCHMARK_TRANSACTIONS 200
+
+/**
+ * @brief Number of output off requests used for the measurement of the scheduler
+ *
+ */
+#define BENCHMARK_SAFETY_REQUESTS 20
+
+/**
+ * @brief Number of threads that share one PSU by a client
+ *
+ */
+#define BENCHMARK_CLIENT_THREADS 4
+
+/**
+ * @brief Number of PSUs on each simulated serial interface of a fleet
+ *
+ */
+#define BENCHMARK_FLEET_DEVICES 4
+
+/**
+ * @brief Number of simulated PSUs stored in a telemetry table
+ *
+ */
+#define BENCHMARK_TELEMETRY_DEVICES 1000
+
+/**
+ * @brief Number of queries used for the comparison of telemetry table and fleet readings
+ *
+ */
+#define BENCHMARK_QUERIES 10000
+
+/**
+ * @brief Number of conversions used for the comparison of float and integer API
+ *
+ */
+#define BENCHMARK_CONVERSIONS 1000000
+
+/**
+ * @brief Time in [ms] between two steps of the ramp used for the measurement of profiles
+ *
+ */
+#define BENCHMARK_RAMP_STEP 20
+
+/**
+ * @brief Fixed delay in [ms] after each setpoint, that is replaced by the settling detection of a sweep
+ *
+ */
+#define BENCHMARK_SETTLE_DELAY 2000
+
+/**
+ * @brief Number of transactions that are made before the heap allocations are counted
+ *
+ */
+#define BENCHMARK_WARM_UP 10
+
+/**
+ * @brief Number of rounds over all response frames for the comparison of the parsers
+ *
+ */
+#define BENCHMARK_PARSER_ROUNDS 100
+
+/**
+ * @brief Number of random response frames for the comparison of the parsers
+ *
+ */
+#define BENCHMARK_RANDOM_FRAMES 20000
+
+/*--------------------------------------------------------------------------------------------------------------------*\
+** heap allocations                                                                                                   **
+**                                                                                                                    **
+** malloc() and operator new are replaced by versions that count each call, so the number of heap allocations of a    **
+** transaction can be checked. malloc() is forwarded to the glibc implementation.                                     **
+\*--------------------------------------------------------------------------------------------------------------------*/
+static std::atomic<uint32_t> ulAllocationsS(0);
+
+#ifdef __GLIBC__
+extern "C" void *__libc_malloc(size_t ulSizeV);
+extern "C" void *__libc_calloc(size_t ulCountV, size_t ulSizeV);
+extern "C" void *__libc_realloc(void *pvMemoryV, size_t ulSizeV);
+
+extern "C" void *malloc(size_t ulSizeV)
+{
+  ulAllocationsS++;
+  return __libc_malloc(ulSizeV);
+}
+
+extern "C" void *calloc(size_t ulCountV, size_t ulSizeV)
+{
+  ulAllocationsS++;
+  return __libc_calloc(ulCountV, ulSizeV);
+}
+
+extern "C" void *realloc(void *pvMemoryV, size_t ulSizeV)
+{
+  ulAllocationsS++;
+  return __libc_realloc(pvMemoryV, ulSizeV);
+}
+#endif
+
+void *operator new(size_t ulSizeV)
+{
+  void *pvMemoryT;
+
+  ulAllocationsS++;
+#ifdef __GLIBC__
+  pvMemoryT = __libc_malloc((ulSizeV > 0) ? ulSizeV : 1);
+#else
+  pvMemoryT = malloc((ulSizeV > 0) ? ulSizeV : 1);
+#endif
+  if (pvMemoryT == nullptr)
+  {
+    throw std::bad_alloc();
+  }
+  return pvMemoryT;
+}
+
+void *operator new[](size_t ulSizeV)
+{
+  return operator new(ulSizeV);
+}
+
+void operator delete(void *pvMemoryV) noexcept
+{
+  free(pvMemoryV);
+}
+
+void operator delete[](void *pvMemoryV) noexcept
+{
+  free(pvMemoryV);
+}
+
+void operator delete(void *pvMemoryV, size_t) noexcept
+{
+  free(pvMemoryV);
+}
+
+void operator delete[](void *pvMemoryV, size_t) noexcept
+{
+  free(pvMemoryV);
+}
+
+/**
+ * @brief Number of failed checks, returned by main()
+ */
+static uint32_t ulFailedChecksS = 0;
+
+//--------------------------------------------------------------------------------------------------------------------//
+//                                                                                                                    //
+//                                                                                                                    //
+//--------------------------------------------------------------------------------------------------------------------//
+static void benchmarkReads(uint32_t ulBaudRateV, DPM86xx::Guard_te teGuardV)
+{
+  DPM86xxSim clBusT;
+  DPM86xx clPsuT;
+  uint32_t ulStartT;
+  uint32_t ulTimeT;
+  uint32_t ulMaxLatencyT = 0;
+  uint32_t ulErrorsT = 0;
+
+  clBusT.init(ulBaudRateV);
+  clBusT.addDevice(1, 8624);
+  clPsuT.init(clBusT, 1);
+  clPsuT.setGuardMode(teGuardV);
+
+  ulStartT = micros();
+  for (uint32_t ulCountT = 0; ulCountT < BENCHMARK_TRANSACTIONS; ulCountT++)
+  {
+    ulTimeT = micros();
+    if (clPsuT.readFunction(DPM86xx::eFUNC_MEASURED_VOLTAGE) < 0)
+    {
+      ulErrorsT++;
+    }
+    ulTimeT = micros() - ulTimeT;
+    if (ulTimeT > ulMaxLatencyT)
+    {
+      ulMaxLatencyT = ulTimeT;
+    }
+  }
+  ulTimeT = micros() - ulStartT;
+
+  printf("%6u baud, %s guard: %7.1f transactions/s, mean latency %6u us, max latency %6u us, errors %u\n",
+         (unsigned)ulBaudRateV, (teGuardV == DPM86xx::eGUARD_FIXED) ? "fixed" : "baud ",
+         (BENCHMARK_TRANSACTIONS * 1000000.0) / ulTimeT, (unsigned)(ulTimeT / BENCHMARK_TRANSACTIONS),
+         (unsigned)ulMaxLatencyT, (unsigned)ulErrorsT);
+}
+
+//--------------------------------------------------------------------------------------------------------------------//
+//                                                                                                                    //
+//                                                                                                                    //
+//--------------------------------------------------------------------------------------------------------------------//
+static void benchmarkSnapshots(uint32_t ulBaudRateV, DPM86xx::Protocol_te teProtocolV)
+{
+  DPM86xxSim clBusT;
+  DPM86xx clPsuT;
+  DPM86xx::Snapshot_ts tsSnapshotT;
+  uint32_t ulTimeT;
+  uint32_t ulErrorsT = 0;
+
+  clBusT.init(ulBaudRateV);
+  clBusT.addDevice(1, 8624);
+  clBusT.setModbus(teProtocolV == DPM86xx::ePROTOCOL_MODBUS);
+  clPsuT.init(clBusT, 1);
+  clPsuT.setProtocol(teProtocolV);
+  clPsuT.setGuardMode(DPM86xx::eGUARD_BAUD);
+
+  ulTimeT = micros();
+  for (uint32_t ulCountT = 0; ulCountT < BENCHMARK_TRANSACTIONS; ulCountT++)
+  {
+    if (clPsuT.readSnapshot(tsSnapshotT) != DPM86xx::eSTATUS_OK)
+    {
+      ulErrorsT++;
+    }
+  }
+  ulTimeT = micros() - ulTimeT;
+
+  printf("%6u baud, %s: %7.1f snapshots/s, errors %u\n", (unsigned)ulBaudRateV,
+         (teProtocolV == DPM86xx::ePROTOCOL_MODBUS) ? "Modbus" : "ASCII ",
+         (BENCHMARK_TRANSACTIONS * 1000000.0) / ulTimeT, (unsigned)ulErrorsT);
+}
+
+//--------------------------------------------------------------------------------------------------------------------//
+//                                                                                                                    //
+//                                                                                                                    //
+//--------------------------------------------------------------------------------------------------------------------//
+static void benchmarkReceive(uint32_t ulBaudRateV, DPM86xx::Receive_te teReceiveV)
+{
+  DPM86xxSim clBusT;
+  DPM86xx clPsuT;
+  uint32_t ulTimeT;
+  clock_t slCpuT;
+  uint32_t ulErrorsT = 0;
+
+  clBusT.init(ulBaudRateV);
+  clBusT.addDevice(1, 8624);
+  clPsuT.init(clBusT, 1);
+  clPsuT.setGuardMode(DPM86xx::eGUARD_BAUD);
+  clPsuT.setReceiveMode(teReceiveV);
+
+  //---------------------------------------------------------------------------------------------------
+  // compare the CPU time used by the process with the elapsed time
+  //
+  ulTimeT = micros();
+  slCpuT = clock();
+  for (uint32_t ulCountT = 0; ulCountT < BENCHMARK_TRANSACTIONS; ulCountT++)
+  {
+    if (clPsuT.readFunction(DPM86xx::eFUNC_MEASURED_VOLTAGE) < 0)
+    {
+      ulErrorsT++;
+    }
+  }
+  slCpuT = clock() - slCpuT;
+  ulTimeT = micros() - ulTimeT;
+
+  printf("%6u baud, %s: %7.1f transactions/s, CPU load %5.1f %%, errors %u\n", (unsigned)ulBaudRateV,
+         (teReceiveV == DPM86xx::eRECEIVE_EVENT) ? "event" : "poll ", (BENCHMARK_TRANSACTIONS * 1000000.0) / ulTimeT,
+         (slCpuT * 100.0e6) / ((double)CLOCKS_PER_SEC * ulTimeT), (unsigned)ulErrorsT);
+}
+
+//--------------------------------------------------------------------------------------------------------------------//
+//                                                                                                                    //
+//                                                                                                                    //
+//--------------------------------------------------------------------------------------------------------------------//
+static void benchmarkScheduler(DPM86xxBus::Priority_te teClassV)
+{
+  DPM86xxSim clSimT;
+  DPM86xxBus clBusT;
+  DPM86xxBus::QueueStats_ts tsStatsT;
+
+  clSimT.init(9600);
+  clSimT.addDevice(1, 8624);
+  clSimT.addDevice(2, 8616);
+  clBusT.init(clSimT);
+  clBusT.attach(1, 8624);
+  clBusT.attach(2, 8616);
+
+  //---------------------------------------------------------------------------------------------------
+  // the output is switched off while the telemetry queue is full, the request is sent either with
+  // the given priority class or behind all queued telemetry reads
+  //
+  for (uint32_t ulCountT = 0; ulCountT < BENCHMARK_SAFETY_REQUESTS; ulCountT++)
+  {
+    for (uint8_t ubDeviceT = 0; ubDeviceT < clBusT.count(); ubDeviceT++)
+    {
+      clBusT.submitRead(ubDeviceT, DPM86xx::eFUNC_MEASURED_VOLTAGE);
+      clBusT.submitRead(ubDeviceT, DPM86xx::eFUNC_MEASURED_CURRENT);
+      clBusT.submitRead(ubDeviceT, DPM86xx::eFUNC_CONSTANT_OUTPUT);
+      clBusT.submitRead(ubDeviceT, DPM86xx::eFUNC_TEMPERATURE);
+    }
+    clBusT.process();
+
+    clBusT.submitWrite(0, DPM86xx::eFUNC_OUTPUT_STATUS, 0, 0, teClassV);
+    do
+    {
+      clBusT.process();
+      clBusT.queueStats(teClassV, tsStatsT);
+    } while ((tsStatsT.ulCompleted + tsStatsT.ulDropped) < tsStatsT.ulSubmitted);
+  }
+
+  printf("%s: mean wait %6u us, max latency %6u us, errors %u\n",
+         (teClassV == DPM86xxBus::ePRIO_SAFETY) ? "safety   " : "telemetry", (unsigned)tsStatsT.ulMeanWait,
+         (unsigned)tsStatsT.ulMaxLatency, (unsigned)tsStatsT.ulErrors);
+}
+
+//--------------------------------------------------------------------------------------------------------------------//
+//                                                                                                                    //
+//                                                                                                                    //
+//--------------------------------------------------------------------------------------------------------------------//
+static void benchmarkClient()
+{
+  DPM86xxSim clBusT;
+  DPM86xx clPsuT;
+  DPM86xxClient clClientT;
+  std::thread aclThreadT[BENCHMARK_CLIENT_THREADS];
+  std::atomic<uint32_t> ulErrorsT(0);
+  std::atomic<uint32_t> ulMismatchT(0);
+  uint32_t ulTimeT;
+
+  clBusT.init(115200);
+  clBusT.addDevice(1, 8624);
+  clPsuT.init(clBusT, 1);
+  clPsuT.setGuardMode(DPM86xx::eGUARD_BAUD);
+  clPsuT.setReceiveMode(DPM86xx::eRECEIVE_EVENT);
+  clClientT.start(clPsuT);
+
+  //---------------------------------------------------------------------------------------------------
+  // each thread reads alternately the maximal voltage and current, so a mixed up response would
+  // return the wrong value
+  //
+  ulTimeT = micros();
+  for (uint32_t ulThreadT = 0; ulThreadT < BENCHMARK_CLIENT_THREADS; ulThreadT++)
+  {
+    aclThreadT[ulThreadT] = std::thread([&clClientT, &ulErrorsT, &ulMismatchT, ulThreadT]() {
+      for (uint32_t ulCountT = 0; ulCountT < BENCHMARK_TRANSACTIONS; ulCountT++)
+      {
+        bool btVoltageT = (((ulCountT + ulThreadT) & 1) == 0);
+        int32_t slValueT = clClientT.readFunction(btVoltageT ? DPM86xx::eFUNC_MAX_VOLTAGE : DPM86xx::eFUNC_MAX_CURRENT);
+        if (slValueT < 0)
+        {
+          ulErrorsT++;
+        }
+        else if (slValueT != (btVoltageT ? 6000 : 24000))
+        {
+          ulMismatchT++;
+        }
+      }
+    });
+  }
+  for (uint32_t ulThreadT = 0; ulThreadT < BENCHMARK_CLIENT_THREADS; ulThreadT++)
+  {
+    aclThreadT[ulThreadT].join();
+  }
+  ulTimeT = micros() - ulTimeT;
+  clClientT.stop();
+
+  printf("%u threads: %7.1f transactions/s, errors %u, mixed up responses %u\n", BENCHMARK_CLIENT_THREADS,
+         (BENCHMARK_CLIENT_THREADS * BENCHMARK_TRANSACTIONS * 1000000.0) / ulTimeT, (unsigned)ulErrorsT,
+         (unsigned)ulMismatchT);
+}
+
+//--------------------------------------------------------------------------------------------------------------------//
+//                                                                                                                    //
+//                                                                                                                    //
+//--------------------------------------------------------------------------------------------------------------------//
+static void benchmarkFleet(uint8_t ubBusesV)
+{
+  DPM86xxSim aclBusT[DPM86XX_FLEET_BUSES_MAX];
+  DPM86xxFleet clFleetT;
+  DPM86xxFleet::Reading_ts atsReadingT[DPM86XX_FLEET_DEVICES_MAX];
+  DPM86xx::Snapshot_ts tsSnapshotT;
+  uint32_t ulStartT;
+  uint32_t ulTimeT;
+  uint32_t ulSamplesT = 0;
+  uint32_t ulSnapshotsT = 0;
+  uint32_t ulMixedT = 0;
+
+  for (uint8_t ubBusT = 0; ubBusT < ubBusesV; ubBusT++)
+  {
+    aclBusT[ubBusT].init(9600);
+    clFleetT.addBus(aclBusT[ubBusT]);
+    for (uint8_t ubAddressT = 1; ubAddressT <= BENCHMARK_FLEET_DEVICES; ubAddressT++)
+    {
+      aclBusT[ubBusT].addDevice(ubAddressT, 8624);
+      clFleetT.addDevice(ubBusT, ubAddressT);
+    }
+  }
+
+  //---------------------------------------------------------------------------------------------------
+  // one loop that reads all PSUs one after the other
+  //
+  ulStartT = micros();
+  while ((micros() - ulStartT) < 1000000)
+  {
+    for (uint16_t uwIndexT = 0; uwIndexT < clFleetT.deviceCount(); uwIndexT++)
+    {
+      if (clFleetT.psu(uwIndexT).readSnapshot(tsSnapshotT, DPM86xx::eSNAP_VOLTAGE | DPM86xx::eSNAP_CURRENT |
+                                                               DPM86xx::eSNAP_CONSTANT_OUTPUT) == DPM86xx::eSTATUS_OK)
+      {
+        ulSamplesT++;
+      }
+    }
+  }
+  ulTimeT = micros() - ulStartT;
+  printf("%u bus%s, one loop: %6.1f PSUs/s", (unsigned)ubBusesV, (ubBusesV > 1) ? "es" : "  ",
+         (ulSamplesT * 1000000.0) / ulTimeT);
+
+  //---------------------------------------------------------------------------------------------------
+  // one worker for each bus, the snapshot must contain one sweep of each bus
+  //
+  clFleetT.start();
+  ulStartT = micros();
+  while ((micros() - ulStartT) < 1000000)
+  {
+    uint16_t uwCountT = clFleetT.snapshot(atsReadingT, DPM86XX_FLEET_DEVICES_MAX);
+    for (uint16_t uwIndexT = 1; uwIndexT < uwCountT; uwIndexT++)
+    {
+      if ((atsReadingT[uwIndexT].ubBus == atsReadingT[uwIndexT - 1].ubBus) &&
+          (atsReadingT[uwIndexT].ulSweep != atsReadingT[uwIndexT - 1].ulSweep))
+      {
+        ulMixedT++;
+      }
+    }
+    ulSnapshotsT++;
+    delay(1);
+  }
+  ulTimeT = micros() - ulStartT;
+  clFleetT.stop();
+
+  printf(", fleet: %6.1f PSUs/s, errors %u, %u snapshots with %u mixed sweeps\n",
+         (clFleetT.sampleCount() * 1000000.0) / ulTimeT, (unsigned)clFleetT.errorCount(), (unsigned)ulSnapshotsT,
+         (unsigned)ulMixedT);
+}
+
+//--------------------------------------------------------------------------------------------------------------------//
+//                                                                                                                    //
+//                                                                                                                    //
+//--------------------------------------------------------------------------------------------------------------------//
+static void printTelemetry(const char *pszSourceV, uint32_t ulStrideV, uint32_t ulTemperatureTimeV,
+                           uint32_t ulPowerTimeV, const DPM86xxTelemetry::Summary_ts &tsTemperatureR,
+                           const DPM86xxTelemetry::Summary_ts &tsPowerR)
+{
+  printf("%-15s (%4u byte per PSU): %5.2f us, max %u deg C, %5.2f us, %u..%u mW, total %6.1f W\n", pszSourceV,
+         (unsigned)ulStrideV, (double)ulTemperatureTimeV / BENCHMARK_QUERIES, (unsigned)tsTemperatureR.ulMax,
+         (double)ulPowerTimeV / BENCHMARK_QUERIES, (unsigned)tsPowerR.ulMin, (unsigned)tsPowerR.ulMax,
+         tsPowerR.uqSum / 1000.0);
+}
+
+//--------------------------------------------------------------------------------------------------------------------//
+//                                                                                                                    //
+//                                                                                                                    //
+//--------------------------------------------------------------------------------------------------------------------//
+static void benchmarkTelemetry()
+{
+  static DPM86xxSim aclBusT[(BENCHMARK_TELEMETRY_DEVICES + DPM86XX_SIM_DEVICES_MAX - 1) / DPM86XX_SIM_DEVICES_MAX];
+  static DPM86xx aclPsuT[BENCHMARK_TELEMETRY_DEVICES];
+  static DPM86xxFleet::Reading_ts atsReadingT[BENCHMARK_TELEMETRY_DEVICES];
+  static DPM86xxTelemetry clTelemetryT;
+  DPM86xxTelemetry::Summary_ts tsPowerT;
+  DPM86xxTelemetry::Summary_ts tsTemperatureT;
+  uint16_t auwAlarmT[16];
+  uint16_t uwAlarmsT = 0;
+  uint32_t ulTemperatureTimeT;
+  uint32_t ulPowerTimeT;
+  uint32_t ulTimeT;
+  uint32_t ulErrorsT = 0;
+
+  //---------------------------------------------------------------------------------------------------
+  // read all values of each simulated PSU once, the readings are kept by the PSU objects, as returned
+  // by DPM86xxFleet::snapshot() and in the telemetry table
+  //
+  for (uint16_t uwDeviceT = 0; uwDeviceT < BENCHMARK_TELEMETRY_DEVICES; uwDeviceT++)
+  {
+    DPM86xxSim &clBusT = aclBusT[uwDeviceT / DPM86XX_SIM_DEVICES_MAX];
+    DPM86xx &clPsuT = aclPsuT[uwDeviceT];
+    uint8_t ubAddressT = (uint8_t)((uwDeviceT % DPM86XX_SIM_DEVICES_MAX) + 1);
+
+    if (ubAddressT == 1)
+    {
+      clBusT.init(1000000, 0);
+    }
+    clBusT.addDevice(ubAddressT, 8624);
+    clPsuT.init(clBusT, ubAddressT);
+    clPsuT.setGuardMode(DPM86xx::eGUARD_BAUD);
+    clPsuT.setVoltageCurrent(5000 + (uwDeviceT % 100) * 100, 1000);
+    clPsuT.writeFunction(DPM86xx::eFUNC_OUTPUT_STATUS, 1);
+    if (clPsuT.readSnapshot(atsReadingT[uwDeviceT].tsSnapshot, DPM86xx::eSNAP_ALL) != DPM86xx::eSTATUS_OK)
+    {
+      atsReadingT[uwDeviceT].tsSnapshot.ubFields = 0;
+      ulErrorsT++;
+    }
+    clTelemetryT.update(uwDeviceT, atsReadingT[uwDeviceT].tsSnapshot);
+  }
+  printf("errors while reading the PSUs: %u\n", (unsigned)ulErrorsT);
+
+  //---------------------------------------------------------------------------------------------------
+  // one PSU object after the other
+  //
+  ulTemperatureTimeT = micros();
+  for (uint32_t ulQueryT = 0; ulQueryT < BENCHMARK_QUERIES; ulQueryT++)
+  {
+    tsTemperatureT = {0, 0xFFFFFFFF, 0, 0};
+    for (uint16_t uwDeviceT = 0; uwDeviceT < BENCHMARK_TELEMETRY_DEVICES; uwDeviceT++)
+    {
+      uint32_t ulTemperatureT = (uint32_t)aclPsuT[uwDeviceT].temperature();
+      tsTemperatureT.ulMax = (ulTemperatureT > tsTemperatureT.ulMax) ? ulTemperatureT : tsTemperatureT.ulMax;
+    }
+  }
+  ulTemperatureTimeT = micros() - ulTemperatureTimeT;
+
+  ulPowerTimeT = micros();
+  for (uint32_t ulQueryT = 0; ulQueryT < BENCHMARK_QUERIES; ulQueryT++)
+  {
+    tsPowerT = {0, 0xFFFFFFFF, 0, 0};
+    for (uint16_t uwDeviceT = 0; uwDeviceT < BENCHMARK_TELEMETRY_DEVICES; uwDeviceT++)
+    {
+      uint32_t ulPowerT = aclPsuT[uwDeviceT].measuredMilliwatt();
+      tsPowerT.ulMin = (ulPowerT < tsPowerT.ulMin) ? ulPowerT : tsPowerT.ulMin;
+      tsPowerT.ulMax = (ulPowerT > tsPowerT.ulMax) ? ulPowerT : tsPowerT.ulMax;
+      tsPowerT.uqSum += ulPowerT;
+      tsPowerT.uwCount++;
+    }
+  }
+  ulPowerTimeT = micros() - ulPowerTimeT;
+  printTelemetry("PSU objects", sizeof(DPM86xx), ulTemperatureTimeT, ulPowerTimeT, tsTemperatureT, tsPowerT);
+
+  //---------------------------------------------------------------------------------------------------
+  // readings of a fleet, one after the other
+  //
+  ulTemperatureTimeT = micros();
+  for (uint32_t ulQueryT = 0; ulQueryT < BENCHMARK_QUERIES; ulQueryT++)
+  {
+    tsTemperatureT = {0, 0xFFFFFFFF, 0, 0};
+    for (uint16_t uwDeviceT = 0; uwDeviceT < BENCHMARK_TELEMETRY_DEVICES; uwDeviceT++)
+    {
+      const DPM86xx::Snapshot_ts &tsSnapshotT = atsReadingT[uwDeviceT].tsSnapshot;
+      if ((tsSnapshotT.ubFields & DPM86xx::eSNAP_TEMPERATURE) && (tsSnapshotT.uwTemperature > tsTemperatureT.ulMax))
+      {
+        tsTemperatureT.ulMax = tsSnapshotT.uwTemperature;
+      }
+    }
+  }
+  ulTemperatureTimeT = micros() - ulTemperatureTimeT;
+
+  ulPowerTimeT = micros();
+  for (uint32_t ulQueryT = 0; ulQueryT < BENCHMARK_QUERIES; ulQueryT++)
+  {
+    tsPowerT = {0, 0xFFFFFFFF, 0, 0};
+    for (uint16_t uwDeviceT = 0; uwDeviceT < BENCHMARK_TELEMETRY_DEVICES; uwDeviceT++)
+    {
+      const DPM86xx::Snapshot_ts &tsSnapshotT = atsReadingT[uwDeviceT].tsSnapshot;
+      if ((tsSnapshotT.ubFields & (DPM86xx::eSNAP_VOLTAGE | DPM86xx::eSNAP_CURRENT)) ==
+          (DPM86xx::eSNAP_VOLTAGE | DPM86xx::eSNAP_CURRENT))
+      {
+        uint32_t ulPowerT = ((uint32_t)tsSnapshotT.uwVoltage * tsSnapshotT.uwCurrent) / 100;
+        tsPowerT.ulMin = (ulPowerT < tsPowerT.ulMin) ? ulPowerT : tsPowerT.ulMin;
+        tsPowerT.ulMax = (ulPowerT > tsPowerT.ulMax) ? ulPowerT : tsPowerT.ulMax;
+        tsPowerT.uqSum += ulPowerT;
+        tsPowerT.uwCount++;
+      }
+    }
+  }
+  ulPowerTimeT = micros() - ulPowerTimeT;
+  printTelemetry("fleet readings", sizeof(DPM86xxFleet::Reading_ts), ulTemperatureTimeT, ulPowerTimeT,
+                 tsTemperatureT, tsPowerT);
+
+  //---------------------------------------------------------------------------------------------------
+  // columns of the telemetry table
+  //
+  ulTemperatureTimeT = micros();
+  for (uint32_t ulQueryT = 0; ulQueryT < BENCHMARK_QUERIES; ulQueryT++)
+  {
+    tsTemperatureT = clTelemetryT.summary(DPM86xxTelemetry::eCOLUMN_TEMPERATURE);
+  }
+  ulTemperatureTimeT = micros() - ulTemperatureTimeT;
+
+  ulPowerTimeT = micros();
+  for (uint32_t ulQueryT = 0; ulQueryT < BENCHMARK_QUERIES; ulQueryT++)
+  {
+    tsPowerT = clTelemetryT.summary(DPM86xxTelemetry::eCOLUMN_POWER);
+  }
+  ulPowerTimeT = micros() - ulPowerTimeT;
+  printTelemetry("telemetry table", sizeof(DPM86xxTelemetry) / DPM86XX_TELEMETRY_DEVICES_MAX, ulTemperatureTimeT,
+                 ulPowerTimeT, tsTemperatureT, tsPowerT);
+
+  //---------------------------------------------------------------------------------------------------
+  // PSUs that deliver more than 9.5 W
+  //
+  ulTimeT = micros();
+  for (uint32_t ulQueryT = 0; ulQueryT < BENCHMARK_QUERIES; ulQueryT++)
+  {
+    uwAlarmsT = clTelemetryT.findAbove(DPM86xxTelemetry::eCOLUMN_POWER, 9500, auwAlarmT, 16);
+  }
+  ulTimeT = micros() - ulTimeT;
+  printf("PSUs above 9.5 W in the telemetry table: %u, %6.2f us per query\n", (unsigned)uwAlarmsT,
+         (double)ulTimeT / BENCHMARK_QUERIES);
+}
+
+//--------------------------------------------------------------------------------------------------------------------//
+//                                                                                                                    //
+//                                                                                                                    //
+//--------------------------------------------------------------------------------------------------------------------//
+static void benchmarkEnergy(uint32_t ulBaudRateV, DPM86xx::Protocol_te teProtocolV)
+{
+  DPM86xxSim clBusT;
+  DPM86xx clPsuT;
+  DPM86xxEnergy clEnergyT;
+  DPM86xx::Snapshot_ts tsSnapshotT;
+  uint32_t ulStartT;
+  uint32_t ulTimeT;
+
+  clBusT.init(ulBaudRateV);
+  clBusT.addDevice(1, 8624);
+  clBusT.setModbus(teProtocolV == DPM86xx::ePROTOCOL_MODBUS);
+  clPsuT.init(clBusT, 1);
+  clPsuT.setProtocol(teProtocolV);
+  clPsuT.setGuardMode(DPM86xx::eGUARD_BAUD);
+  clPsuT.setVoltageCurrent(12340, 1500);
+  clPsuT.writeFunction(DPM86xx::eFUNC_OUTPUT_STATUS, 1);
+
+  //---------------------------------------------------------------------------------------------------
+  // integrate the samples of one second, read as fast as the bus allows
+  //
+  ulStartT = micros();
+  while ((micros() - ulStartT) < 1000000)
+  {
+    if (clPsuT.readSnapshot(tsSnapshotT, DPM86xx::eSNAP_VOLTAGE | DPM86xx::eSNAP_CURRENT) == DPM86xx::eSTATUS_OK)
+    {
+      clEnergyT.add(tsSnapshotT);
+    }
+  }
+
+  printf("%6u baud, %s: %5u samples/s, %8.6f Wh, %8.6f Ah, peak %6u mW, integrated %4u ms\n",
+         (unsigned)ulBaudRateV, (teProtocolV == DPM86xx::ePROTOCOL_MODBUS) ? "Modbus" : "ASCII ",
+         (unsigned)clEnergyT.sampleCount(), clEnergyT.wattHours(), clEnergyT.ampereHours(),
+         (unsigned)clEnergyT.peakMilliwatt(), (unsigned)clEnergyT.integratedTime());
+
+  //---------------------------------------------------------------------------------------------------
+  // time needed by the integrator for one sample
+  //
+  ulTimeT = micros();
+  for (uint32_t ulCountT = 0; ulCountT < BENCHMARK_CONVERSIONS; ulCountT++)
+  {
+    clEnergyT.add(tsSnapshotT.uwVoltage, ulCountT * 1000, tsSnapshotT.uwCurrent, (ulCountT * 1000) + 400);
+  }
+  ulTimeT = micros() - ulTimeT;
+  printf("%6u baud, %s: %6.1f ns per sample\n", (unsigned)ulBaudRateV,
+         (teProtocolV == DPM86xx::ePROTOCOL_MODBUS) ? "Modbus" : "ASCII ", (ulTimeT * 1000.0) / BENCHMARK_CONVERSIONS);
+}
+
+//--------------------------------------------------------------------------------------------------------------------//
+//                                                                                                                    //
+//                                                                                                                    //
+//--------------------------------------------------------------------------------------------------------------------//
+static void benchmarkProfile(uint32_t ulBaudRateV)
+{
+  DPM86xxSim clBusT;
+  DPM86xx clPsuT;
+  DPM86xxProfile clProfileT;
+  uint32_t ulStartT;
+  uint32_t ulTimeT;
+  uint16_t uwStepsT;
+  const DPM86xxProfile::Point_ts atsPointT[] = {{0, 0, 1000, DPM86xxProfile::eSHAPE_STEP},
+                                                {1000, 12000, 1000, DPM86xxProfile::eSHAPE_RAMP}};
+
+  clBusT.init(ulBaudRateV);
+  clBusT.addDevice(1, 8624);
+  clPsuT.init(clBusT, 1);
+  clPsuT.setGuardMode(DPM86xx::eGUARD_BAUD);
+  clPsuT.setReceiveMode(DPM86xx::eRECEIVE_EVENT);
+  uwStepsT = clProfileT.load(atsPointT, 2, BENCHMARK_RAMP_STEP);
+
+  //---------------------------------------------------------------------------------------------------
+  // steps paced by a fixed delay after each write, the duration of the transactions adds up
+  //
+  ulStartT = micros();
+  for (uint16_t uwIndexT = 0; uwIndexT < uwStepsT; uwIndexT++)
+  {
+    const DPM86xxProfile::Step_ts &tsStepT = clProfileT.step(uwIndexT);
+    clPsuT.writeFunction(DPM86xx::eFUNC_SET_VC, tsStepT.uwVoltage, tsStepT.uwCurrent);
+    if ((uwIndexT + 1) < uwStepsT)
+    {
+      delay(BENCHMARK_RAMP_STEP);
+    }
+  }
+  ulTimeT = micros() - ulStartT;
+  printf("%6u baud, delay  : %u steps, last step %7.1f ms late\n", (unsigned)ulBaudRateV, (unsigned)uwStepsT,
+         ((int32_t)ulTimeT - (int32_t)(clProfileT.step(uwStepsT - 1).ulTime * 1000)) / 1000.0);
+
+  //---------------------------------------------------------------------------------------------------
+  // steps written on absolute deadlines
+  //
+  clProfileT.start(clPsuT);
+  clProfileT.run();
+  printf("%6u baud, profile: %u steps, lateness mean %5.1f us, max %6.1f us, skipped %u, errors %u\n",
+         (unsigned)ulBaudRateV, (unsigned)uwStepsT, (double)clProfileT.meanLateness(),
+         (double)clProfileT.maxLateness(), (unsigned)clProfileT.skippedCount(), (unsigned)clProfileT.errorCount());
+}
+
+//--------------------------------------------------------------------------------------------------------------------//
+//                                                                                                                    //
+//                                                                                                                    //
+//--------------------------------------------------------------------------------------------------------------------//
+static void benchmarkSweep(uint32_t ulBaudRateV)
+{
+  DPM86xxSim clBusT;
+  DPM86xx clPsuT;
+  DPM86xxSweep clSweepT;
+  int32_t slPointsT;
+  uint32_t ulSettledT = 0;
+  uint32_t ulConstantCurrentT = 0;
+  uint32_t ulSettleTimeT = 0;
+  int32_t slErrorT = 0;
+
+  clBusT.init(ulBaudRateV);
+  clBusT.addDevice(1, 8624);
+  clBusT.setSettling(1, 150);
+  clPsuT.init(clBusT, 1);
+  clPsuT.setGuardMode(DPM86xx::eGUARD_BAUD);
+  clPsuT.setReceiveMode(DPM86xx::eRECEIVE_EVENT);
+  clPsuT.writeFunction(DPM86xx::eFUNC_OUTPUT_STATUS, 1);
+
+  //---------------------------------------------------------------------------------------------------
+  // 0 V to 12 V with a current limit of 1 A at the load of 10 Ohm, the output changes to constant
+  // current mode above 10 V
+  //
+  slPointsT = clSweepT.sweepVoltage(clPsuT, 0, 12000, 1000, 1000);
+  for (int32_t slIndexT = 0; slIndexT < slPointsT; slIndexT++)
+  {
+    const DPM86xxSweep::Point_ts &tsPointT = clSweepT.point((uint16_t)slIndexT);
+    int32_t slExpectedT = tsPointT.btConstantCurrent ? 1000 : tsPointT.uwSetVoltage;
+    int32_t slDeviationT = (int32_t)tsPointT.uwVoltage - slExpectedT;
+
+    ulSettledT += tsPointT.btSettled ? 1 : 0;
+    ulConstantCurrentT += tsPointT.btConstantCurrent ? 1 : 0;
+    ulSettleTimeT += tsPointT.ulSettleTime;
+    slDeviationT = (slDeviationT < 0) ? -slDeviationT : slDeviationT;
+    slErrorT = (slDeviationT > slErrorT) ? slDeviationT : slErrorT;
+  }
+
+  printf("%6u baud: %d points in %5.2f s (fixed delay %5.1f s), settled %u, CC %u, mean settle %3u ms, "
+         "max error %d0 mV\n",
+         (unsigned)ulBaudRateV, (int)slPointsT, clSweepT.duration() / 1000.0,
+         (slPointsT * BENCHMARK_SETTLE_DELAY) / 1000.0, (unsigned)ulSettledT, (unsigned)ulConstantCurrentT,
+         (unsigned)(ulSettleTimeT / ((slPointsT > 0) ? slPointsT : 1)), (int)slErrorT);
+}
+
+//--------------------------------------------------------------------------------------------------------------------//
+//                                                                                                                    //
+//                                                                                                                    //
+//--------------------------------------------------------------------------------------------------------------------//
+static void regulate(DPM86xxRegulator &clRegulatorR, const char *pszPhaseV, uint32_t ulTargetV, uint32_t ulTimeV)
+{
+  uint32_t ulStartT = millis();
+  uint32_t ulPowerT;
+  uint32_t ulPeakT = 0;
+  uint32_t ulRiseT = 0;
+  uint32_t ulSettledT = 0;
+  uint32_t ulFinalT = 0;
+  uint32_t ulTimeT;
+
+  //---------------------------------------------------------------------------------------------------
+  // rise time to 90 % of the target, peak value and time until the power stays within 1 %
+  //
+  while ((ulTimeT = millis() - ulStartT) < ulTimeV)
+  {
+    clRegulatorR.process();
+    ulPowerT = clRegulatorR.measuredMilliwatt();
+    ulPeakT = (ulPowerT > ulPeakT) ? ulPowerT : ulPeakT;
+    if ((ulRiseT == 0) && (ulPowerT >= ((ulTargetV * 9) / 10)))
+    {
+      ulRiseT = ulTimeT;
+    }
+    if ((ulPowerT * 100 < ulTargetV * 99) || (ulPowerT * 100 > ulTargetV * 101))
+    {
+      ulSettledT = ulTimeT;
+    }
+    ulFinalT = ulPowerT;
+  }
+
+  printf("%s: rise %4u ms, peak %6u mW, within 1 %% after %4u ms, final %6u mW\n", pszPhaseV, (unsigned)ulRiseT,
+         (unsigned)ulPeakT, (unsigned)ulSettledT, (unsigned)ulFinalT);
+}
+
+//--------------------------------------------------------------------------------------------------------------------//
+//                                                                                                                    //
+//                                                                                                                    //
+//--------------------------------------------------------------------------------------------------------------------//
+static void benchmarkRegulator(uint32_t ulPeriodV)
+{
+  DPM86xxSim clBusT;
+  DPM86xx clPsuT;
+  DPM86xxRegulator clRegulatorT;
+  DPM86xxRegulator::LoopStats_ts tsStatsT;
+
+  clBusT.init(115200);
+  clBusT.addDevice(1, 8624);
+  clBusT.setSettling(1, 150);
+  clPsuT.init(clBusT, 1);
+  clPsuT.setGuardMode(DPM86xx::eGUARD_BAUD);
+  clPsuT.setReceiveMode(DPM86xx::eRECEIVE_EVENT);
+  clPsuT.writeFunction(DPM86xx::eFUNC_OUTPUT_STATUS, 1);
+
+  //---------------------------------------------------------------------------------------------------
+  // gains in [10 mV] per [mW] and per [mW * s]: 0.01 and 0.18
+  //
+  clRegulatorT.init(clPsuT, 30000, 3000);
+  clRegulatorT.setGains(655, 11800);
+  clRegulatorT.setPeriod(ulPeriodV);
+
+  printf("period %5u us:\n", (unsigned)ulPeriodV);
+  clRegulatorT.setPower(10000);
+  regulate(clRegulatorT, "   0 W -> 10 W, 10 Ohm", 10000, 2000);
+  clRegulatorT.setPower(20000);
+  regulate(clRegulatorT, "  10 W -> 20 W, 10 Ohm", 20000, 2000);
+  clBusT.setLoad(1, 5000);
+  regulate(clRegulatorT, "  20 W,  10 Ohm -> 5 Ohm", 20000, 2000);
+
+  tsStatsT = clRegulatorT.loopStats();
+  printf("  %u cycles, period min %5u us, mean %5u us, max %5u us, overruns %u, errors %u\n",
+         (unsigned)tsStatsT.ulCycles, (unsigned)tsStatsT.ulMinPeriod, (unsigned)tsStatsT.ulMeanPeriod,
+         (unsigned)tsStatsT.ulMaxPeriod, (unsigned)tsStatsT.ulOverruns, (unsigned)tsStatsT.ulErrors);
+}
+
+//--------------------------------------------------------------------------------------------------------------------//
+//                                                                                                                    //
+//                                                                                                                    //
+//--------------------------------------------------------------------------------------------------------------------//
+static void benchmarkUnits()
+{
+  DPM86xxSim clBusT;
+  DPM86xx clPsuT;
+  uint32_t ulTimeT;
+  volatile float ftPowerT = 0.0f;
+  volatile uint32_t ulPowerT = 0;
+
+  clBusT.init(115200);
+  clBusT.addDevice(1, 8624);
+  clPsuT.init(clBusT, 1);
+  clPsuT.setVoltageCurrent(12340, 1500);
+  clPsuT.writeFunction(DPM86xx::eFUNC_OUTPUT_STATUS, 1);
+  clPsuT.readFunction(DPM86xx::eFUNC_MEASURED_VOLTAGE);
+  clPsuT.readFunction(DPM86xx::eFUNC_MEASURED_CURRENT);
+
+  //---------------------------------------------------------------------------------------------------
+  // power calculated from float getters
+  //
+  ulTimeT = micros();
+  for (uint32_t ulCountT = 0; ulCountT < BENCHMARK_CONVERSIONS; ulCountT++)
+  {
+    ftPowerT = clPsuT.measuredVoltage() * clPsuT.measuredCurrent();
+  }
+  ulTimeT = micros() - ulTimeT;
+  printf("float   [W] : %8.3f, %6.1f ns per conversion\n", (double)ftPowerT,
+         (ulTimeT * 1000.0) / BENCHMARK_CONVERSIONS);
+
+  //---------------------------------------------------------------------------------------------------
+  // power calculated with integer arithmetic
+  //
+  ulTimeT = micros();
+  for (uint32_t ulCountT = 0; ulCountT < BENCHMARK_CONVERSIONS; ulCountT++)
+  {
+    ulPowerT = clPsuT.measuredMilliwatt();
+  }
+  ulTimeT = micros() - ulTimeT;
+  printf("integer [mW]: %8u, %6.1f ns per conversion\n", (unsigned)ulPowerT,
+         (ulTimeT * 1000.0) / BENCHMARK_CONVERSIONS);
+}
+
+#ifdef DPM86XX_LEGACY_PARSER
+/*--------------------------------------------------------------------------------------------------------------------*\
+** response frames for the comparison of both parsers                                                                 **
+**                                                                                                                    **
+\*--------------------------------------------------------------------------------------------------------------------*/
+typedef struct Frame_s
+{
+  char aszFrame[DPM86XX_RECEIVE_BUFER_MAX];
+  uint8_t ubLength;
+} Frame_ts;
+
+static std::vector<Frame_ts> atsFramesS;
+
+//--------------------------------------------------------------------------------------------------------------------//
+//                                                                                                                    //
+//                                                                                                                    //
+//--------------------------------------------------------------------------------------------------------------------//
+static void addFrame(const char *pszFrameV, uint32_t ulLengthV)
+{
+  Frame_ts tsFrameT;
+
+  if (ulLengthV < DPM86XX_RECEIVE_BUFER_MAX)
+  {
+    memcpy(tsFrameT.aszFrame, pszFrameV, ulLengthV);
+    tsFrameT.aszFrame[ulLengthV] = '\0';
+    tsFrameT.ubLength = (uint8_t)ulLengthV;
+    atsFramesS.push_back(tsFrameT);
+  }
+}
+
+//--------------------------------------------------------------------------------------------------------------------//
+//                                                                                                                    //
+//                                                                                                                    //
+//--------------------------------------------------------------------------------------------------------------------//
+static void buildFrames()
+{
+  static const uint8_t aubFunctionT[] = {0, 1, 10, 30, 31, 32, 33, 99};
+  static const uint32_t aulValueT[] = {0, 1, 9, 10, 99, 1234, 5000, 9999, 65535, 99999};
+  static const char *apszNoiseT[] = {"x", "\xFF\xFE", "r30=12.", "\r\n", "01", "ab:", ":::", "\n:01ok"};
+  static const char aszSymbolT[] = "09:=.rok\r\nx \xFF";
+  std::vector<std::string> aclValidT;
+  char aszFrameT[64];
+
+  atsFramesS.clear();
+
+  //---------------------------------------------------------------------------------------------------
+  // valid frames of the PSU at address 1 and of a PSU at address 2, write responses of both
+  //
+  for (uint8_t ubAddressT = 1; ubAddressT <= 2; ubAddressT++)
+  {
+    for (uint8_t ubFunctionT : aubFunctionT)
+    {
+      for (uint32_t ulValueT : aulValueT)
+      {
+        snprintf(aszFrameT, sizeof(aszFrameT), ":%02ur%02u=%u.\r\n", (unsigned)ubAddressT, (unsigned)ubFunctionT,
+                 (unsigned)ulValueT);
+        aclValidT.push_back(aszFrameT);
+      }
+    }
+    snprintf(aszFrameT, sizeof(aszFrameT), ":%02uok\r\n", (unsigned)ubAddressT);
+    aclValidT.push_back(aszFrameT);
+  }
+
+  for (const std::string &sclFrameR : aclValidT)
+  {
+    addFrame(sclFrameR.c_str(), sclFrameR.length());
+
+    //-------------------------------------------------------------------------------------------
+    // noise before the frame, as it may be received after a fault on the bus
+    //
+    for (const char *pszNoiseT : apszNoiseT)
+    {
+      std::string sclNoisyT = std::string(pszNoiseT) + sclFrameR;
+      addFrame(sclNoisyT.c_str(), sclNoisyT.length());
+    }
+
+    //-------------------------------------------------------------------------------------------
+    // each byte replaced by another symbol of the protocol or by the terminating '\0' of aszSymbolT
+    //
+    for (uint32_t ulPosT = 0; ulPosT < sclFrameR.length(); ulPosT++)
+    {
+      for (uint32_t ulSymbolT = 0; ulSymbolT < sizeof(aszSymbolT); ulSymbolT++)
+      {
+        std::string sclCorruptT = sclFrameR;
+        if (sclCorruptT[ulPosT] != aszSymbolT[ulSymbolT])
+        {
+          sclCorruptT[ulPosT] = aszSymbolT[ulSymbolT];
+          addFrame(sclCorruptT.c_str(), sclCorruptT.length());
+        }
+      }
+    }
+
+    //-------------------------------------------------------------------------------------------
+    // truncated frames, e.g. after a timeout
+    //
+    for (uint32_t ulLengthT = 0; ulLengthT < sclFrameR.length(); ulLengthT++)
+    {
+      addFrame(sclFrameR.c_str(), ulLengthT);
+    }
+  }
+
+  //---------------------------------------------------------------------------------------------------
+  // random sequences of protocol symbols, with a fixed seed to get the same frames in each run
+  //
+  srand(8624);
+  for (uint32_t ulCountT = 0; ulCountT < BENCHMARK_RANDOM_FRAMES; ulCountT++)
+  {
+    uint32_t ulLengthT = (uint32_t)rand() % DPM86XX_RECEIVE_BUFER_MAX;
+    for (uint32_t ulPosT = 0; ulPosT < ulLengthT; ulPosT++)
+    {
+      aszFrameT[ulPosT] = ((rand() % 4) == 0) ? aszSymbolT[rand() % sizeof(aszSymbolT)] : "01r3=.\r\n"[rand() % 8];
+    }
+    addFrame(aszFrameT, ulLengthT);
+  }
+}
+
+//--------------------------------------------------------------------------------------------------------------------//
+//                                                                                                                    //
+//                                                                                                                    //
+//--------------------------------------------------------------------------------------------------------------------//
+static void compareParsers()
+{
+  DPM86xxSim clBusT;
+  DPM86xx clNewT;
+  DPM86xx clLegacyT;
+  DPM86xx::Function_te teNewT;
+  DPM86xx::Function_te teLegacyT;
+  uint16_t uwNewT;
+  uint16_t uwLegacyT;
+  uint32_t ulDifferentT = 0;
+  uint32_t ulAddressCheckT = 0;
+  int slStdoutT;
+
+  clBusT.init(115200);
+  clNewT.init(clBusT, 1);
+  clLegacyT.init(clBusT, 1);
+  clLegacyT.useLegacyParser(true);
+
+  //---------------------------------------------------------------------------------------------------
+  // the legacy parser reports values that are not a number via Serial, which is stdout on the host
+  //
+  fflush(stdout);
+  slStdoutT = dup(STDOUT_FILENO);
+  freopen("/dev/null", "w", stdout);
+
+  for (const Frame_ts &tsFrameR : atsFramesS)
+  {
+    teNewT = clNewT.parseFrame(tsFrameR.aszFrame, tsFrameR.ubLength, uwNewT);
+    teLegacyT = clLegacyT.parseFrame(tsFrameR.aszFrame, tsFrameR.ubLength, uwLegacyT);
+    if ((teNewT == teLegacyT) && (uwNewT == uwLegacyT))
+    {
+      continue;
+    }
+
+    //-------------------------------------------------------------------------------------------
+    // the legacy parser accepts a write response without checking the address
+    //
+    if ((teLegacyT == DPM86xx::eFUNC_WRITE_OK) && (teNewT == DPM86xx::eFUNC_INVALID) &&
+        (strstr(tsFrameR.aszFrame, ":01ok\r\n") == nullptr))
+    {
+      ulAddressCheckT++;
+      continue;
+    }
+
+    ulDifferentT++;
+    fflush(stdout);
+    dprintf(slStdoutT, "different result for \"");
+    for (uint8_t ubPosT = 0; ubPosT < tsFrameR.ubLength; ubPosT++)
+    {
+      uint8_t ubByteT = (uint8_t)tsFrameR.aszFrame[ubPosT];
+      dprintf(slStdoutT, ((ubByteT < ' ') || (ubByteT > '~')) ? "\\x%02X" : "%c", ubByteT);
+    }
+    dprintf(slStdoutT, "\": new %u / %u, legacy %u / %u\n", (unsigned)teNewT, (unsigned)uwNewT,
+            (unsigned)teLegacyT, (unsigned)uwLegacyT);
+  }
+
+  fflush(stdout);
+  dup2(slStdoutT, STDOUT_FILENO);
+  close(slStdoutT);
+
+  printf("%u frames, write responses of other addresses only accepted by legacy parser: %u, different: %u: %s\n",
+         (unsigned)atsFramesS.size(), (unsigned)ulAddressCheckT, (unsigned)ulDifferentT,
+         (ulDifferentT == 0) ? "ok" : "FAILED");
+  if (ulDifferentT != 0)
+  {
+    ulFailedChecksS++;
+  }
+}
+
+//--------------------------------------------------------------------------------------------------------------------//
+//                                                                                                                    //
+//                                                                                                                    //
+//--------------------------------------------------------------------------------------------------------------------//
+static void benchmarkParsers()
+{
+  DPM86xxSim clBusT;
+  DPM86xx clPsuT;
+  uint32_t ulTimeT;
+  uint16_t uwValueT;
+  volatile uint32_t ulAcceptedT;
+  int slStdoutT;
+
+  clBusT.init(115200);
+  clPsuT.init(clBusT, 1);
+
+  fflush(stdout);
+  slStdoutT = dup(STDOUT_FILENO);
+  freopen("/dev/null", "w", stdout);
+
+  for (uint8_t ubLegacyT = 0; ubLegacyT <= 1; ubLegacyT++)
+  {
+    clPsuT.useLegacyParser(ubLegacyT == 1);
+    ulAcceptedT = 0;
+    ulTimeT = micros();
+    for (uint32_t ulRoundT = 0; ulRoundT < BENCHMARK_PARSER_ROUNDS; ulRoundT++)
+    {
+      for (const Frame_ts &tsFrameR : atsFramesS)
+      {
+        if (clPsuT.parseFrame(tsFrameR.aszFrame, tsFrameR.ubLength, uwValueT) != DPM86xx::eFUNC_INVALID)
+        {
+          ulAcceptedT++;
+        }
+      }
+    }
+    ulTimeT = micros() - ulTimeT;
+    fflush(stdout);
+    dprintf(slStdoutT, "%s parser: %6.1f ns per frame, %u frames accepted\n", (ubLegacyT == 1) ? "legacy" : "new   ",
+            (ulTimeT * 1000.0) / (BENCHMARK_PARSER_ROUNDS * atsFramesS.size()),
+            (unsigned)(ulAcceptedT / BENCHMARK_PARSER_ROUNDS));
+  }
+
+  fflush(stdout);
+  dup2(slStdoutT, STDOUT_FILENO);
+  close(slStdoutT);
+}
+#endif
+
+//--------------------------------------------------------------------------------------------------------------------//
+//                                                                                                                    //
+//                                                                                                                    //
+//--------------------------------------------------------------------------------------------------------------------//
+static void checkAllocations(DPM86xx::Protocol_te teProtocolV)
+{
+  DPM86xxSim clBusT;
+  DPM86xx clPsuT;
+  uint32_t ulAllocationsT;
+  uint32_t ulErrorsT = 0;
+
+  clBusT.init(115200);
+  clBusT.addDevice(1, 8624);
+  clBusT.setModbus(teProtocolV == DPM86xx::ePROTOCOL_MODBUS);
+  clPsuT.init(clBusT, 1);
+  clPsuT.setProtocol(teProtocolV);
+  clPsuT.setGuardMode(DPM86xx::eGUARD_BAUD);
+
+  for (uint32_t ulCountT = 0; ulCountT < BENCHMARK_WARM_UP; ulCountT++)
+  {
+    clPsuT.readFunction(DPM86xx::eFUNC_MEASURED_VOLTAGE);
+    clPsuT.writeFunction(DPM86xx::eFUNC_SET_VOLTAGE, 1200);
+  }
+
+  //---------------------------------------------------------------------------------------------------
+  // reads and writes of single values and of both setpoints, the values change with each request
+  //
+  ulAllocationsT = ulAllocationsS;
+  for (uint32_t ulCountT = 0; ulCountT < BENCHMARK_TRANSACTIONS; ulCountT++)
+  {
+    if ((clPsuT.readFunction(DPM86xx::eFUNC_MEASURED_VOLTAGE) < 0) ||
+        (clPsuT.readFunction(DPM86xx::eFUNC_MEASURED_CURRENT) < 0) ||
+        (clPsuT.writeFunction(DPM86xx::eFUNC_SET_VOLTAGE, (uint16_t)(100 + ulCountT)) < 0) ||
+        (clPsuT.writeFunction(DPM86xx::eFUNC_SET_VC, (uint16_t)(200 + ulCountT), (uint16_t)(500 + ulCountT)) < 0))
+    {
+      ulErrorsT++;
+    }
+  }
+  ulAllocationsT = ulAllocationsS - ulAllocationsT;
+
+  printf("%s: %u transactions, errors %u, heap allocations %u: %s\n",
+         (teProtocolV == DPM86xx::ePROTOCOL_MODBUS) ? "Modbus" : "ASCII ", (unsigned)(BENCHMARK_TRANSACTIONS * 4),
+         (unsigned)ulErrorsT, (unsigned)ulAllocationsT, ((ulAllocationsT == 0) && (ulErrorsT == 0)) ? "ok" : "FAILED");
+  if ((ulAllocationsT != 0) || (ulErrorsT != 0))
+  {
+    ulFailedChecksS++;
+  }
+}
+
+//--------------------------------------------------------------------------------------------------------------------//
+//                                                                                                                    //
+//                                                                                                                    //
+//--------------------------------------------------------------------------------------------------------------------//
+int main()
+{
+  printf("Read of measured voltage with a simulated DPM8624:\n");
+  benchmarkReads(9600, DPM86xx::eGUARD_FIXED);
+  benchmarkReads(9600, DPM86xx::eGUARD_BAUD);
+  benchmarkReads(19200, DPM86xx::eGUARD_FIXED);
+  benchmarkReads(19200, DPM86xx::eGUARD_BAUD);
+  benchmarkReads(115200, DPM86xx::eGUARD_FIXED);
+  benchmarkReads(115200, DPM86xx::eGUARD_BAUD);
+
+  printf("\nSnapshot of all measured values with a simulated DPM8624:\n");
+  benchmarkSnapshots(9600, DPM86xx::ePROTOCOL_ASCII);
+  benchmarkSnapshots(9600, DPM86xx::ePROTOCOL_MODBUS);
+  benchmarkSnapshots(115200, DPM86xx::ePROTOCOL_ASCII);
+  benchmarkSnapshots(115200, DPM86xx::ePROTOCOL_MODBUS);
+
+  printf("\nCPU load while waiting for the response:\n");
+  benchmarkReceive(9600, DPM86xx::eRECEIVE_POLL);
+  benchmarkReceive(9600, DPM86xx::eRECEIVE_EVENT);
+  benchmarkReceive(115200, DPM86xx::eRECEIVE_POLL);
+  benchmarkReceive(115200, DPM86xx::eRECEIVE_EVENT);
+
+  printf("\nOutput off at 9600 baud while 8 telemetry reads are queued:\n");
+  benchmarkScheduler(DPM86xxBus::ePRIO_SAFETY);
+  benchmarkScheduler(DPM86xxBus::ePRIO_TELEMETRY);
+
+  printf("\nOne PSU shared by several threads at 115200 baud:\n");
+  benchmarkClient();
+
+  printf("\nSnapshots of %u PSUs on each bus at 9600 baud:\n", BENCHMARK_FLEET_DEVICES);
+  benchmarkFleet(1);
+  benchmarkFleet(2);
+  benchmarkFleet(4);
+  benchmarkFleet(8);
+
+  printf("\nQueries over %u simulated PSUs, maximal temperature and min, max and total power:\n",
+         BENCHMARK_TELEMETRY_DEVICES);
+  benchmarkTelemetry();
+
+  printf("\nEnergy integrated from measured voltage and current:\n");
+  benchmarkEnergy(115200, DPM86xx::ePROTOCOL_ASCII);
+  benchmarkEnergy(115200, DPM86xx::ePROTOCOL_MODBUS);
+
+  printf("\nRamp from 0 V to 12 V in 1 s with steps of %u ms:\n", BENCHMARK_RAMP_STEP);
+  benchmarkProfile(9600);
+  benchmarkProfile(115200);
+
+  printf("\nI-V sweep of a simulated DPM8624 that settles with a time constant of 150 ms:\n");
+  benchmarkSweep(9600);
+  benchmarkSweep(115200);
+
+  printf("\nConstant power regulation at 115200 baud, output settles with a time constant of 150 ms:\n");
+  benchmarkRegulator(0);
+  benchmarkRegulator(10000);
+
+  printf("\nOutput power from measured voltage and current:\n");
+  benchmarkUnits();
+
+#ifdef DPM86XX_LEGACY_PARSER
+  buildFrames();
+  printf("\nComparison of the single-pass and the legacy response parser:\n");
+  compareParsers();
+  benchmarkParsers();
+#endif
+
+  printf("\nHeap allocations of transactions after %u transactions for warm up:\n", BENCHMARK_WARM_UP);
+  checkAllocations(DPM86xx::ePROTOCOL_ASCII);
+  checkAllocations(DPM86xx::ePROTOCOL_MODBUS);
+
+  return (ulFailedChecksS == 0) ? 0 : 1;
+}